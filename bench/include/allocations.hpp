@@ -0,0 +1,15 @@
+#ifndef JURO_BENCH_ALLOCATIONS_HPP
+#define JURO_BENCH_ALLOCATIONS_HPP
+
+#include <cstddef>
+
+namespace juro::bench {
+
+/**
+ * @brief Returns the amount of calls made to the global `operator new` so far.
+ */
+std::size_t allocation_count() noexcept;
+
+} /* namespace juro::bench */
+
+#endif /* JURO_BENCH_ALLOCATIONS_HPP */
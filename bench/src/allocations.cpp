@@ -0,0 +1,37 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "allocations.hpp"
+
+namespace {
+
+std::atomic<std::size_t> allocations { 0 };
+
+} /* anonymous namespace */
+
+namespace juro::bench {
+
+std::size_t allocation_count() noexcept {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+} /* namespace juro::bench */
+
+// The replacements live in their own translation unit so that the compiler
+// never pairs an inlined `new` with an inlined `delete` and warns about the
+// `malloc()`/`free()` underneath.
+void *operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if(auto *block = std::malloc(size == 0 ? 1 : size)) {
+        return block;
+    }
+    throw std::bad_alloc {  };
+}
+
+void operator delete(void *block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void *block, std::size_t) noexcept {
+    std::free(block);
+}
@@ -0,0 +1,227 @@
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "juro/promise.hpp"
+#include "juro/compose/all.hpp"
+#include "juro/compose/map_limit.hpp"
+#include "juro/compose/race.hpp"
+#include "allocations.hpp"
+
+namespace {
+
+using juro::bench::allocation_count;
+
+/**
+ * @brief Reports the average amount of global allocations made by each
+ * iteration of the benchmark loop running while the counter is alive.
+ */
+class allocation_counter {
+    benchmark::State &state;
+    std::size_t start;
+
+public:
+    explicit allocation_counter(benchmark::State &state) noexcept :
+        state { state },
+        start { allocation_count() }
+        {  }
+
+    ~allocation_counter() {
+        const auto made = allocation_count() - start;
+        state.counters["allocs/op"] = benchmark::Counter {
+            static_cast<double>(made),
+            benchmark::Counter::kAvgIterations
+        };
+    }
+};
+
+/**
+ * @brief Builds a chain of `length` resolve handlers on top of a promise.
+ */
+juro::promise_ptr<int> chain(juro::promise_ptr<int> promise, std::size_t length) {
+    for(std::size_t step = 0; step < length; step++) {
+        promise = promise->then([] (int value) { return value + 1; });
+    }
+    return promise;
+}
+
+void make_pending(benchmark::State &state) {
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        auto promise = juro::make_pending<int>();
+        benchmark::DoNotOptimize(promise.get());
+    }
+}
+BENCHMARK(make_pending);
+
+void make_resolved(benchmark::State &state) {
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        auto promise = juro::make_resolved(10);
+        benchmark::DoNotOptimize(promise.get());
+    }
+}
+BENCHMARK(make_resolved);
+
+void make_promise(benchmark::State &state) {
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        auto promise = juro::make_promise<int>([] (auto &promise) {
+            promise->resolve(10);
+        });
+        benchmark::DoNotOptimize(promise.get());
+    }
+}
+BENCHMARK(make_promise);
+
+void then_chain_settled(benchmark::State &state) {
+    const auto length = static_cast<std::size_t>(state.range(0));
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        auto tail = chain(juro::make_resolved(0), length);
+        benchmark::DoNotOptimize(tail->get_value());
+    }
+}
+BENCHMARK(then_chain_settled)->RangeMultiplier(4)->Range(1, 1024);
+
+void then_chain_pending(benchmark::State &state) {
+    const auto length = static_cast<std::size_t>(state.range(0));
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        auto head = juro::make_pending<int>();
+        auto tail = chain(head, length);
+        head->resolve(0);
+        benchmark::DoNotOptimize(tail->get_value());
+    }
+}
+BENCHMARK(then_chain_pending)->RangeMultiplier(4)->Range(1, 1024);
+
+void resolve_each(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    std::vector<juro::promise_ptr<int>> promises;
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        promises.clear();
+        for(std::size_t index = 0; index < count; index++) {
+            promises.push_back(juro::make_pending<int>());
+            chain(promises.back(), 4);
+        }
+        for(auto &promise : promises) {
+            promise->resolve(1);
+        }
+    }
+}
+BENCHMARK(resolve_each)->RangeMultiplier(4)->Range(16, 1024);
+
+void resolve_batch(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    std::vector<juro::promise_ptr<int>> promises;
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        promises.clear();
+        for(std::size_t index = 0; index < count; index++) {
+            promises.push_back(juro::make_pending<int>());
+            chain(promises.back(), 4);
+        }
+        juro::settle_batch batch;
+        for(auto &promise : promises) {
+            promise->resolve(1);
+        }
+        batch.close();
+    }
+}
+BENCHMARK(resolve_batch)->RangeMultiplier(4)->Range(16, 1024);
+
+void rejection_propagation(benchmark::State &state) {
+    const auto length = static_cast<std::size_t>(state.range(0));
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        auto head = juro::make_pending<int>();
+        auto tail = chain(head, length)->rescue([] (std::exception_ptr) {
+            return -1;
+        });
+        head->reject();
+        benchmark::DoNotOptimize(tail->get_value());
+    }
+}
+BENCHMARK(rejection_propagation)->RangeMultiplier(4)->Range(1, 1024);
+
+void all(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    std::vector<juro::promise_ptr<int>> children;
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        children.clear();
+        for(std::size_t index = 0; index < count; index++) {
+            children.push_back(juro::make_pending<int>());
+        }
+        auto composed = juro::all(children);
+        for(auto &child : children) {
+            child->resolve(1);
+        }
+        benchmark::DoNotOptimize(composed->get_value().data());
+    }
+}
+BENCHMARK(all)->RangeMultiplier(4)->Range(2, 1024);
+
+void map_limit(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    std::vector<std::size_t> elements(count);
+    std::vector<juro::promise_ptr<int>> children;
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        children.clear();
+        auto composed = juro::map_limit(elements, 16, [&] (std::size_t) {
+            children.push_back(juro::make_pending<int>());
+            return children.back();
+        });
+        for(std::size_t index = 0; index < children.size(); index++) {
+            children[index]->resolve(1);
+        }
+        benchmark::DoNotOptimize(composed->get_value().data());
+    }
+}
+BENCHMARK(map_limit)->RangeMultiplier(4)->Range(16, 1024);
+
+template<std::size_t ...Indices>
+auto race_children(std::index_sequence<Indices...>) {
+    return std::array { (static_cast<void>(Indices), juro::make_pending<int>())... };
+}
+
+template<std::size_t Count>
+void race(benchmark::State &state) {
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        auto children = race_children(std::make_index_sequence<Count> {  });
+        auto composed = std::apply(
+            [] (const auto &...children) { return juro::race(children...); },
+            children
+        );
+        children.front()->resolve(1);
+        benchmark::DoNotOptimize(composed->get_value());
+    }
+}
+BENCHMARK_TEMPLATE(race, 2);
+BENCHMARK_TEMPLATE(race, 8);
+
+void race_range(benchmark::State &state) {
+    const auto count = static_cast<std::size_t>(state.range(0));
+    std::vector<juro::promise_ptr<int>> children;
+    allocation_counter counter { state };
+    for(auto _ : state) {
+        children.clear();
+        for(std::size_t index = 0; index < count; index++) {
+            children.push_back(juro::make_pending<int>());
+        }
+        auto composed = juro::race(children);
+        children.front()->resolve(1);
+        benchmark::DoNotOptimize(composed->get_value());
+    }
+}
+BENCHMARK(race_range)->RangeMultiplier(4)->Range(2, 1024);
+
+} /* anonymous namespace */
+
+BENCHMARK_MAIN();
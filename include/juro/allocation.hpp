@@ -0,0 +1,313 @@
+/**
+ * @file juro/allocation.hpp
+ * @brief Contains allocation facilities used by the promise factories: a
+ * per-thread size-class pool, a standard allocator that draws from it and a
+ * scoped promise arena that makes the default factories opt into it.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_ALLOCATION_HPP
+#define JURO_ALLOCATION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "juro/config.hpp"
+
+/**
+ * @brief When defined to a non-zero value, every promise created by the
+ * default factories is allocated from the per-thread size-class pool, as if a
+ * `juro::promise_arena` were always active.
+ */
+#ifndef JURO_POOL_ALLOCATION
+#define JURO_POOL_ALLOCATION 0
+#endif /* JURO_POOL_ALLOCATION */
+
+namespace juro::allocation {
+
+/**
+ * @brief A per-thread pool of fixed-size blocks, grouped in size classes.
+ * @details Each size class is a multiple of `granularity` bytes and keeps an
+ * intrusive free list per thread, so allocating and deallocating a block is a
+ * single pointer swap. Blocks are carved from chunks of `chunk_size` bytes
+ * that are never returned to the system. Free blocks in excess of two chunks'
+ * worth are handed over, a chunk's worth at a time, to a global orphan list
+ * that threads adopt on refill before carving new chunks; so are the free
+ * blocks of exiting threads. Requests larger than `max_size` are forwarded to
+ * `::operator new`.
+ * @note A block may be deallocated on a different thread than the one that
+ * allocated it: it joins the free list of the deallocating thread and, once
+ * that list is long enough, flows back to allocating threads through the
+ * orphan list, so memory stays bounded when one thread allocates and another
+ * frees. Blocks allocated or deallocated after the thread's free lists were
+ * destroyed, e.g. from static destructors, go through the orphan list too.
+ */
+class size_class_pool {
+public:
+    /**
+     * @brief The size difference between two consecutive size classes.
+     */
+    static constexpr std::size_t granularity = alignof(std::max_align_t);
+
+    /**
+     * @brief The amount of size classes held by each thread.
+     */
+    static constexpr std::size_t class_count = 32;
+
+    /**
+     * @brief The largest block size served by the pool.
+     */
+    static constexpr std::size_t max_size = granularity * class_count;
+
+    /**
+     * @brief The size of each chunk from which blocks are carved.
+     */
+    static constexpr std::size_t chunk_size = 64 * 1024;
+
+    /**
+     * @brief Allocates a block of at least `size` bytes.
+     * @param size The requested size in bytes
+     * @return A pointer to the allocated block
+     */
+    static inline void *allocate(std::size_t size) {
+        if(size > max_size) {
+            return ::operator new(size);
+        }
+
+        const auto index = class_index(size);
+        auto *pool = local();
+        if(pool == nullptr) {
+            return allocate_orphaned(index);
+        }
+
+        auto &head = pool->heads[index];
+        if(head == nullptr) {
+            head = refill(index, pool->counts[index]);
+        }
+
+        auto *block = head;
+        head = block->next;
+        pool->counts[index]--;
+        return block;
+    }
+
+    /**
+     * @brief Returns a block previously obtained from `allocate()` to the pool.
+     * @param block The block being deallocated
+     * @param size The size with which the block was allocated
+     */
+    static inline void deallocate(void *block, std::size_t size) noexcept {
+        if(size > max_size) {
+            ::operator delete(block);
+            return;
+        }
+
+        const auto index = class_index(size);
+        auto *pool = local();
+        if(pool == nullptr) {
+            orphan(index, ::new(block) free_block { nullptr, nullptr });
+            return;
+        }
+
+        auto &head = pool->heads[index];
+        head = ::new(block) free_block { head, nullptr };
+        if(++pool->counts[index] >= 2 * batch_size(index)) {
+            spill(*pool, index);
+        }
+    }
+
+    /**
+     * @brief Returns the amount of chunks carved so far, by every thread.
+     */
+    static std::size_t chunk_count();
+
+private:
+    /**
+     * @brief The node type of the intrusive free lists. `next_batch` is only
+     * meaningful on the first block of a batch held by the orphan list.
+     */
+    struct free_block {
+        free_block *next;
+        free_block *next_batch;
+    };
+
+    static_assert(
+        sizeof(free_block) <= granularity,
+        "The smallest size class must hold a free block"
+    );
+
+    /**
+     * @brief The free lists owned by a single thread and their lengths.
+     */
+    struct local_pool {
+        free_block *heads[class_count] = {  };
+        std::size_t counts[class_count] = {  };
+
+        ~local_pool();
+    };
+
+    /**
+     * @brief Maps a requested size to its size class.
+     * @param size The requested size; must not be zero nor exceed `max_size`
+     * @return The index of the size class
+     */
+    static constexpr std::size_t class_index(std::size_t size) noexcept {
+        return size == 0 ? 0 : (size - 1) / granularity;
+    }
+
+    /**
+     * @brief Returns how many blocks of a size class fit in a chunk, which is
+     * also how many are handed over to the orphan list at a time.
+     * @param index The index of the size class
+     */
+    static constexpr std::size_t batch_size(std::size_t index) noexcept {
+        return chunk_size / ((index + 1) * granularity);
+    }
+
+    /**
+     * @brief Returns the current thread's free lists, or `nullptr` if they
+     * were already destroyed.
+     */
+    static local_pool *local() noexcept;
+
+    /**
+     * @brief Provides a fresh free list for a size class, either adopting
+     * orphaned blocks or carving a new chunk.
+     * @param index The index of the size class
+     * @param count Receives the length of the new free list
+     * @return The head of the new free list
+     */
+    static free_block *refill(std::size_t index, std::size_t &count);
+
+    /**
+     * @brief Hands a list of free blocks over to the orphan list.
+     * @param index The index of the size class
+     * @param head The head of the handed over list
+     */
+    static void orphan(std::size_t index, free_block *head) noexcept;
+
+    /**
+     * @brief Hands a chunk's worth of blocks from the head of a local free
+     * list over to the orphan list.
+     * @param pool The free lists of the current thread
+     * @param index The index of the size class
+     */
+    static void spill(local_pool &pool, std::size_t index) noexcept;
+
+    /**
+     * @brief Allocates a block after the current thread's free lists were
+     * destroyed, straight from the orphan list.
+     * @param index The index of the size class
+     * @return A pointer to the allocated block
+     */
+    static void *allocate_orphaned(std::size_t index);
+};
+
+/**
+ * @brief A standard allocator that serves memory from `size_class_pool`.
+ * @tparam T The allocated type
+ */
+template<class T>
+struct pool_allocator {
+    using value_type = T;
+
+    pool_allocator() noexcept = default;
+
+    template<class T_other>
+    pool_allocator(const pool_allocator<T_other> &) noexcept {  }
+
+    T *allocate(std::size_t n) {
+        if constexpr(alignof(T) > size_class_pool::granularity) {
+            return static_cast<T *>(
+                ::operator new(n * sizeof(T), std::align_val_t { alignof(T) })
+            );
+        } else {
+            return static_cast<T *>(size_class_pool::allocate(n * sizeof(T)));
+        }
+    }
+
+    void deallocate(T *pointer, std::size_t n) noexcept {
+        if constexpr(alignof(T) > size_class_pool::granularity) {
+            ::operator delete(pointer, std::align_val_t { alignof(T) });
+        } else {
+            size_class_pool::deallocate(pointer, n * sizeof(T));
+        }
+    }
+
+    template<class T_other>
+    friend inline bool operator==(
+        const pool_allocator &,
+        const pool_allocator<T_other> &
+    ) noexcept {
+        return true;
+    }
+
+    template<class T_other>
+    friend inline bool operator!=(
+        const pool_allocator &,
+        const pool_allocator<T_other> &
+    ) noexcept {
+        return false;
+    }
+};
+
+/**
+ * @brief A scoped object that, while alive, makes the default promise
+ * factories on the current thread allocate from `size_class_pool`. Arenas can
+ * be nested.
+ * @note Promises allocated inside an arena may safely outlive it; the memory
+ * is returned to the pool whenever the last reference is dropped.
+ */
+class promise_arena {
+public:
+    promise_arena() noexcept { ++depth(); }
+    promise_arena(const promise_arena &) = delete;
+    promise_arena(promise_arena &&) = delete;
+    ~promise_arena() noexcept { --depth(); }
+
+    promise_arena &operator=(const promise_arena &) = delete;
+    promise_arena &operator=(promise_arena &&) = delete;
+
+    /**
+     * @brief Returns whether the default factories should allocate from the
+     * pool on the current thread.
+     * @return Whether an arena is active or `JURO_POOL_ALLOCATION` is set.
+     */
+    static inline bool active() noexcept {
+        return JURO_POOL_ALLOCATION || depth() > 0;
+    }
+
+private:
+    static inline unsigned int &depth() noexcept {
+        static thread_local unsigned int value = 0;
+        return value;
+    }
+};
+
+/**
+ * @brief Creates a shared object, drawing its memory from the pool if a
+ * `promise_arena` is active on the current thread.
+ * @tparam T The type of the object being created
+ * @tparam ...T_args The types of the constructor arguments
+ * @param ...args The constructor arguments
+ * @return A shared pointer to the newly created object
+ */
+template<class T, class ...T_args>
+std::shared_ptr<T> make_shared_object(T_args &&...args) {
+    if(promise_arena::active()) {
+        return std::allocate_shared<T>(
+            pool_allocator<T> {  },
+            std::forward<T_args>(args)...
+        );
+    }
+    return std::make_shared<T>(std::forward<T_args>(args)...);
+}
+
+} /* namespace juro::allocation */
+
+#ifdef JURO_HEADER_ONLY
+#include "juro/impl/allocation.ipp"
+#endif /* JURO_HEADER_ONLY */
+
+#endif /* JURO_ALLOCATION_HPP */
@@ -0,0 +1,17 @@
+/**
+ * @file juro/compose.hpp
+ * @brief Includes every composition; `juro/promise.hpp` includes none of them,
+ * so translation units only pay for the compositions they use
+ * @author André Medeiros
+*/
+
+#ifndef JURO_COMPOSE_HPP
+#define JURO_COMPOSE_HPP
+
+#include "juro/compose/all.hpp"
+#include "juro/compose/all_settled.hpp"
+#include "juro/compose/any.hpp"
+#include "juro/compose/map_limit.hpp"
+#include "juro/compose/race.hpp"
+
+#endif /* JURO_COMPOSE_HPP */
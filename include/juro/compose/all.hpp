@@ -1,10 +1,15 @@
 #ifndef JURO_COMPOSE_ALL_HPP
 #define JURO_COMPOSE_ALL_HPP
 
+#include <iterator>
 #include <memory>
 #include <optional>
+#include <vector>
+#include "juro/config.hpp"
 #include "juro/helpers.hpp"
 #include "juro/factories.hpp"
+#include "juro/promise.hpp"
+#include "juro/compose/common.hpp"
 
 namespace juro::compose {
 
@@ -14,13 +19,30 @@ using namespace juro::factories;
 template<class ...T_values>
 using all_result = std::tuple<storage_type<T_values>...>;
 
+/**
+ * @brief Coordinates a variadic `all()` call.
+ * @details Children are observed through their settle handlers and their
+ * values are stored straight into the result tuple, which is moved into the
+ * composed promise once complete; for movable values that are not shared, no
+ * copy is made. Tuples that are not default constructible are assembled from
+ * `std::optional` slots instead.
+ * @tparam ...T_values The types of the children promises
+ */
 template<class ...T_values>
-class all_coordinator : public std::enable_shared_from_this<all_coordinator<T_values...>> {
+class all_coordinator : public ref_counted_object<all_coordinator<T_values...>> {
     using result_type = all_result<T_values...>;
-    using transient_type = std::tuple<std::optional<storage_type<T_values>>...>;
 
-    transient_type working_area;
-    std::size_t counter = sizeof...(T_values);
+    static constexpr inline bool presized = 
+        std::is_default_constructible_v<result_type>;
+
+    using working_type = std::conditional_t<
+        presized, 
+        result_type, 
+        std::tuple<std::optional<storage_type<T_values>>...>
+    >;
+
+    working_type working_area;
+    reference_count counter { sizeof...(T_values) };
     promise_ptr<result_type> promise;
 
 public:
@@ -29,68 +51,223 @@ public:
     {  }
 
     template<std::size_t ...Indices>
-    void attach(std::index_sequence<Indices...>, std::tuple<const promise_ptr<T_values> &...> &&promises) {
-        ([&, this] (auto &promise, auto &slot) {
-            using promise_type =
-                typename std::remove_reference_t<decltype(promise)>::element_type;
-            if constexpr(promise_type::is_void) {
-                promise->then(
-                    [this, &slot, guard = this->shared_from_this()] {
-                        on_resolve(void_type {}, slot);
-                    },
-                    [&] (std::exception_ptr &error) { on_reject(error); }
-                );
+    void attach(std::index_sequence<Indices...>, const promise_ptr<T_values> &...promises) {
+        (attach_child<Indices>(*promises), ...);
+    }
+
+    template<std::size_t Index, class T>
+    void attach_child(juro::promise<T> &child) {
+        settle_access::attach(child, [this, &child, guard = intrusive_ptr { this }] {
+            if(child.is_resolved()) {
+                on_resolve<Index>(child);
             } else {
-                promise->then(
-                    [this, &slot, guard = this->shared_from_this()] (auto &value) {
-                        on_resolve(value, slot);
-                    },
-                    [&] (std::exception_ptr &error) { on_reject(error); }
-                );
+                on_reject(child.get_error());
             }
-        }(std::get<Indices>(promises), std::get<Indices>(working_area)), ...);
+        });
     }
 
-    template<class T_value>
-    void on_resolve(T_value &&value, std::optional<std::remove_reference_t<T_value>> &slot) {
-        slot = std::forward<T_value>(value);
+    template<std::size_t Index, class T>
+    void on_resolve(juro::promise<T> &child) {
+        transfer_value(std::get<Index>(working_area), child);
 
-        if(--counter == 0 && promise->is_pending()) {
-            promise->resolve(std::apply([] (auto &...values) {
-                return std::make_tuple(std::move(values.value())...);
-            }, working_area));
+        if(--counter == 0) {
+            if constexpr(presized) {
+                resolve_if_pending(promise, std::move(working_area));
+            } else {
+                resolve_if_pending(promise, std::apply([] (auto &...values) {
+                    return result_type { std::move(*values)... };
+                }, working_area));
+            }
         }
     }
 
     void on_reject(std::exception_ptr &error) {
-        if(promise->is_pending()) {
-            promise->reject(error);
-        }
+        reject_if_pending(promise, error);
     }
 };
 
-void void_settler(const promise_ptr<void> &promise, const promise_ptr<void> &all_promise, const std::shared_ptr<std::size_t> &counter);
+/**
+ * @brief Coordinates an `all()` call over `void` promises: counts resolved
+ * children and resolves the composed promise after the last one. A single
+ * coordinator is allocated per call, whatever the amount of children.
+ */
+class void_all_coordinator : public ref_counted_object<void_all_coordinator> {
+    reference_count counter;
+    promise_ptr<void> promise;
+
+public:
+    void_all_coordinator(const promise_ptr<void> &promise, std::size_t count);
+
+    void attach(juro::promise<void> &child);
+    void on_resolve();
+    void on_reject(std::exception_ptr &error);
+};
+
+/**
+ * @brief Coordinates an `all()` call over a runtime range of non-void promises.
+ * @details The result vector is allocated once, up front, and every child's
+ * value is written into its own slot. Types that are not default
+ * constructible are collected into `std::optional` slots instead.
+ * @tparam T The type of the children promises
+ */
+template<class T>
+class range_all_coordinator : public ref_counted_object<range_all_coordinator<T>> {
+    static constexpr inline bool presized = std::is_default_constructible_v<T>;
+
+    using result_type = std::vector<T>;
+    using slot_type = std::conditional_t<presized, T, std::optional<T>>;
+
+    std::vector<slot_type> slots;
+    reference_count counter;
+    promise_ptr<result_type> promise;
+
+public:
+    range_all_coordinator(const promise_ptr<result_type> &promise, std::size_t count) :
+        slots(count),
+        counter { count },
+        promise { promise }
+        {  }
+
+    void attach(juro::promise<T> &child, std::size_t index) {
+        settle_access::attach(child, [
+            this, 
+            &child, 
+            index, 
+            guard = intrusive_ptr { this }
+        ] {
+            if(child.is_resolved()) {
+                on_resolve(child, index);
+            } else {
+                on_reject(child.get_error());
+            }
+        });
+    }
+
+    void on_resolve(juro::promise<T> &child, std::size_t index) {
+        transfer_value(slots[index], child);
+
+        if(--counter == 0) {
+            if constexpr(presized) {
+                resolve_if_pending(promise, std::move(slots));
+            } else {
+                result_type values;
+                values.reserve(slots.size());
+                for(auto &slot : slots) {
+                    values.push_back(std::move(*slot));
+                }
+                resolve_if_pending(promise, std::move(values));
+            }
+        }
+    }
+
+    void on_reject(std::exception_ptr &error) {
+        reject_if_pending(promise, error);
+    }
+};
 
 template<class ...T_values>
 auto all(const promise_ptr<T_values> &...promises) {
+    const bool concurrent = (promises->is_concurrent() || ...);
+
     if constexpr(std::conjunction_v<std::is_void<T_values>...>) {
-        return make_promise<void>([&] (const auto &all_promise) {
-            auto counter = std::make_shared<std::size_t>(sizeof...(T_values));
-            for(const auto &promise : std::array<std::reference_wrapper<const promise_ptr<void>>, sizeof...(T_values)> { promises... }) {
-                void_settler(promise, all_promise, counter);
+        const auto launcher = [&] (const auto &all_promise) {
+            if constexpr(sizeof...(T_values) == 0) {
+                all_promise->resolve();
+            } else {
+                auto coordinator = intrusive_ptr { 
+                    new void_all_coordinator { all_promise, sizeof...(T_values) } 
+                };
+                (coordinator->attach(*promises), ...);
             }
-        });
+        };
+        return concurrent ? 
+            make_concurrent<void>(launcher) : 
+            make_promise<void>(launcher);
     } else {
-        return make_promise<all_result<T_values...>>([&] (const auto &all_promise) {
-            auto coordinator = std::make_shared<all_coordinator<T_values...>>(all_promise);
-            coordinator->attach(
-                std::index_sequence_for<T_values...>(),
-                std::forward_as_tuple(promises...)
-            );
-        });
+        const auto launcher = [&] (const auto &all_promise) {
+            auto coordinator = intrusive_ptr { 
+                new all_coordinator<T_values...> { all_promise } 
+            };
+            coordinator->attach(std::index_sequence_for<T_values...>(), promises...);
+        };
+        return concurrent ? 
+            make_concurrent<all_result<T_values...>>(launcher) : 
+            make_promise<all_result<T_values...>>(launcher);
     }
 }
 
+/**
+ * @brief Creates a promise that resolves once every promise in a range is
+ * resolved, or rejects as soon as any of them is rejected.
+ * @tparam T_iterator The type of the range's iterators; must be a forward 
+ * iterator over `promise_ptr<T>`s
+ * @param first The beginning of the range
+ * @param last The end of the range
+ * @return A `promise_ptr<std::vector<T>>` holding the resolved values in
+ * range order or, if `T` is `void`, a `promise_ptr<void>`.
+ */
+template<
+    class T_iterator,
+    class = std::enable_if_t<
+        is_promise_v<typename std::iterator_traits<T_iterator>::value_type>
+    >
+>
+auto all(T_iterator first, T_iterator last) {
+    using value_type = 
+        typename std::iterator_traits<T_iterator>::value_type::element_type::type;
+    using result_type = 
+        std::conditional_t<std::is_void_v<value_type>, void, std::vector<value_type>>;
+
+    const auto count = static_cast<std::size_t>(std::distance(first, last));
+    bool concurrent = false;
+    for(auto current = first; current != last; ++current) {
+        concurrent = concurrent || (*current)->is_concurrent();
+    }
+
+    const auto launcher = [&] (const promise_ptr<result_type> &all_promise) {
+        if(count == 0) {
+            all_promise->resolve();
+            return;
+        }
+
+        if constexpr(std::is_void_v<value_type>) {
+            auto coordinator = intrusive_ptr { 
+                new void_all_coordinator { all_promise, count } 
+            };
+            for(; first != last; ++first) {
+                coordinator->attach(**first);
+            }
+        } else {
+            auto coordinator = intrusive_ptr { 
+                new range_all_coordinator<value_type> { all_promise, count } 
+            };
+            for(std::size_t index = 0; first != last; ++first, ++index) {
+                coordinator->attach(**first, index);
+            }
+        }
+    };
+    return concurrent ?
+        make_concurrent<result_type>(launcher) :
+        make_promise<result_type>(launcher);
+}
+
+/**
+ * @brief Creates a promise that resolves once every promise in a vector is
+ * resolved, or rejects as soon as any of them is rejected.
+ * @tparam T The type of the promises
+ * @param promises The promises to compose
+ * @return A `promise_ptr<std::vector<T>>` holding the resolved values in 
+ * order or, if `T` is `void`, a `promise_ptr<void>`.
+ */
+template<class T>
+inline auto all(const std::vector<promise_ptr<T>> &promises) {
+    return all(promises.begin(), promises.end());
+}
+
 } /* namespace juro::compose */
 
+#ifdef JURO_HEADER_ONLY
+#include "juro/impl/compose/all.ipp"
+#endif /* JURO_HEADER_ONLY */
+
 #endif /* JURO_COMPOSE_ALL_HPP */
\ No newline at end of file
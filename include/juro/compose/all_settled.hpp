@@ -0,0 +1,205 @@
+#ifndef JURO_COMPOSE_ALL_SETTLED_HPP
+#define JURO_COMPOSE_ALL_SETTLED_HPP
+
+#include <iterator>
+#include <tuple>
+#include <variant>
+#include <vector>
+#include "juro/helpers.hpp"
+#include "juro/factories.hpp"
+#include "juro/promise.hpp"
+#include "juro/compose/common.hpp"
+
+namespace juro::compose {
+
+using namespace juro::helpers;
+using namespace juro::factories;
+
+/**
+ * @brief The outcome of a settled promise: either the rejection reason or the
+ * resolved value. The exception pointer comes first so that outcomes are
+ * default constructible for any `T`.
+ * @tparam T The type of the settled promise
+ */
+template<class T>
+using settled_result = std::variant<std::exception_ptr, storage_type<T>>;
+
+template<class ...T_values>
+using all_settled_result = std::tuple<settled_result<T_values>...>;
+
+/**
+ * @brief Stores a settled child's outcome into a composition's slot.
+ * @tparam T The type of the child promise
+ * @param slot The slot to store the outcome into
+ * @param child The settled child promise
+ */
+template<class T>
+void transfer_outcome(settled_result<T> &slot, juro::promise<T> &child) {
+    if(child.is_resolved()) {
+        if(settle_access::is_unobserved(child)) {
+            slot.template emplace<1>(std::move(child.get_value()));
+        } else {
+            slot.template emplace<1>(child.get_value());
+        }
+    } else {
+        slot.template emplace<0>(child.get_error());
+    }
+}
+
+/**
+ * @brief Coordinates a variadic `all_settled()` call. Outcomes are stored
+ * straight into the result tuple, which is moved into the composed promise
+ * once every child has settled.
+ * @tparam ...T_values The types of the children promises
+ */
+template<class ...T_values>
+class all_settled_coordinator :
+    public ref_counted_object<all_settled_coordinator<T_values...>> {
+    using result_type = all_settled_result<T_values...>;
+
+    result_type outcomes;
+    reference_count counter { sizeof...(T_values) };
+    promise_ptr<result_type> promise;
+
+public:
+    all_settled_coordinator(const promise_ptr<result_type> &promise) :
+        promise { promise }
+    {  }
+
+    template<std::size_t ...Indices>
+    void attach(std::index_sequence<Indices...>, const promise_ptr<T_values> &...promises) {
+        (attach_child<Indices>(*promises), ...);
+    }
+
+    template<std::size_t Index, class T>
+    void attach_child(juro::promise<T> &child) {
+        settle_access::attach(child, [this, &child, guard = intrusive_ptr { this }] {
+            transfer_outcome(std::get<Index>(outcomes), child);
+            if(--counter == 0) {
+                resolve_if_pending(promise, std::move(outcomes));
+            }
+        });
+    }
+};
+
+/**
+ * @brief Coordinates an `all_settled()` call over a runtime range of promises.
+ * The outcome vector is allocated once, up front.
+ * @tparam T The type of the children promises
+ */
+template<class T>
+class range_all_settled_coordinator :
+    public ref_counted_object<range_all_settled_coordinator<T>> {
+    using result_type = std::vector<settled_result<T>>;
+
+    result_type outcomes;
+    reference_count counter;
+    promise_ptr<result_type> promise;
+
+public:
+    range_all_settled_coordinator(const promise_ptr<result_type> &promise, std::size_t count) :
+        outcomes(count),
+        counter { count },
+        promise { promise }
+        {  }
+
+    void attach(juro::promise<T> &child, std::size_t index) {
+        settle_access::attach(child, [
+            this,
+            &child,
+            index,
+            guard = intrusive_ptr { this }
+        ] {
+            transfer_outcome(outcomes[index], child);
+            if(--counter == 0) {
+                resolve_if_pending(promise, std::move(outcomes));
+            }
+        });
+    }
+};
+
+/**
+ * @brief Creates a promise that resolves once every supplied promise is
+ * settled, with the outcome of each one. It never rejects.
+ * @tparam ...T_values The types of the promises
+ * @param ...promises The promises to compose
+ * @return A `promise_ptr<std::tuple<settled_result<T_values>...>>`.
+ */
+template<class ...T_values>
+auto all_settled(const promise_ptr<T_values> &...promises) {
+    using result_type = all_settled_result<T_values...>;
+
+    const auto launcher = [&] (const promise_ptr<result_type> &settled_promise) {
+        if constexpr(sizeof...(T_values) == 0) {
+            settled_promise->resolve();
+        } else {
+            auto coordinator = intrusive_ptr {
+                new all_settled_coordinator<T_values...> { settled_promise }
+            };
+            coordinator->attach(std::index_sequence_for<T_values...>(), promises...);
+        }
+    };
+    return (promises->is_concurrent() || ...) ?
+        make_concurrent<result_type>(launcher) :
+        make_promise<result_type>(launcher);
+}
+
+/**
+ * @brief Creates a promise that resolves once every promise in a range is
+ * settled, with the outcome of each one, in range order. It never rejects.
+ * @tparam T_iterator The type of the range's iterators; must be a forward
+ * iterator over `promise_ptr<T>`s
+ * @param first The beginning of the range
+ * @param last The end of the range
+ * @return A `promise_ptr<std::vector<settled_result<T>>>`.
+ */
+template<
+    class T_iterator,
+    class = std::enable_if_t<
+        is_promise_v<typename std::iterator_traits<T_iterator>::value_type>
+    >
+>
+auto all_settled(T_iterator first, T_iterator last) {
+    using value_type =
+        typename std::iterator_traits<T_iterator>::value_type::element_type::type;
+    using result_type = std::vector<settled_result<value_type>>;
+
+    const auto count = static_cast<std::size_t>(std::distance(first, last));
+    bool concurrent = false;
+    for(auto current = first; current != last; ++current) {
+        concurrent = concurrent || (*current)->is_concurrent();
+    }
+
+    const auto launcher = [&] (const promise_ptr<result_type> &settled_promise) {
+        if(count == 0) {
+            settled_promise->resolve();
+            return;
+        }
+
+        auto coordinator = intrusive_ptr {
+            new range_all_settled_coordinator<value_type> { settled_promise, count }
+        };
+        for(std::size_t index = 0; first != last; ++first, ++index) {
+            coordinator->attach(**first, index);
+        }
+    };
+    return concurrent ?
+        make_concurrent<result_type>(launcher) :
+        make_promise<result_type>(launcher);
+}
+
+/**
+ * @brief Creates a promise that resolves once every promise in a vector is
+ * settled, with the outcome of each one, in order. It never rejects.
+ * @tparam T The type of the promises
+ * @param promises The promises to compose
+ * @return A `promise_ptr<std::vector<settled_result<T>>>`.
+ */
+template<class T>
+inline auto all_settled(const std::vector<promise_ptr<T>> &promises) {
+    return all_settled(promises.begin(), promises.end());
+}
+
+} /* namespace juro::compose */
+
+#endif /* JURO_COMPOSE_ALL_SETTLED_HPP */
@@ -0,0 +1,224 @@
+#ifndef JURO_COMPOSE_ANY_HPP
+#define JURO_COMPOSE_ANY_HPP
+
+#include <array>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "juro/helpers.hpp"
+#include "juro/factories.hpp"
+#include "juro/promise.hpp"
+#include "juro/compose/common.hpp"
+#include "juro/compose/race.hpp"
+
+namespace juro::compose {
+
+using namespace juro::helpers;
+using namespace juro::factories;
+
+/**
+ * @brief The rejection reason of an `any()` call whose promises were all
+ * rejected. Holds every rejection reason, in the order of the promises.
+ */
+class aggregate_error : public promise_error {
+    std::vector<std::exception_ptr> reasons;
+
+public:
+    explicit aggregate_error(std::vector<std::exception_ptr> reasons) :
+        promise_error { "All promises were rejected" },
+        reasons { std::move(reasons) }
+        {  }
+
+    inline const std::vector<std::exception_ptr> &errors() const noexcept {
+        return reasons;
+    }
+};
+
+/**
+ * @brief The type an `any()` call over promises of types `T_values...`
+ * resolves with: a single type if all types are the same, an `std::variant`
+ * otherwise. If every type is `void`, `void`.
+ */
+template<class ...T_values>
+using any_result_t = std::conditional_t<
+    std::is_same_v<race_of_t<T_values...>, void_type>,
+    void,
+    race_of_t<T_values...>
+>;
+
+/**
+ * @brief The bookkeeping of a single child of an `any()` call.
+ */
+struct any_slot {
+    promise_interface *child = nullptr;
+    std::exception_ptr error;
+};
+
+/**
+ * @brief Coordinates an `any()` call.
+ * @details Rejection reasons are collected into one slot per child, next to a
+ * pointer to the child itself. Once a child resolves, the settle handlers of
+ * every other child are replaced by no-ops, releasing the coordinator without
+ * waiting for the losers to settle. Losers of concurrent compositions keep
+ * their handlers, which cannot be replaced, until they settle.
+ * @tparam T_result The type the composed promise resolves with
+ * @tparam T_slots The container of child slots: an `std::array` for variadic
+ * calls and an `std::vector` for ranges
+ */
+template<class T_result, class T_slots>
+class any_coordinator : public ref_counted_object<any_coordinator<T_result, T_slots>> {
+    T_slots slots;
+    reference_count counter;
+    promise_ptr<T_result> promise;
+
+public:
+    template<class ...T_args>
+    any_coordinator(const promise_ptr<T_result> &promise, std::size_t count, T_args &&...args) :
+        slots(std::forward<T_args>(args)...),
+        counter { count },
+        promise { promise }
+        {  }
+
+    template<class T>
+    void attach(juro::promise<T> &child, std::size_t index) {
+        slots[index].child = &child;
+        settle_access::attach(child, [&child, link = child_link { this, index }] {
+            if(child.is_resolved()) {
+                (*link).on_resolve(child, link.position());
+            } else {
+                (*link).on_reject(child.get_error(), link.position());
+            }
+        });
+    }
+
+    inline void forget(std::size_t index) noexcept {
+        slots[index].child = nullptr;
+    }
+
+    template<class T>
+    void on_resolve(juro::promise<T> &child, std::size_t index) {
+        if(!promise->is_pending()) {
+            return;
+        }
+
+        if(!promise->is_concurrent()) {
+            for(std::size_t other = 0; other < slots.size(); other++) {
+                if(other != index && slots[other].child != nullptr) {
+                    settle_access::release(*slots[other].child);
+                }
+            }
+        }
+
+        if(settle_access::is_unobserved(child)) {
+            resolve_if_pending(promise, std::move(child.get_value()));
+        } else {
+            resolve_if_pending(promise, child.get_value());
+        }
+    }
+
+    void on_reject(std::exception_ptr &error, std::size_t index) {
+        slots[index].error = error;
+
+        if(--counter == 0) {
+            std::vector<std::exception_ptr> reasons;
+            reasons.reserve(slots.size());
+            for(auto &slot : slots) {
+                reasons.push_back(std::move(slot.error));
+            }
+
+            auto aggregate = std::make_exception_ptr(aggregate_error { std::move(reasons) });
+            reject_if_pending(promise, aggregate);
+        }
+    }
+};
+
+/**
+ * @brief Creates a promise that resolves as soon as any supplied promise is
+ * resolved, with its value, or rejects with an `aggregate_error` once all of
+ * them are rejected.
+ * @tparam ...T_values The types of the promises
+ * @param ...promises The promises to compose
+ * @return A `promise_ptr<any_result_t<T_values...>>`.
+ */
+template<class ...T_values>
+auto any(const promise_ptr<T_values> &...promises) {
+    static_assert(sizeof...(T_values) > 0, "any() requires at least one promise");
+
+    using result_type = any_result_t<T_values...>;
+    using coordinator_type = any_coordinator<
+        result_type,
+        std::array<any_slot, sizeof...(T_values)>
+    >;
+
+    const auto launcher = [&] (const promise_ptr<result_type> &any_promise) {
+        auto coordinator = intrusive_ptr {
+            new coordinator_type { any_promise, sizeof...(T_values) }
+        };
+        std::size_t index = 0;
+        (coordinator->attach(*promises, index++), ...);
+    };
+    return (promises->is_concurrent() || ...) ?
+        make_concurrent<result_type>(launcher) :
+        make_promise<result_type>(launcher);
+}
+
+/**
+ * @brief Creates a promise that resolves as soon as any promise in a range is
+ * resolved, with its value, or rejects with an `aggregate_error` once all of
+ * them are rejected -- immediately, if the range is empty.
+ * @tparam T_iterator The type of the range's iterators; must be a forward
+ * iterator over `promise_ptr<T>`s
+ * @param first The beginning of the range
+ * @param last The end of the range
+ * @return A `promise_ptr<T>`.
+ */
+template<
+    class T_iterator,
+    class = std::enable_if_t<
+        is_promise_v<typename std::iterator_traits<T_iterator>::value_type>
+    >
+>
+auto any(T_iterator first, T_iterator last) {
+    using result_type =
+        typename std::iterator_traits<T_iterator>::value_type::element_type::type;
+    using slots_type = std::vector<any_slot>;
+
+    const auto count = static_cast<std::size_t>(std::distance(first, last));
+    if(count == 0) {
+        return make_rejected<result_type>(aggregate_error { {  } });
+    }
+
+    bool concurrent = false;
+    for(auto current = first; current != last; ++current) {
+        concurrent = concurrent || (*current)->is_concurrent();
+    }
+
+    const auto launcher = [&] (const promise_ptr<result_type> &any_promise) {
+        auto coordinator = intrusive_ptr {
+            new any_coordinator<result_type, slots_type> { any_promise, count, count }
+        };
+        for(std::size_t index = 0; first != last; ++first, ++index) {
+            coordinator->attach(**first, index);
+        }
+    };
+    return concurrent ?
+        make_concurrent<result_type>(launcher) :
+        make_promise<result_type>(launcher);
+}
+
+/**
+ * @brief Creates a promise that resolves as soon as any promise in a vector is
+ * resolved, with its value, or rejects with an `aggregate_error` once all of
+ * them are rejected.
+ * @tparam T The type of the promises
+ * @param promises The promises to compose
+ * @return A `promise_ptr<T>`.
+ */
+template<class T>
+inline auto any(const std::vector<promise_ptr<T>> &promises) {
+    return any(promises.begin(), promises.end());
+}
+
+} /* namespace juro::compose */
+
+#endif /* JURO_COMPOSE_ANY_HPP */
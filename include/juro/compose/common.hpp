@@ -0,0 +1,82 @@
+#ifndef JURO_COMPOSE_COMMON_HPP
+#define JURO_COMPOSE_COMMON_HPP
+
+#include <exception>
+#include <utility>
+#include "juro/helpers.hpp"
+#include "juro/promise.hpp"
+
+namespace juro::compose {
+
+using namespace juro::helpers;
+
+/**
+ * @brief Resolves a composed promise unless it was already settled, e.g. by a
+ * rejected child settled concurrently on another thread.
+ * @tparam T The type of the composed promise
+ * @tparam T_value The type of the resolved value
+ * @param promise The composed promise
+ * @param value The value to resolve it with
+ */
+template<class T, class T_value>
+void resolve_if_pending(const promise_ptr<T> &promise, T_value &&value) {
+    if(!promise->is_pending()) {
+        return;
+    }
+    try {
+        settle_access::resolve_owned(promise, std::forward<T_value>(value));
+    } catch(const promise_error &) {
+        if(!promise->is_concurrent()) {
+            throw;
+        }
+    }
+}
+
+/**
+ * @brief Rejects a composed promise unless it was already settled. Unhandled
+ * rejections of non-concurrent promises still throw.
+ * @tparam T The type of the composed promise
+ * @param promise The composed promise
+ * @param error The rejection reason
+ */
+template<class T>
+void reject_if_pending(const promise_ptr<T> &promise, std::exception_ptr &error) {
+    if(!promise->is_pending()) {
+        return;
+    }
+    try {
+        promise->reject(error);
+    } catch(const promise_error &) {
+        if(!promise->is_concurrent()) {
+            throw;
+        }
+    }
+}
+
+/**
+ * @brief Stores a resolved child's value into a composition's slot. The value
+ * is moved out of the child if nothing but the composition can read it, and
+ * copied otherwise.
+ * @tparam T_slot The type of the slot
+ * @tparam T The type of the child promise
+ * @param slot The slot to store the value into
+ * @param child The resolved child promise
+ */
+template<class T_slot, class T>
+void transfer_value(T_slot &slot, juro::promise<T> &child) {
+    if(settle_access::is_unobserved(child)) {
+        slot = std::move(child.get_value());
+    } else {
+        slot = child.get_value();
+    }
+}
+
+} /* namespace juro::compose */
+
+namespace juro {
+
+using namespace juro::compose;
+
+} /* namespace juro */
+
+#endif /* JURO_COMPOSE_COMMON_HPP */
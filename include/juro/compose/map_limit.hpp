@@ -0,0 +1,232 @@
+#ifndef JURO_COMPOSE_MAP_LIMIT_HPP
+#define JURO_COMPOSE_MAP_LIMIT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "juro/helpers.hpp"
+#include "juro/factories.hpp"
+#include "juro/promise.hpp"
+#include "juro/compose/common.hpp"
+
+namespace juro::compose {
+
+using namespace juro::helpers;
+using namespace juro::factories;
+
+/**
+ * @brief Coordinates a `map_limit()` call.
+ * @details Elements are mapped into children lazily, as earlier children
+ * settle, so that at most a fixed amount of children are pending at a time.
+ * The result vector is allocated once, up front, and every child's value is
+ * written into its own slot, as in `all()`. Children settled while mapping
+ * are accounted for by the loop already running instead of recursing into
+ * it.
+ * @tparam T_range The type of the mapped range; a reference type if the range
+ * is borrowed
+ * @tparam T_mapper The type of the mapping functor
+ * @tparam T The type of the children promises
+ */
+template<class T_range, class T_mapper, class T>
+class map_limit_coordinator :
+    public ref_counted_object<map_limit_coordinator<T_range, T_mapper, T>> {
+public:
+    static constexpr inline bool is_void = std::is_void_v<T>;
+
+    using result_type = std::conditional_t<is_void, void, std::vector<T>>;
+
+private:
+    /**
+     * @brief Whether the results can be written straight into a presized
+     * vector. `std::vector<bool>` is excluded because its packed elements
+     * cannot be bound to references.
+     */
+    static constexpr inline bool presized =
+        is_void || (std::is_default_constructible_v<T> && !std::is_same_v<T, bool>);
+
+    using slot_type = std::conditional_t<
+        presized,
+        storage_type<T>,
+        std::optional<storage_type<T>>
+    >;
+    using iterator_type = decltype(std::begin(std::declval<T_range &>()));
+
+    T_range range;
+    T_mapper mapper;
+    iterator_type next;
+    std::vector<slot_type> slots;
+    std::size_t count;
+    std::size_t launched = 0;
+    std::size_t remaining;
+    std::size_t vacancies;
+    bool launching = false;
+    promise_ptr<result_type> promise;
+
+public:
+    template<class T_range_arg, class T_mapper_arg>
+    map_limit_coordinator(
+        const promise_ptr<result_type> &promise,
+        T_range_arg &&range,
+        T_mapper_arg &&mapper,
+        std::size_t count,
+        std::size_t max_in_flight
+    ) :
+        range(std::forward<T_range_arg>(range)),
+        mapper(std::forward<T_mapper_arg>(mapper)),
+        slots(is_void ? 0 : count),
+        count { count },
+        remaining { count },
+        vacancies { std::max<std::size_t>(max_in_flight, 1) },
+        promise { promise }
+    {
+        next = std::begin(this->range);
+    }
+
+    /**
+     * @brief Maps elements into children until the limit is reached, the
+     * range is exhausted or the composed promise is settled. A mapper that
+     * throws or returns a concurrent promise rejects the composed promise.
+     */
+    void launch() {
+        if(launching) {
+            return;
+        }
+
+        launching = true;
+        while(vacancies > 0 && launched < count && promise->is_pending()) {
+            vacancies--;
+            const auto index = launched++;
+
+            promise_ptr<T> child;
+            try {
+                child = std::invoke(mapper, *next);
+                ++next;
+                if(child->is_concurrent()) {
+                    throw promise_error { "map_limit() cannot compose concurrent promises" };
+                }
+            } catch(...) {
+                launching = false;
+                auto error = std::current_exception();
+                reject_if_pending(promise, error);
+                return;
+            }
+
+            attach(*child, index);
+        }
+        launching = false;
+    }
+
+private:
+    void attach(juro::promise<T> &child, std::size_t index) {
+        settle_access::attach(child, [
+            this,
+            &child,
+            index,
+            guard = intrusive_ptr { this }
+        ] {
+            if(child.is_resolved()) {
+                on_resolve(child, index);
+            } else {
+                on_reject(child.get_error());
+            }
+        });
+    }
+
+    void on_resolve([[maybe_unused]] juro::promise<T> &child, [[maybe_unused]] std::size_t index) {
+        if constexpr(!is_void) {
+            transfer_value(slots[index], child);
+        }
+
+        if(--remaining == 0) {
+            finish();
+            return;
+        }
+
+        vacancies++;
+        launch();
+    }
+
+    void on_reject(std::exception_ptr &error) {
+        reject_if_pending(promise, error);
+    }
+
+    void finish() {
+        if constexpr(is_void) {
+            resolve_if_pending(promise, void_type {  });
+        } else if constexpr(presized) {
+            resolve_if_pending(promise, std::move(slots));
+        } else {
+            result_type values;
+            values.reserve(slots.size());
+            for(auto &slot : slots) {
+                values.push_back(std::move(*slot));
+            }
+            resolve_if_pending(promise, std::move(values));
+        }
+    }
+};
+
+/**
+ * @brief Maps every element of a range into a promise, keeping at most a
+ * fixed amount of them pending at a time, and creates a promise that resolves
+ * once all of them are resolved, or rejects as soon as any of them is
+ * rejected. After a rejection, no further element is mapped.
+ * @details Unlike calling `all()` over the mapped range, children are only
+ * created as earlier ones settle, so that neither the children nor the work
+ * they stand for pile up.
+ * @warning A range supplied as an lvalue is borrowed and must outlive the
+ * composition; rvalue ranges are moved into it. The mapped promises must not
+ * be concurrent.
+ * @tparam T_range The type of the range; must be a forward range
+ * @tparam T_mapper The type of the mapper; should receive an element of the
+ * range and return a `promise_ptr<R>`.
+ * @param range The range to map
+ * @param max_in_flight The maximum amount of pending children; at least one
+ * child is always allowed
+ * @param mapper The functor mapping an element into a promise
+ * @return A `promise_ptr<std::vector<R>>` holding the resolved values in
+ * range order or, if `R` is `void`, a `promise_ptr<void>`.
+ */
+template<class T_range, class T_mapper>
+auto map_limit(T_range &&range, std::size_t max_in_flight, T_mapper &&mapper) {
+    using element_type = decltype(*std::begin(range));
+    using child_type = std::invoke_result_t<std::decay_t<T_mapper> &, element_type>;
+
+    static_assert(
+        is_promise_v<child_type>,
+        "Mapper must return a `juro::promise_ptr<R>`."
+    );
+
+    using value_type = typename child_type::element_type::type;
+    using coordinator_type = map_limit_coordinator<T_range, std::decay_t<T_mapper>, value_type>;
+    using result_type = typename coordinator_type::result_type;
+
+    const auto count = static_cast<std::size_t>(
+        std::distance(std::begin(range), std::end(range))
+    );
+
+    return make_promise<result_type>([&] (const promise_ptr<result_type> &map_promise) {
+        if(count == 0) {
+            map_promise->resolve();
+            return;
+        }
+
+        auto coordinator = intrusive_ptr { new coordinator_type {
+            map_promise,
+            std::forward<T_range>(range),
+            std::forward<T_mapper>(mapper),
+            count,
+            max_in_flight
+        } };
+        coordinator->launch();
+    });
+}
+
+} /* namespace juro::compose */
+
+#endif /* JURO_COMPOSE_MAP_LIMIT_HPP */
@@ -1,8 +1,18 @@
 #ifndef JURO_COMPOSE_RACE_HPP
 #define JURO_COMPOSE_RACE_HPP
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
 #include "juro/helpers.hpp"
 #include "juro/factories.hpp"
+#include "juro/promise.hpp"
+#include "juro/compose/common.hpp"
 
 namespace juro::compose {
 
@@ -25,39 +35,230 @@ struct race_result<std::tuple<T>> {
 template<class ...T_values>
 using race_result_t = typename race_result<T_values...>::type;
 
+/**
+ * @brief The type a `race()` call over promises of types `T_values...`
+ * resolves with: the storage type of the promises if they are all of the same
+ * type, an `std::variant` of their unique storage types otherwise.
+ * @tparam ...T_values The types of the promises
+ */
 template<class ...T_values>
-auto race(promise_ptr<T_values> ...promises) {
-    return make_promise<race_result_t<unique_t<T_values...>>>([&] (auto &race_promise) {
-        ([&] (auto &promise) {
-            if constexpr(std::remove_reference_t<decltype(promise)>::element_type::is_void) {
-                promise->then(
-                    [=] { 
-                        if(race_promise->is_pending()) {
-                            race_promise->resolve(void_type {  }); 
-                        }
-                    },
-                    [=] (auto &error) {
-                        if(race_promise->is_pending()) {
-                            race_promise->reject(error);
-                        }
-                    }
-                );
+struct race_of {
+    using type = race_result_t<unique_t<T_values...>>;
+};
+
+/**
+ * @brief Helper alias to `race_of<T_values...>::type`
+ * @tparam ...T_values The types of the promises
+ */
+template<class ...T_values>
+using race_of_t = typename race_of<T_values...>::type;
+
+/**
+ * @brief A handle to a composition's coordinator captured by the settle handler
+ * of one of its children. When the handler is destroyed -- along with its
+ * promise or when it is replaced -- the coordinator forgets the child.
+ * @tparam T_coordinator The type of the coordinator; must have a
+ * `forget(std::size_t)` member
+ */
+template<class T_coordinator>
+class child_link {
+    intrusive_ptr<T_coordinator> coordinator;
+    std::size_t index;
+
+public:
+    child_link(T_coordinator *coordinator, std::size_t index) noexcept :
+        coordinator { coordinator },
+        index { index }
+        {  }
+
+    child_link(child_link &&other) noexcept = default;
+    child_link(const child_link &) = delete;
+
+    ~child_link() noexcept {
+        if(coordinator) {
+            coordinator->forget(index);
+        }
+    }
+
+    child_link &operator=(const child_link &) = delete;
+    child_link &operator=(child_link &&) = delete;
+
+    inline T_coordinator &operator*() const noexcept { return *coordinator; }
+    inline std::size_t position() const noexcept { return index; }
+};
+
+/**
+ * @brief Coordinates a `race()` call.
+ * @details Children are kept in a flat container of type-erased pointers and
+ * observe the coordinator through a `child_link` each, so no allocation is
+ * made per child. The first child to settle wins a one-shot flag; the
+ * composed promise is settled from it and released, so losers keep nothing
+ * but the coordinator itself alive. The losers still pending are then 
+ * detached -- their settle handlers are released -- and cancelled, so that
+ * producers can stop working on results nobody waits for. Losers of 
+ * concurrent compositions, whose children may be settled on other threads, 
+ * are neither detached nor cancelled.
+ * @tparam T_result The type the composed promise resolves with
+ * @tparam T_children The type of the children container; either a 
+ * `std::array` or a `std::vector` of `promise_interface *`
+ */
+template<class T_result, class T_children>
+class race_coordinator : public ref_counted_object<race_coordinator<T_result, T_children>> {
+    T_children children;
+    promise_ptr<T_result> promise;
+    std::atomic<bool> won { false };
+    const bool concurrent;
+
+public:
+    template<class ...T_args>
+    race_coordinator(const promise_ptr<T_result> &promise, T_args &&...args) :
+        children(std::forward<T_args>(args)...),
+        promise { promise },
+        concurrent { promise->is_concurrent() }
+        {  }
+
+    template<class T>
+    void attach(juro::promise<T> &child, std::size_t index) {
+        if(!concurrent && won.load(std::memory_order_relaxed)) {
+            // An earlier child was settled already: this one lost on arrival.
+            settle_access::release(child);
+            child.cancel();
+            return;
+        }
+
+        children[index] = &child;
+        settle_access::attach(child, [&child, link = child_link { this, index }] {
+            (*link).on_settle(child, link.position());
+        });
+    }
+
+    inline void forget(std::size_t index) noexcept {
+        children[index] = nullptr;
+    }
+
+    template<class T>
+    void on_settle(juro::promise<T> &child, std::size_t index) {
+        if(won.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+
+        const auto composed = std::move(promise);
+        try {
+            if(child.is_rejected()) {
+                reject_if_pending(composed, child.get_error());
+            } else if(settle_access::is_unobserved(child)) {
+                resolve_if_pending(composed, std::move(child.get_value()));
             } else {
-                promise->then(
-                    [=] (auto &value) { 
-                        if(race_promise->is_pending()) {
-                            race_promise->resolve(value); 
-                        }
-                    },
-                    [=] (auto &error) { 
-                        if(race_promise->is_pending()) {
-                            race_promise->reject(error); 
-                        }
-                    }
-                );
+                resolve_if_pending(composed, child.get_value());
             }
-        }(promises), ...);
-    });
+        } catch(...) {
+            detach_losers(index);
+            throw;
+        }
+        detach_losers(index);
+    }
+
+private:
+    void detach_losers(std::size_t winner) {
+        if(concurrent) {
+            return;
+        }
+
+        for(std::size_t index = 0; index < children.size(); index++) {
+            auto *loser = children[index];
+            if(index == winner || loser == nullptr) {
+                continue;
+            }
+
+            // Releasing the handler makes the loser forget the coordinator,
+            // which the winner's handler keeps alive meanwhile.
+            settle_access::release(*loser);
+            loser->cancel();
+        }
+    }
+};
+
+/**
+ * @brief Creates a promise that settles as soon as any supplied promise is
+ * settled, in the same way. The promises still pending are then cancelled.
+ * @tparam ...T_values The types of the promises
+ * @param ...promises The promises to compose
+ * @return A `promise_ptr<race_of_t<T_values...>>`.
+ */
+template<class ...T_values>
+auto race(promise_ptr<T_values> ...promises) {
+    using result_type = race_of_t<T_values...>;
+    using coordinator_type = race_coordinator<
+        result_type,
+        std::array<promise_interface *, sizeof...(T_values)>
+    >;
+
+    const auto launcher = [&] (const promise_ptr<result_type> &race_promise) {
+        auto coordinator = intrusive_ptr { new coordinator_type { race_promise } };
+        std::size_t index = 0;
+        (coordinator->attach(*promises, index++), ...);
+    };
+    return (promises->is_concurrent() || ...) ? 
+        make_concurrent<result_type>(launcher) : 
+        make_promise<result_type>(launcher);
+}
+
+/**
+ * @brief Creates a promise that settles as soon as any promise in a range is
+ * settled, in the same way. The promises still pending are then cancelled. If
+ * the range is empty, the returned promise never settles.
+ * @tparam T_iterator The type of the range's iterators; must be a forward
+ * iterator over `promise_ptr<T>`s
+ * @param first The beginning of the range
+ * @param last The end of the range
+ * @return A `promise_ptr<race_result_t<std::tuple<T>>>`.
+ */
+template<
+    class T_iterator,
+    class = std::enable_if_t<
+        is_promise_v<typename std::iterator_traits<T_iterator>::value_type>
+    >
+>
+auto race(T_iterator first, T_iterator last) {
+    using value_type =
+        typename std::iterator_traits<T_iterator>::value_type::element_type::type;
+    using result_type = race_result_t<std::tuple<value_type>>;
+    using coordinator_type = race_coordinator<
+        result_type,
+        std::vector<promise_interface *>
+    >;
+
+    const auto count = static_cast<std::size_t>(std::distance(first, last));
+    bool concurrent = false;
+    for(auto current = first; current != last; ++current) {
+        concurrent = concurrent || (*current)->is_concurrent();
+    }
+
+    const auto launcher = [&] (const promise_ptr<result_type> &race_promise) {
+        if(count == 0) {
+            return;
+        }
+
+        auto coordinator = intrusive_ptr { new coordinator_type { race_promise, count } };
+        for(std::size_t index = 0; first != last; ++first, ++index) {
+            coordinator->attach(**first, index);
+        }
+    };
+    return concurrent ?
+        make_concurrent<result_type>(launcher) :
+        make_promise<result_type>(launcher);
+}
+
+/**
+ * @brief Creates a promise that settles as soon as any promise in a vector is
+ * settled, in the same way. The promises still pending are then cancelled.
+ * @tparam T The type of the promises
+ * @param promises The promises to compose
+ * @return A `promise_ptr<race_result_t<std::tuple<T>>>`.
+ */
+template<class T>
+inline auto race(const std::vector<promise_ptr<T>> &promises) {
+    return race(promises.begin(), promises.end());
 }
 
 } /* namespace juro::compose */
@@ -0,0 +1,23 @@
+/**
+ * @file juro/config.hpp
+ * @brief Contains the build configuration shared by every juro header.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_CONFIG_HPP
+#define JURO_CONFIG_HPP
+
+/**
+ * @brief When defined, juro is used as a header-only library: the headers
+ * include the definitions otherwise compiled into `libjuro`, so the whole
+ * settle path -- from `resolve()` down to the handler -- is visible to, and
+ * may be inlined by, the compiler of every translation unit.
+ * @details The macro must be defined consistently for the whole program.
+ */
+#ifdef JURO_HEADER_ONLY
+#define JURO_DECL inline
+#else
+#define JURO_DECL
+#endif /* JURO_HEADER_ONLY */
+
+#endif /* JURO_CONFIG_HPP */
@@ -0,0 +1,344 @@
+/**
+ * @file juro/coro.hpp
+ * @brief Contains C++20 coroutine support: `promise_ptr`s can be awaited with
+ * `co_await` and functions returning a `promise_ptr` can be coroutines.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_CORO_HPP
+#define JURO_CORO_HPP
+
+#if !defined(__cpp_impl_coroutine) || __cplusplus < 202002L
+#error "juro/coro.hpp requires C++20 coroutine support"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "juro/allocation.hpp"
+#include "juro/promise.hpp"
+
+namespace juro::coroutines {
+
+using namespace juro::helpers;
+using namespace juro::allocation;
+
+/**
+ * @brief Per-thread bookkeeping used to resume coroutines without growing the
+ * stack.
+ */
+struct resumption_context {
+    /**
+     * @brief The coroutine currently suspending on this thread, if any. A
+     * settle handler that fires for it during `await_suspend()` only flags it
+     * as ready, so it continues without ever being suspended.
+     */
+    std::coroutine_handle<> suspending;
+    bool ready = false;
+
+    /**
+     * @brief The slot of the innermost `resume()` loop running on this thread,
+     * in which a finishing coroutine leaves the coroutine awaiting it.
+     */
+    std::coroutine_handle<> *next = nullptr;
+
+    /**
+     * @brief Whether a coroutine is settling its promise on this thread.
+     */
+    bool finishing = false;
+};
+
+inline thread_local resumption_context context;
+
+/**
+ * @brief Resumes a coroutine whose awaited promise was settled.
+ * @details Resumptions caused by a coroutine finishing are handed back to the
+ * enclosing `resume()` call, which runs them in a loop once the finished
+ * coroutine's frame is gone. Chains of coroutines awaiting each other thus
+ * unwind in constant stack depth, whether or not the compiler turns symmetric 
+ * transfer into tail calls.
+ * @param handle The coroutine to resume
+ */
+inline void resume(std::coroutine_handle<> handle) {
+    auto &local = context;
+    if(local.suspending == handle) {
+        local.ready = true;
+        return;
+    }
+    if(local.finishing && local.next != nullptr && !*local.next) {
+        *local.next = handle;
+        return;
+    }
+
+    std::coroutine_handle<> next;
+    const auto previous_next = std::exchange(local.next, &next);
+    const auto previous_finishing = std::exchange(local.finishing, false);
+    while(handle) {
+        handle.resume();
+        handle = std::exchange(next, nullptr);
+    }
+    local.next = previous_next;
+    local.finishing = previous_finishing;
+}
+
+/**
+ * @brief Owns a suspended coroutine, destroying it unless it is released for
+ * resumption. A coroutine awaiting a promise that is dropped without being
+ * settled is thus freed along with the promise.
+ */
+class suspended_coroutine {
+    std::coroutine_handle<> handle;
+
+public:
+    explicit suspended_coroutine(std::coroutine_handle<> handle) noexcept :
+        handle { handle }
+        {  }
+
+    suspended_coroutine(suspended_coroutine &&other) noexcept :
+        handle { std::exchange(other.handle, nullptr) }
+        {  }
+
+    suspended_coroutine(const suspended_coroutine &) = delete;
+
+    ~suspended_coroutine() noexcept {
+        if(handle) {
+            handle.destroy();
+        }
+    }
+
+    suspended_coroutine &operator=(const suspended_coroutine &) = delete;
+    suspended_coroutine &operator=(suspended_coroutine &&) = delete;
+
+    inline std::coroutine_handle<> release() noexcept {
+        return std::exchange(handle, nullptr);
+    }
+};
+
+/**
+ * @brief The awaiter returned by `co_await`ing a `promise_ptr`.
+ * @details The awaiting coroutine is attached as the promise's settle handler,
+ * which requires neither a chained promise nor an allocation. While suspended,
+ * the handler owns the coroutine and the coroutine does not own the promise,
+ * so neither keeps the other alive. On resumption, rejections are rethrown and
+ * resolved values are moved out if the awaiter holds the last reference to the
+ * promise and copied otherwise.
+ * @tparam T The type of the awaited promise
+ */
+template<class T>
+class promise_awaiter {
+    promise_ptr<T> awaited;
+
+public:
+    explicit promise_awaiter(promise_ptr<T> awaited) noexcept :
+        awaited { std::move(awaited) }
+        {  }
+
+    inline bool await_ready() const noexcept {
+        return !awaited->is_pending();
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        // Once the handler is attached, another thread may resume and destroy
+        // the coroutine -- and with it, this awaiter.
+        auto keep = std::move(awaited);
+        auto &local = context;
+        const auto previous = std::exchange(local.suspending, handle);
+        const auto previously_ready = std::exchange(local.ready, false);
+
+        try {
+            settle_access::attach(*keep, [
+                this, 
+                target = keep.get(), 
+                owner = suspended_coroutine { handle }
+            ] () mutable {
+                const auto resumed = owner.release();
+                awaited = target->self();
+                resume(resumed);
+            });
+        } catch(...) {
+            awaited = std::move(keep);
+            local.suspending = previous;
+            local.ready = previously_ready;
+            throw;
+        }
+
+        const auto ready = std::exchange(local.ready, previously_ready);
+        local.suspending = previous;
+        return !ready;
+    }
+
+    T await_resume() {
+        if(awaited->is_rejected()) {
+            std::rethrow_exception(awaited->get_error());
+        }
+
+        if constexpr(!std::is_void_v<T>) {
+            if constexpr(std::is_copy_constructible_v<T>) {
+                if(awaited.use_count() > 1) {
+                    return awaited->get_value();
+                }
+            }
+            return std::move(awaited->get_value());
+        }
+    }
+};
+
+/**
+ * @brief The awaiter of a finishing coroutine. It settles the coroutine's
+ * promise and destroys the frame; a coroutine awaiting the promise is resumed
+ * by the enclosing `resume()` loop, if any, after this one is gone.
+ */
+struct final_awaiter {
+    inline bool await_ready() const noexcept { return false; }
+
+    template<class T_frame>
+    void await_suspend(std::coroutine_handle<T_frame> handle) noexcept {
+        auto &local = context;
+        const auto previous = std::exchange(local.finishing, true);
+        handle.promise().settle();
+        local.finishing = previous;
+        handle.destroy();
+    }
+
+    inline void await_resume() const noexcept {  }
+};
+
+/**
+ * @brief The part of a coroutine's promise type that does not depend on how
+ * the coroutine returns.
+ * @details Coroutines start eagerly, like JS async functions, and their frames
+ * are drawn from `size_class_pool` when a `promise_arena` is active.
+ * @tparam T The type of the promise returned by the coroutine
+ */
+template<class T>
+class frame_promise_base {
+    /**
+     * @brief Prefix stored before each frame to record where it was allocated.
+     * It is as large as the fundamental alignment so frames stay aligned.
+     */
+    static constexpr std::size_t header_size = size_class_pool::granularity;
+
+protected:
+    promise_ptr<T> result = make_pending<T>();
+    std::exception_ptr error;
+
+    /**
+     * @brief Settles the coroutine's promise, which is left rejected rather
+     * than thrown if nothing handles the rejection yet.
+     * @tparam T_settle The type of the functor that resolves the promise
+     * @param resolve The functor that resolves the promise
+     */
+    template<class T_settle>
+    void settle_with(T_settle &&resolve) noexcept {
+        try {
+            if(error) {
+                result->reject(error);
+            } else {
+                resolve();
+            }
+        } catch(...) {
+            if(result->is_pending()) {
+                try {
+                    result->reject(std::current_exception());
+                } catch(...) {  }
+            }
+        }
+    }
+
+public:
+    inline promise_ptr<T> get_return_object() const noexcept { return result; }
+    inline std::suspend_never initial_suspend() const noexcept { return {  }; }
+    inline final_awaiter final_suspend() const noexcept { return {  }; }
+
+    inline void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+
+    static void *operator new(std::size_t size) {
+        const bool pooled = promise_arena::active();
+        auto *block = static_cast<unsigned char *>(
+            pooled ?
+                size_class_pool::allocate(size + header_size) :
+                ::operator new(size + header_size)
+        );
+        *block = pooled;
+        return block + header_size;
+    }
+
+    static void operator delete(void *frame, std::size_t size) noexcept {
+        auto *block = static_cast<unsigned char *>(frame) - header_size;
+        if(*block) {
+            size_class_pool::deallocate(block, size + header_size);
+        } else {
+            ::operator delete(block);
+        }
+    }
+};
+
+/**
+ * @brief The promise type of coroutines returning a `promise_ptr<T>`.
+ * @tparam T The type of the promise returned by the coroutine
+ */
+template<class T>
+class frame_promise : public frame_promise_base<T> {
+    std::optional<T> value;
+
+public:
+    template<class T_value = T>
+    void return_value(T_value &&returned_value) {
+        value.emplace(std::forward<T_value>(returned_value));
+    }
+
+    void settle() noexcept {
+        this->settle_with([this] { this->result->resolve(std::move(*value)); });
+    }
+};
+
+/**
+ * @brief The promise type of coroutines returning a `promise_ptr<void>`.
+ */
+template<>
+class frame_promise<void> : public frame_promise_base<void> {
+public:
+    inline void return_void() const noexcept {  }
+
+    void settle() noexcept {
+        settle_with([this] { result->resolve(); });
+    }
+};
+
+} /* namespace juro::coroutines */
+
+namespace juro {
+
+/**
+ * @brief Awaits a promise from within a coroutine.
+ * @tparam T The type of the awaited promise
+ * @param awaited The awaited promise
+ * @return An awaiter that resumes the coroutine once the promise settles.
+ */
+template<class T>
+inline auto operator co_await(const promise_ptr<T> &awaited) noexcept {
+    return coroutines::promise_awaiter<T> { awaited };
+}
+
+template<class T>
+inline auto operator co_await(promise_ptr<T> &&awaited) noexcept {
+    return coroutines::promise_awaiter<T> { std::move(awaited) };
+}
+
+} /* namespace juro */
+
+/**
+ * @brief Lets any function returning a `juro::promise_ptr<T>` be a coroutine.
+ */
+template<class T, class ...T_args>
+struct std::coroutine_traits<juro::helpers::promise_ptr<T>, T_args...> {
+    using promise_type = juro::coroutines::frame_promise<T>;
+};
+
+#endif /* JURO_CORO_HPP */
@@ -0,0 +1,206 @@
+/**
+ * @file juro/executor.hpp
+ * @brief Contains the executor abstraction used to dispatch promise
+ * continuations, along with the built-in executors.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_EXECUTOR_HPP
+#define JURO_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "juro/config.hpp"
+#include "juro/function.hpp"
+
+namespace juro::executors {
+
+using namespace juro::helpers;
+
+/**
+ * @brief A unit of work submitted to an executor.
+ */
+using task = unique_function<void()>;
+
+/**
+ * @brief Type trait to detect if a type is an executor, i.e., if it has a
+ * `schedule()` member function that accepts a `juro::task`. This clause
+ * activates for non-executor types.
+ * @tparam T The type to inspect
+ */
+template<class T, class = void>
+struct is_executor : std::false_type {  };
+
+/**
+ * @brief Type trait to detect if a type is an executor. This clause activates
+ * for executor types.
+ * @tparam T The type to inspect
+ */
+template<class T>
+struct is_executor<T, std::void_t<
+    decltype(std::declval<T &>().schedule(std::declval<task>()))
+>> : std::true_type {  };
+
+/**
+ * @brief Helper constexpr bool to detect if a given type is an executor
+ * @tparam T The type to inspect
+ */
+template<class T>
+static constexpr inline bool is_executor_v = is_executor<T>::value;
+
+/**
+ * @brief Polymorphic base of executors that can be installed as a promise's
+ * default executor with `promise<T>::via()`. Any type with a suitable
+ * `schedule()` member can be passed to the chaining functions, but only
+ * classes derived from this one can be stored as defaults.
+ */
+class executor {
+public:
+    /**
+     * @brief Submits a task for execution.
+     * @param work The task to be executed
+     */
+    virtual void schedule(task &&work) = 0;
+
+protected:
+    ~executor() = default;
+};
+
+/**
+ * @brief An executor that runs every task immediately, on the scheduling
+ * thread.
+ */
+class inline_executor final : public executor {
+public:
+    void schedule(task &&work) override { work(); }
+};
+
+/**
+ * @brief A single-threaded FIFO executor. Tasks are only run when the owner
+ * drains the queue, e.g. once per event loop tick.
+ * @warning This executor is not synchronised; schedule and run tasks on the
+ * same thread.
+ */
+class queue_executor final : public executor {
+    std::deque<task> tasks;
+
+public:
+    void schedule(task &&work) override { tasks.push_back(std::move(work)); }
+
+    /**
+     * @brief Runs the oldest queued task, if any.
+     * @return Whether a task was run.
+     */
+    bool run_one();
+
+    /**
+     * @brief Runs the tasks that were queued at the time of the call; tasks
+     * scheduled meanwhile are left for the next call.
+     * @return The amount of tasks run.
+     */
+    std::size_t run_pending();
+
+    /**
+     * @brief Runs tasks until the queue is empty, including tasks scheduled
+     * meanwhile.
+     * @return The amount of tasks run.
+     */
+    std::size_t run();
+
+    inline std::size_t size() const noexcept { return tasks.size(); }
+    inline bool empty() const noexcept { return tasks.empty(); }
+};
+
+/**
+ * @brief A work-stealing executor that runs tasks on a fixed set of worker
+ * threads.
+ * @details Each worker owns a Chase-Lev deque: tasks scheduled from a worker
+ * thread are pushed onto its own deque and popped in LIFO order, while idle
+ * workers steal the oldest tasks from their peers' deques. Tasks scheduled
+ * from any other thread go through a shared injection queue. Workers that run
+ * out of work sleep until new tasks are scheduled. Tasks still queued when the
+ * pool is destroyed are run before the workers join. Exceptions escaping a
+ * task are dropped so that its worker keeps running.
+ * @note Promises settled by tasks run on a thread pool are settled on worker
+ * threads; use `juro::make_concurrent()` for promises whose handlers are
+ * attached elsewhere.
+ */
+class thread_pool final : public executor {
+    struct worker;
+
+    /**
+     * @brief The worker threads' state; one entry per thread.
+     */
+    std::unique_ptr<worker[]> workers;
+    std::size_t worker_count;
+    std::vector<std::thread> threads;
+
+    /**
+     * @brief Queue of tasks scheduled from threads outside the pool.
+     */
+    std::mutex injection_mutex;
+    std::deque<task *> injected;
+    std::atomic<std::size_t> injected_count { 0 };
+
+    /**
+     * @brief The amount of tasks scheduled but not yet taken by a worker.
+     */
+    std::atomic<std::size_t> queued { 0 };
+
+    /**
+     * @brief The amount of workers sleeping or about to sleep.
+     */
+    std::atomic<std::size_t> idle { 0 };
+
+    std::mutex sleep_mutex;
+    std::condition_variable available;
+    bool stopping = false;
+
+public:
+    /**
+     * @brief Starts the worker threads.
+     * @param thread_count The amount of worker threads; defaults to the
+     * amount of hardware threads.
+     */
+    explicit thread_pool(std::size_t thread_count = default_thread_count());
+    thread_pool(const thread_pool &) = delete;
+    thread_pool(thread_pool &&) = delete;
+    ~thread_pool();
+
+    thread_pool &operator=(const thread_pool &) = delete;
+    thread_pool &operator=(thread_pool &&) = delete;
+
+    void schedule(task &&work) override;
+
+    inline std::size_t thread_count() const noexcept { return worker_count; }
+
+    /**
+     * @brief Returns whether the calling thread is one of this pool's
+     * workers.
+     */
+    bool is_worker_thread() const noexcept;
+
+    /**
+     * @brief Returns the amount of hardware threads, or `1` if unknown.
+     */
+    static std::size_t default_thread_count() noexcept;
+
+private:
+    void work(std::size_t index);
+    task *find_task(std::size_t index) noexcept;
+};
+
+} /* namespace juro::executors */
+
+#ifdef JURO_HEADER_ONLY
+#include "juro/impl/executor.ipp"
+#endif /* JURO_HEADER_ONLY */
+
+#endif /* JURO_EXECUTOR_HPP */
@@ -8,11 +8,65 @@
 #ifndef JURO_FACTORIES_HPP
 #define JURO_FACTORIES_HPP
 
+#include <memory>
+#include <type_traits>
 #include "juro/helpers.hpp"
+#include "juro/allocation.hpp"
 
 namespace juro::factories {
 
 using namespace juro::helpers;
+using namespace juro::allocation;
+
+/**
+ * @brief Allocates a new promise with a custom allocator.
+ * @tparam T The type of the promise being created
+ * @tparam T_allocator The type of the allocator
+ * @tparam ...T_args The types of the promise constructor arguments
+ * @param allocator The allocator used to allocate the promise and its 
+ * reference counter in a single allocation
+ * @param ...args The promise constructor arguments
+ * @return The newly created promise
+ */
+template<class T, class T_allocator, class ...T_args>
+promise_ptr<T> allocate_promise(const T_allocator &allocator, T_args &&...args) {
+#ifdef JURO_INTRUSIVE_PTR
+    return allocated_promise<T, T_allocator>::create(
+        allocator, 
+        std::forward<T_args>(args)...
+    );
+#else
+    return std::allocate_shared<promise<T>>(
+        allocator, 
+        std::forward<T_args>(args)...
+    );
+#endif /* JURO_INTRUSIVE_PTR */
+}
+
+/**
+ * @brief Allocates a new promise with the default allocation strategy: if a
+ * `juro::promise_arena` is active on the current thread (or
+ * `JURO_POOL_ALLOCATION` is set), the promise is drawn from the per-thread
+ * pool, otherwise it is allocated by `std::make_shared`.
+ * @tparam T The type of the promise being created
+ * @tparam ...T_args The types of the promise constructor arguments
+ * @param ...args The promise constructor arguments
+ * @return The newly created promise
+ */
+template<class T, class ...T_args>
+promise_ptr<T> construct_promise(T_args &&...args) {
+#ifdef JURO_INTRUSIVE_PTR
+    if(promise_arena::active()) {
+        return allocate_promise<T>(
+            pool_allocator<promise<T>> {  }, 
+            std::forward<T_args>(args)...
+        );
+    }
+    return promise_ptr<T> { new promise<T> { std::forward<T_args>(args)... } };
+#else
+    return make_shared_object<promise<T>>(std::forward<T_args>(args)...);
+#endif /* JURO_INTRUSIVE_PTR */
+}
 
 /**
  * @brief Creates a new promise and supplies it to the provided launcher 
@@ -28,7 +82,32 @@ auto make_promise(T_launcher &&launcher) {
         std::is_invocable_v<T_launcher, const promise_ptr<T> &>,
         "Launcher function has an incompatible signature."
     );
-    const auto p = std::make_shared<promise<T>>();
+    const auto p = construct_promise<T>();
+    launcher(p);
+    return p;
+}
+
+/**
+ * @brief Creates a new promise with a custom allocator and supplies it to the 
+ * provided launcher functor.
+ * @tparam T The type of the promise being created
+ * @tparam T_allocator The type of the allocator
+ * @tparam T_launcher The type of the launched functor
+ * @param allocator The allocator used to allocate the promise
+ * @param launcher The launched functor
+ * @return The newly created promise
+ */
+template<class T = void, class T_allocator, class T_launcher>
+auto make_promise(
+    std::allocator_arg_t, 
+    const T_allocator &allocator, 
+    T_launcher &&launcher
+) {
+    static_assert(
+        std::is_invocable_v<T_launcher, const promise_ptr<T> &>,
+        "Launcher function has an incompatible signature."
+    );
+    const auto p = allocate_promise<T>(allocator);
     launcher(p);
     return p;
 }
@@ -40,7 +119,51 @@ auto make_promise(T_launcher &&launcher) {
  */
 template<class T = void>
 auto make_pending() {
-    return std::make_shared<promise<T>>();
+    return construct_promise<T>();
+}
+
+/**
+ * @brief Creates a new pending promise with a custom allocator.
+ * @tparam T The type of the promise being created
+ * @tparam T_allocator The type of the allocator
+ * @param allocator The allocator used to allocate the promise
+ * @return The newly created promise
+ */
+template<class T = void, class T_allocator>
+auto make_pending(std::allocator_arg_t, const T_allocator &allocator) {
+    return allocate_promise<T>(allocator);
+}
+
+/**
+ * @brief Creates a new pending concurrent promise. Concurrent promises may be
+ * settled on one thread while their settle handler is attached on another;
+ * their continuations run exactly once, on whichever thread completes the
+ * pair. Promises chained onto them are concurrent as well.
+ * @tparam T The type of the promise being created
+ * @return The newly created promise
+ */
+template<class T = void>
+auto make_concurrent() {
+    return construct_promise<T>(concurrent_promise_tag {  });
+}
+
+/**
+ * @brief Creates a new concurrent promise and supplies it to the provided 
+ * launcher functor.
+ * @tparam T The type of the promise being created
+ * @tparam T_launcher The type of the launched functor
+ * @param launcher The launched functor
+ * @return The newly created promise
+ */
+template<class T = void, class T_launcher>
+auto make_concurrent(T_launcher &&launcher) {
+    static_assert(
+        std::is_invocable_v<T_launcher, const promise_ptr<T> &>,
+        "Launcher function has an incompatible signature."
+    );
+    const auto p = construct_promise<T>(concurrent_promise_tag {  });
+    launcher(p);
+    return p;
 }
 
 /**
@@ -52,7 +175,29 @@ auto make_pending() {
  */
 template<class T>
 auto make_resolved(T &&value) {
-    return std::make_shared<promise<bare_t<T>>>(
+    return construct_promise<bare_t<T>>(
+        resolved_promise_tag {  }, 
+        std::forward<T>(value)
+    );
+}
+
+/**
+ * @brief Creates a new non-void resolved promise with a custom allocator.
+ * @tparam T The type of the promise being created. Unless explicitly supplied,
+ * will be inferred from the `value` parameter.
+ * @tparam T_allocator The type of the allocator
+ * @param allocator The allocator used to allocate the promise
+ * @param value The value with which to resolve the promise
+ * @return The newly created promise
+ */
+template<class T, class T_allocator>
+auto make_resolved(
+    std::allocator_arg_t, 
+    const T_allocator &allocator, 
+    T &&value
+) {
+    return allocate_promise<bare_t<T>>(
+        allocator,
         resolved_promise_tag {  }, 
         std::forward<T>(value)
     );
@@ -63,7 +208,22 @@ auto make_resolved(T &&value) {
  * @return The newly created promise
  */
 inline auto make_resolved() { 
-    return std::make_shared<promise<void>>(
+    return construct_promise<void>(
+        resolved_promise_tag {  }, 
+        void_type {  }
+    );
+}
+
+/**
+ * @brief Creates a new void resolved promise with a custom allocator.
+ * @tparam T_allocator The type of the allocator
+ * @param allocator The allocator used to allocate the promise
+ * @return The newly created promise
+ */
+template<class T_allocator>
+auto make_resolved(std::allocator_arg_t, const T_allocator &allocator) { 
+    return allocate_promise<void>(
+        allocator,
         resolved_promise_tag {  }, 
         void_type {  }
     );
@@ -83,12 +243,84 @@ inline auto make_resolved() {
  */
 template<class T = void, class T_value = promise_error>
 auto make_rejected(T_value &&value = T_value { "Promise was rejected" }) {
-    return std::make_shared<promise<bare_t<T>>>(
+    return construct_promise<bare_t<T>>(
         rejected_promise_tag {  }, 
         std::forward<T_value>(value)
     );
 }
 
+/**
+ * @brief Creates a new rejected promise with a custom allocator.
+ * @tparam T The type of the promise being created. If unsupplied, defaults to 
+ * `void`
+ * @tparam T_allocator The type of the allocator
+ * @tparam T_value The type of the value with which to reject the promise
+ * @param allocator The allocator used to allocate the promise
+ * @param value The value with which to reject the promise
+ * @return The newly create promise
+ */
+template<class T = void, class T_allocator, class T_value = promise_error>
+auto make_rejected(
+    std::allocator_arg_t, 
+    const T_allocator &allocator, 
+    T_value &&value = T_value { "Promise was rejected" }
+) {
+    return allocate_promise<bare_t<T>>(
+        allocator,
+        rejected_promise_tag {  }, 
+        std::forward<T_value>(value)
+    );
+}
+
+/**
+ * @brief Runs a function through an executor and returns a promise of its
+ * result. The promise is concurrent, so it may be chained on the calling 
+ * thread while the function runs elsewhere, e.g. on a `juro::thread_pool`.
+ * @details If the function returns a value, the promise is resolved with it; 
+ * if it returns a promise, that promise is piped into the returned one; if it
+ * throws, the promise is rejected with the thrown exception.
+ * @tparam T_executor The type of the executor
+ * @tparam T_function The type of the function
+ * @param dispatcher The executor through which to run the function
+ * @param function The function to be run
+ * @return A promise of the function's result
+ */
+template<class T_executor, class T_function>
+auto async(T_executor &dispatcher, T_function &&function) {
+    using result_type = std::invoke_result_t<bare_t<T_function> &>;
+    using value_type = unwrap_if_promise_t<result_type>;
+
+    auto result = make_concurrent<value_type>();
+    dispatcher.schedule([
+        result, 
+        function = std::forward<T_function>(function)
+    ] () mutable {
+        try {
+            if constexpr(std::is_void_v<result_type>) {
+                function();
+                result->resolve();
+            } else if constexpr(is_promise_v<result_type>) {
+                if constexpr(std::is_void_v<value_type>) {
+                    function()->then(
+                        [result] { result->resolve(); },
+                        [result] (auto &error) { result->reject(error); }
+                    );
+                } else {
+                    function()->then(
+                        [result] (auto &value) { result->resolve(std::move(value)); },
+                        [result] (auto &error) { result->reject(error); }
+                    );
+                }
+            } else {
+                result->resolve(function());
+            }
+        } catch(...) {
+            result->reject(std::current_exception());
+        }
+    });
+    return result;
+}
+
 } /* namespace juro::factories */
 
 #endif /* JURO_FACTORIES_HPP */
\ No newline at end of file
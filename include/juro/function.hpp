@@ -0,0 +1,224 @@
+/**
+ * @file juro/function.hpp
+ * @brief Contains a move-only, type-erased callable wrapper with an inline
+ * buffer, used to store settle handlers.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_FUNCTION_HPP
+#define JURO_FUNCTION_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief The default size, in bytes, of the inline buffer of a
+ * `juro::unique_function`. Callables up to this size are stored without any
+ * dynamic allocation. The default fits the settle handler of a `then()` whose
+ * resolve handler captures a single pointer.
+ */
+#ifndef JURO_FUNCTION_BUFFER_SIZE
+#define JURO_FUNCTION_BUFFER_SIZE 32
+#endif /* JURO_FUNCTION_BUFFER_SIZE */
+
+namespace juro::helpers {
+
+template<class, std::size_t = JURO_FUNCTION_BUFFER_SIZE>
+class unique_function;
+
+/**
+ * @brief A move-only, type-erased callable wrapper.
+ * @details Unlike `std::function`, the wrapped callable does not need to be
+ * copyable. Callables that fit into `Capacity` bytes, are not over-aligned and
+ * are nothrow move constructible are stored inline; every other callable is
+ * stored on the heap.
+ * @tparam T_result The return type of the callable
+ * @tparam ...T_args The argument types of the callable
+ * @tparam Capacity The size of the inline buffer in bytes
+ */
+template<class T_result, class ...T_args, std::size_t Capacity>
+class unique_function<T_result(T_args...), Capacity> {
+    template<class, std::size_t> friend class unique_function;
+
+    /**
+     * @brief The operations needed to manipulate a stored callable.
+     */
+    struct operations {
+        T_result (*invoke)(void *, T_args &&...);
+        void (*relocate)(void *, void *) noexcept;
+        void (*destroy)(void *) noexcept;
+    };
+
+    /**
+     * @brief Whether a callable type can be stored in the inline buffer.
+     * @tparam T_callable The callable type
+     */
+    template<class T_callable>
+    static constexpr inline bool is_inline =
+        sizeof(T_callable) <= Capacity &&
+        alignof(T_callable) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<T_callable>;
+
+    /**
+     * @brief Operations for callables stored in the inline buffer.
+     * @tparam T_callable The callable type
+     */
+    template<class T_callable>
+    static constexpr inline operations inline_operations {
+        [] (void *storage, T_args &&...args) -> T_result {
+            return std::invoke(
+                *static_cast<T_callable *>(storage),
+                std::forward<T_args>(args)...
+            );
+        },
+        [] (void *from, void *to) noexcept {
+            auto *callable = static_cast<T_callable *>(from);
+            ::new(to) T_callable { std::move(*callable) };
+            callable->~T_callable();
+        },
+        [] (void *storage) noexcept {
+            static_cast<T_callable *>(storage)->~T_callable();
+        }
+    };
+
+    /**
+     * @brief Operations for callables stored on the heap; the inline buffer
+     * holds only a pointer to the callable.
+     * @tparam T_callable The callable type
+     */
+    template<class T_callable>
+    static constexpr inline operations heap_operations {
+        [] (void *storage, T_args &&...args) -> T_result {
+            return std::invoke(
+                **static_cast<T_callable **>(storage),
+                std::forward<T_args>(args)...
+            );
+        },
+        [] (void *from, void *to) noexcept {
+            ::new(to) T_callable * { *static_cast<T_callable **>(from) };
+        },
+        [] (void *storage) noexcept {
+            delete *static_cast<T_callable **>(storage);
+        }
+    };
+
+    /**
+     * @brief The inline buffer.
+     */
+    alignas(std::max_align_t) unsigned char storage[
+        Capacity < sizeof(void *) ? sizeof(void *) : Capacity
+    ];
+
+    /**
+     * @brief The operations of the stored callable or `nullptr` if empty.
+     */
+    const operations *ops = nullptr;
+
+public:
+    /**
+     * @brief Constructs an empty function.
+     */
+    unique_function() noexcept = default;
+
+    /**
+     * @brief Constructs an empty function.
+     */
+    unique_function(std::nullptr_t) noexcept {  }
+
+    /**
+     * @brief Constructs a function wrapping the supplied callable.
+     * @tparam T_callable The callable type
+     * @param callable The callable to be stored
+     */
+    template<
+        class T_callable,
+        class = std::enable_if_t<
+            !std::is_same_v<std::decay_t<T_callable>, unique_function> &&
+            std::is_invocable_r_v<T_result, std::decay_t<T_callable> &, T_args...>
+        >
+    >
+    unique_function(T_callable &&callable) {
+        using callable_type = std::decay_t<T_callable>;
+
+        if constexpr(is_inline<callable_type>) {
+            ::new(static_cast<void *>(storage))
+                callable_type { std::forward<T_callable>(callable) };
+            ops = &inline_operations<callable_type>;
+        } else {
+            ::new(static_cast<void *>(storage)) callable_type * {
+                new callable_type { std::forward<T_callable>(callable) }
+            };
+            ops = &heap_operations<callable_type>;
+        }
+    }
+
+    unique_function(const unique_function &) = delete;
+
+    unique_function(unique_function &&other) noexcept : ops { other.ops } {
+        if(ops != nullptr) {
+            ops->relocate(other.storage, storage);
+            other.ops = nullptr;
+        }
+    }
+
+    ~unique_function() noexcept { reset(); }
+
+    unique_function &operator=(const unique_function &) = delete;
+
+    unique_function &operator=(unique_function &&other) noexcept {
+        if(this != &other) {
+            reset();
+            if(other.ops != nullptr) {
+                other.ops->relocate(other.storage, storage);
+                ops = std::exchange(other.ops, nullptr);
+            }
+        }
+        return *this;
+    }
+
+    unique_function &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    /**
+     * @brief Invokes the stored callable. Calling an empty function is
+     * undefined behaviour.
+     * @param ...args The arguments to forward to the callable
+     * @return Whatever the callable returns
+     */
+    T_result operator()(T_args ...args) {
+        return ops->invoke(storage, std::forward<T_args>(args)...);
+    }
+
+    /**
+     * @brief Returns whether a callable is stored.
+     */
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    /**
+     * @brief Destroys the stored callable, if any, leaving the function empty.
+     */
+    void reset() noexcept {
+        if(ops != nullptr) {
+            std::exchange(ops, nullptr)->destroy(storage);
+        }
+    }
+
+    /**
+     * @brief Returns whether a callable type would be stored without any
+     * dynamic allocation.
+     * @tparam T_callable The callable type
+     */
+    template<class T_callable>
+    static constexpr bool stores_inline() noexcept {
+        return is_inline<std::decay_t<T_callable>>;
+    }
+};
+
+} /* namespace juro::helpers */
+
+#endif /* JURO_FUNCTION_HPP */
@@ -7,24 +7,39 @@
 #ifndef JURO_HELPERS_HPP
 #define JURO_HELPERS_HPP
 
+#include <exception>
 #include <memory>
 #include <optional>
 #include <type_traits>
 #include <stdexcept>
+#include <tuple>
 #include <variant>
+#include "juro/intrusive_ptr.hpp"
 
 namespace juro {
 template<class> class promise;
+template<class, class> class allocated_promise;
+template<class> class shared_promise;
 } /* namespace juro */
 
 namespace juro::helpers {
 
+#ifdef JURO_INTRUSIVE_PTR
+/**
+ * @brief An intrusive pointer to a `promise<T>`; the reference counter is 
+ * embedded in the promise itself.
+ * @tparam T The type of the promised value
+ */
+template<class T>
+using promise_ptr = intrusive_ptr<promise<T>>;
+#else
 /**
  * @brief A shared pointer to a `promise<T>`
  * @tparam T The type of the promised value
  */
 template<class T>
 using promise_ptr = std::shared_ptr<promise<T>>;
+#endif /* JURO_INTRUSIVE_PTR */
 
 /**
  * @brief The exception error thrown by invalid promise operations
@@ -33,6 +48,13 @@ struct promise_error : std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
+/**
+ * @brief The rejection reason of a promise that was cancelled while pending
+ */
+struct cancellation_error : promise_error {
+    using promise_error::promise_error;
+};
+
 /**
  * @brief The possible states of a promise at one given time
  */
@@ -50,6 +72,89 @@ struct resolved_promise_tag {  };
  */
 struct rejected_promise_tag {  };
 
+/**
+ * @brief Tag type to disambiguate the concurrent promise constructor call.
+ * Concurrent promises may be settled and chained from different threads.
+ */
+struct concurrent_promise_tag {  };
+
+/**
+ * @brief Grants juro's own building blocks -- compositions and coroutine
+ * awaiters -- direct access to a promise's settle handler, so they can observe
+ * settlement without chaining a new promise.
+ */
+struct settle_access {
+    /**
+     * @brief Attaches a settle handler to a promise, replacing any previously
+     * attached one.
+     * @tparam T_promise The type of the promise
+     * @tparam T_handler The type of the handler
+     * @param target The promise to observe
+     * @param handler The functor invoked once the promise is settled
+     */
+    template<class T_promise, class T_handler>
+    static inline void attach(T_promise &target, T_handler &&handler) {
+        target.set_settle_handler(std::forward<T_handler>(handler));
+    }
+
+    /**
+     * @brief Replaces a promise's settle handler with a no-op, freeing 
+     * whatever the previous handler captured while keeping the promise's 
+     * rejections handled. Concurrent promises, whose handler cannot be 
+     * replaced, are left untouched.
+     * @tparam T_promise The type of the promise
+     * @param target The promise to stop observing
+     */
+    template<class T_promise>
+    static inline void release(T_promise &target) {
+        if(!target.is_concurrent()) {
+            target.set_settle_handler([] {  });
+        }
+    }
+
+    /**
+     * @brief Resolves a promise through a handle held by the library. If no
+     * other handle to the promise exists, nothing but the observer of its
+     * settlement can read the value, which may then be moved out of it.
+     * @tparam T_promise The type of the handle
+     * @tparam ...T_values The type of the resolved value, if any
+     * @param target The handle to the promise to resolve
+     * @param values The value to resolve the promise with, if any
+     */
+    template<class T_promise, class ...T_values>
+    static inline void resolve_owned(const T_promise &target, T_values &&...values) {
+        if(target.use_count() == 1) {
+            target->mark_unobserved();
+        }
+        target->resolve(std::forward<T_values>(values)...);
+    }
+
+    /**
+     * @brief Returns whether the value of a resolved promise may be moved out
+     * by the observer of its settlement.
+     * @see `juro::helpers::settle_access::resolve_owned()`
+     * @tparam T_promise The type of the promise
+     * @param target The resolved promise
+     */
+    template<class T_promise>
+    static inline bool is_unobserved(const T_promise &target) noexcept {
+        return target.is_unobserved();
+    }
+
+    /**
+     * @brief Records that a promise waits on another one, so that cancelling
+     * the waiting promise cancels the awaited one as well.
+     * @tparam T_upstream The type of the awaited promise
+     * @tparam T_downstream The type of the waiting promise
+     * @param upstream The awaited promise
+     * @param downstream The waiting promise
+     */
+    template<class T_upstream, class T_downstream>
+    static inline void link(T_upstream &upstream, T_downstream &downstream) noexcept {
+        upstream.link_downstream(downstream);
+    }
+};
+
 /**
  * @brief Tag struct to represent an absent value. This is used by pending 
  * promises as a value placeholder.
@@ -192,15 +297,31 @@ struct is_promise<promise_ptr<T>> : public std::true_type {  };
 template<class T>
 static constexpr inline bool is_promise_v = is_promise<T>::value;
 
+/**
+ * @brief Helper constexpr bool to detect if a resolve handler can only take the
+ * resolved value as an rvalue, e.g. `[] (T &&value) { ... }`.
+ * @tparam T The promise type
+ * @tparam T_on_resolve The resolve handler type
+ */
+template<class T, class T_on_resolve>
+static constexpr inline bool takes_rvalue_v =
+    !std::is_invocable_v<T_on_resolve, T &> &&
+    std::is_invocable_v<T_on_resolve, T &&>;
+
 /**
  * @brief Type trait to determine what type does a resolve handler returns. This
- * clause activates for non-void promises.
+ * clause activates for non-void promises. Handlers that can only take the 
+ * value as an rvalue are invoked with the value moved.
  * @tparam T The promise type
  * @tparam T_on_resolve The resolve handler type
  */
 template<class T, class T_on_resolve>
 struct resolve_result {
-    using type = std::invoke_result_t<T_on_resolve, T &>;
+    using type = typename std::conditional_t<
+        takes_rvalue_v<T, T_on_resolve>,
+        std::invoke_result<T_on_resolve, T &&>,
+        std::invoke_result<T_on_resolve, T &>
+    >::type;
 };
 
 /**
@@ -251,10 +372,24 @@ using reject_result_t = std::invoke_result_t<T_on_reject, std::exception_ptr &>;
  * @tparam T_on_reject The supplied reject handler type
  */
 template<class T, class T_on_resolve, class T_on_reject>
-using chained_promise_type = common_container_t<
-    unwrap_if_promise_t<resolve_result_t<T, T_on_resolve>>,
-    unwrap_if_promise_t<reject_result_t<T_on_reject>>
->;
+struct chained_promise {
+    using type = common_container_t<
+        unwrap_if_promise_t<resolve_result_t<T, T_on_resolve>>,
+        unwrap_if_promise_t<reject_result_t<T_on_reject>>
+    >;
+};
+
+/**
+ * @brief Helper alias to `chained_promise<T, T_on_resolve, T_on_reject>::type`.
+ * As it names a class template specialisation, the deduction is carried out
+ * once per set of handler types and reused by every call site.
+ * @tparam T The promise type
+ * @tparam T_on_resolve The supplied resolve handler type
+ * @tparam T_on_reject The supplied reject handler type
+ */
+template<class T, class T_on_resolve, class T_on_reject>
+using chained_promise_type = 
+    typename chained_promise<T, T_on_resolve, T_on_reject>::type;
 
 /**
  * @brief Determines the type of the parameter that a `.finally()` handler takes.
@@ -348,40 +483,101 @@ using rejected_promise_value_t =
     unwrap_if_promise_t<reject_result_t<T_on_resolve>>;
 
 /**
- * @brief Store unique types into a tuple. Default clause for already unique 
- * tuples.
- * @tparam T_tuple The tuple type
- * @tparam ... The types to filter
+ * @brief The reject handler of chaining functions that only handle resolution.
+ * It is never invoked by the library: the rejection is handed to the chained
+ * promise as is, sparing a rethrow and catch for every step of the chain. Its
+ * return type only takes part in deducing the chained promise type.
+ * @tparam T_result The type returned by the resolve handler
  */
-template<class T_tuple, class ...>
-struct unique { 
-    using type = T_tuple; 
+template<class T_result>
+struct rejection_forwarder {
+    [[noreturn]] T_result operator()(std::exception_ptr &error) const {
+        std::rethrow_exception(error);
+    }
 };
 
 /**
- * @brief Stores unique types into a tuple. This clause is activated when at
- * least one type is yet unfiltered in a recursive manner.
+ * @brief Type trait to detect if a reject handler is a `rejection_forwarder`.
+ * @tparam T The type to inspect
+ */
+template<class T>
+struct is_rejection_forwarder : public std::false_type {  };
+
+template<class T_result>
+struct is_rejection_forwarder<rejection_forwarder<T_result>> : 
+    public std::true_type {  };
+
+/**
+ * @brief Helper constexpr bool to detect if a reject handler forwards
+ * rejections to the chained promise.
+ * @tparam T_on_reject The type of the reject handler
+ */
+template<class T_on_reject>
+static constexpr inline bool forwards_rejection_v =
+    is_rejection_forwarder<std::decay_t<T_on_reject>>::value;
+
+/**
+ * @brief The resolve handler of chaining functions that only handle rejection.
+ * It hands the resolved value on to the chained promise, which the library
+ * does directly, moving the value when no one else can observe it.
+ */
+struct value_passthrough {
+    inline void operator()() const noexcept {  }
+
+    template<class T_value>
+    inline T_value operator()(T_value &value) const { return value; }
+};
+
+/**
+ * @brief Helper constexpr bool to detect if a resolve handler is a 
+ * `value_passthrough`.
+ * @tparam T_on_resolve The type to inspect
+ */
+template<class T_on_resolve>
+static constexpr inline bool passes_value_through_v =
+    std::is_same_v<std::decay_t<T_on_resolve>, value_passthrough>;
+
+/**
+ * @brief Wraps a type into an empty, constructible object, so types can be
+ * handed around as values in fold expressions.
+ * @tparam T The wrapped type
+ */
+template<class T>
+struct type_tag {
+    using type = T;
+};
+
+/**
+ * @brief A set of unique types, represented as a class deriving from the tag
+ * of each of them. Membership is thus a single base lookup, and a type is
+ * added by folding over `operator+`, so filtering N types takes N steps and 
+ * no recursive instantiations.
  * @tparam ...T_values The unique stored types
- * @tparam T The type being currently tested
- * @tparam ...T_rest The rest of the unfiltered types
- */
-template<class ...T_values, class T, class ...T_rest>
-struct unique<std::tuple<T_values...>, T, T_rest...> {
-    using type = std::conditional_t<
-        std::disjunction_v<std::is_same<T, T_values>...>,
-        typename unique<std::tuple<T_values...>, T_rest...>::type,
-        typename unique<std::tuple<T_values..., T>, T_rest...>::type
-    >;
+ */
+template<class ...T_values>
+struct unique_set : type_tag<T_values>... {
+    using type = std::tuple<T_values...>;
+
+    template<class T>
+    constexpr auto operator+(type_tag<T>) const noexcept {
+        if constexpr(std::is_base_of_v<type_tag<T>, unique_set>) {
+            return unique_set {  };
+        } else {
+            return unique_set<T_values..., T> {  };
+        }
+    }
 };
 
 /**
- * @brief Stores unique types into a tuple. This is the trampoline 
- * implementation that delegates to the others.
- * @tparam ...T_values The values to filter
+ * @brief Stores unique types into a tuple, in order of first appearance.
+ * @tparam ...T_values The types to filter
  */
 template<class ...T_values>
-struct unique<std::tuple<>, std::tuple<T_values...>> : 
-    unique<std::tuple<>, T_values...> {  };
+struct unique {
+    using type = typename decltype(
+        (unique_set<> {  } + ... + type_tag<T_values> {  })
+    )::type;
+};
 
 /**
  * @brief Helper type that aliases `unique<T_values...>::type`. This defines
@@ -389,7 +585,7 @@ struct unique<std::tuple<>, std::tuple<T_values...>> :
  * @tparam ...T_values The types to filter.
  */
 template<class ...T_values>
-using unique_t = typename unique<std::tuple<>, std::tuple<T_values...>>::type;
+using unique_t = typename unique<T_values...>::type;
 
 /**
  * @brief Custom implementation of `std::remove_cvref_t`
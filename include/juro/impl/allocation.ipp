@@ -0,0 +1,132 @@
+/**
+ * @file juro/impl/allocation.ipp
+ * @brief Contains the definitions of the size-class pool.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_IMPL_ALLOCATION_IPP
+#define JURO_IMPL_ALLOCATION_IPP
+
+#include <mutex>
+#include <vector>
+#include "juro/allocation.hpp"
+
+namespace juro::allocation {
+
+namespace detail {
+
+/**
+ * @brief Batches of free blocks handed over by threads, along with every
+ * chunk ever carved so they remain reachable. It is never destroyed, so that
+ * blocks released by static destructors can still be handed over.
+ */
+struct orphanage {
+    std::mutex mutex;
+    void *batches[size_class_pool::class_count] = {  };
+    std::vector<void *> chunks;
+};
+
+JURO_DECL orphanage &orphans() {
+    static auto *instance = new orphanage;
+    return *instance;
+}
+
+/**
+ * @brief Whether the current thread's free lists were destroyed.
+ */
+JURO_DECL thread_local bool pool_retired = false;
+
+} /* namespace detail */
+
+JURO_DECL size_class_pool::local_pool::~local_pool() {
+    detail::pool_retired = true;
+    for(std::size_t index = 0; index < class_count; index++) {
+        if(heads[index] != nullptr) {
+            orphan(index, heads[index]);
+        }
+    }
+}
+
+JURO_DECL size_class_pool::local_pool *size_class_pool::local() noexcept {
+    if(detail::pool_retired) {
+        return nullptr;
+    }
+    static thread_local local_pool pool;
+    return &pool;
+}
+
+JURO_DECL size_class_pool::free_block *size_class_pool::refill(
+    std::size_t index,
+    std::size_t &count
+) {
+    auto &shared = detail::orphans();
+    std::unique_lock lock { shared.mutex };
+
+    if(shared.batches[index] != nullptr) {
+        auto *head = static_cast<free_block *>(shared.batches[index]);
+        shared.batches[index] = head->next_batch;
+        lock.unlock();
+
+        count = 0;
+        for(auto *block = head; block != nullptr; block = block->next) {
+            count++;
+        }
+        return head;
+    }
+
+    const auto block_size = (index + 1) * granularity;
+    const auto block_count = batch_size(index);
+    auto *chunk = static_cast<char *>(::operator new(block_count * block_size));
+    shared.chunks.push_back(chunk);
+    lock.unlock();
+
+    free_block *head = nullptr;
+    for(auto offset = block_count; offset > 0; offset--) {
+        head = ::new(chunk + (offset - 1) * block_size) free_block { head, nullptr };
+    }
+    count = block_count;
+    return head;
+}
+
+// Blocks that cannot be handed over, for lack of a lock, are leaked.
+JURO_DECL void size_class_pool::orphan(std::size_t index, free_block *head) noexcept {
+    try {
+        auto &shared = detail::orphans();
+        std::lock_guard lock { shared.mutex };
+        head->next_batch = static_cast<free_block *>(shared.batches[index]);
+        shared.batches[index] = head;
+    } catch(...) {  }
+}
+
+JURO_DECL void size_class_pool::spill(local_pool &pool, std::size_t index) noexcept {
+    const auto count = batch_size(index);
+    auto *head = pool.heads[index];
+    auto *tail = head;
+    for(std::size_t taken = 1; taken < count; taken++) {
+        tail = tail->next;
+    }
+
+    pool.heads[index] = tail->next;
+    pool.counts[index] -= count;
+    tail->next = nullptr;
+    orphan(index, head);
+}
+
+JURO_DECL void *size_class_pool::allocate_orphaned(std::size_t index) {
+    std::size_t count = 0;
+    auto *block = refill(index, count);
+    if(block->next != nullptr) {
+        orphan(index, block->next);
+    }
+    return block;
+}
+
+JURO_DECL std::size_t size_class_pool::chunk_count() {
+    auto &shared = detail::orphans();
+    std::lock_guard lock { shared.mutex };
+    return shared.chunks.size();
+}
+
+} /* namespace juro::allocation */
+
+#endif /* JURO_IMPL_ALLOCATION_IPP */
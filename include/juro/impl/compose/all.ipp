@@ -0,0 +1,36 @@
+#ifndef JURO_IMPL_COMPOSE_ALL_IPP
+#define JURO_IMPL_COMPOSE_ALL_IPP
+
+#include "juro/promise.hpp"
+#include "juro/compose/all.hpp"
+
+namespace juro::compose {
+
+JURO_DECL void_all_coordinator::void_all_coordinator(const promise_ptr<void> &promise, std::size_t count) :
+    counter { count },
+    promise { promise }
+{  }
+
+JURO_DECL void void_all_coordinator::attach(juro::promise<void> &child) {
+    settle_access::attach(child, [this, &child, guard = intrusive_ptr { this }] {
+        if(child.is_resolved()) {
+            on_resolve();
+        } else {
+            on_reject(child.get_error());
+        }
+    });
+}
+
+JURO_DECL void void_all_coordinator::on_resolve() {
+    if(--counter == 0) {
+        resolve_if_pending(promise, void_type {  });
+    }
+}
+
+JURO_DECL void void_all_coordinator::on_reject(std::exception_ptr &error) {
+    reject_if_pending(promise, error);
+}
+
+} /* namespace juro::compose */
+
+#endif /* JURO_IMPL_COMPOSE_ALL_IPP */
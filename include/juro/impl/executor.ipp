@@ -0,0 +1,284 @@
+/**
+ * @file juro/impl/executor.ipp
+ * @brief Contains the definitions of the built-in executors.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_IMPL_EXECUTOR_IPP
+#define JURO_IMPL_EXECUTOR_IPP
+
+#include <cstdint>
+#include "juro/executor.hpp"
+
+namespace juro::executors {
+
+JURO_DECL bool queue_executor::run_one() {
+    if(tasks.empty()) {
+        return false;
+    }
+
+    auto work = std::move(tasks.front());
+    tasks.pop_front();
+    work();
+    return true;
+}
+
+JURO_DECL std::size_t queue_executor::run_pending() {
+    std::size_t count = 0;
+    for(auto pending = tasks.size(); pending > 0; pending--) {
+        run_one();
+        count++;
+    }
+    return count;
+}
+
+JURO_DECL std::size_t queue_executor::run() {
+    std::size_t count = 0;
+    while(run_one()) {
+        count++;
+    }
+    return count;
+}
+
+namespace detail {
+
+/**
+ * @brief A Chase-Lev work-stealing deque of task pointers. Only the owning
+ * worker may `push()` and `pop()`, at the bottom end; any thread may
+ * `steal()` from the top end.
+ */
+class work_stealing_deque {
+    /**
+     * @brief A circular buffer of task slots. Buffers replaced on growth are
+     * retired, not freed, because thieves may still be reading them.
+     */
+    struct ring {
+        std::int64_t mask;
+        std::unique_ptr<std::atomic<task *>[]> slots;
+
+        explicit ring(std::int64_t capacity) :
+            mask { capacity - 1 },
+            slots { new std::atomic<task *>[static_cast<std::size_t>(capacity)] }
+            {  }
+
+        inline std::int64_t capacity() const noexcept { return mask + 1; }
+
+        inline task *get(std::int64_t index) const noexcept {
+            return slots[index & mask].load(std::memory_order_relaxed);
+        }
+
+        inline void put(std::int64_t index, task *work) noexcept {
+            slots[index & mask].store(work, std::memory_order_relaxed);
+        }
+    };
+
+    std::atomic<std::int64_t> top { 0 };
+    std::atomic<std::int64_t> bottom { 0 };
+    std::atomic<ring *> buffer;
+    std::vector<std::unique_ptr<ring>> rings;
+
+public:
+    work_stealing_deque() {
+        rings.emplace_back(new ring { 256 });
+        buffer.store(rings.back().get(), std::memory_order_relaxed);
+    }
+
+    void push(task *work) {
+        const auto b = bottom.load(std::memory_order_relaxed);
+        const auto t = top.load(std::memory_order_acquire);
+        auto *current = buffer.load(std::memory_order_relaxed);
+
+        if(b - t > current->capacity() - 1) {
+            auto *grown = new ring { current->capacity() * 2 };
+            for(auto index = t; index < b; index++) {
+                grown->put(index, current->get(index));
+            }
+            rings.emplace_back(grown);
+            buffer.store(grown, std::memory_order_release);
+            current = grown;
+        }
+
+        current->put(b, work);
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    task *pop() noexcept {
+        const auto b = bottom.load(std::memory_order_relaxed) - 1;
+        auto *current = buffer.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top.load(std::memory_order_relaxed);
+
+        if(t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto *work = current->get(b);
+        if(t == b) {
+            if(!top.compare_exchange_strong(
+                t, t + 1, 
+                std::memory_order_seq_cst, 
+                std::memory_order_relaxed
+            )) {
+                work = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return work;
+    }
+
+    task *steal() noexcept {
+        auto t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = bottom.load(std::memory_order_acquire);
+
+        if(t >= b) {
+            return nullptr;
+        }
+
+        auto *work = buffer.load(std::memory_order_acquire)->get(t);
+        if(!top.compare_exchange_strong(
+            t, t + 1, 
+            std::memory_order_seq_cst, 
+            std::memory_order_relaxed
+        )) {
+            return nullptr;
+        }
+        return work;
+    }
+};
+
+/**
+ * @brief The pool and worker index of the calling thread, if it is a worker.
+ */
+struct worker_identity {
+    const void *pool = nullptr;
+    std::size_t index = 0;
+};
+
+JURO_DECL thread_local worker_identity current_worker;
+
+} /* namespace detail */
+
+struct thread_pool::worker {
+    detail::work_stealing_deque tasks;
+    std::uint32_t seed = 0;
+};
+
+JURO_DECL thread_pool::thread_pool(std::size_t thread_count) :
+    workers { new worker[thread_count == 0 ? 1 : thread_count] },
+    worker_count { thread_count == 0 ? 1 : thread_count }
+{
+    threads.reserve(worker_count);
+    for(std::size_t index = 0; index < worker_count; index++) {
+        workers[index].seed = static_cast<std::uint32_t>(index * 2654435761u + 1);
+        threads.emplace_back([this, index] { work(index); });
+    }
+}
+
+JURO_DECL thread_pool::~thread_pool() {
+    {
+        std::lock_guard lock { sleep_mutex };
+        stopping = true;
+    }
+    available.notify_all();
+
+    for(auto &thread : threads) {
+        thread.join();
+    }
+}
+
+JURO_DECL void thread_pool::schedule(task &&work) {
+    auto *node = new task { std::move(work) };
+    queued.fetch_add(1, std::memory_order_seq_cst);
+
+    if(is_worker_thread()) {
+        workers[detail::current_worker.index].tasks.push(node);
+    } else {
+        std::lock_guard lock { injection_mutex };
+        injected.push_back(node);
+        injected_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if(idle.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard lock { sleep_mutex };
+        available.notify_one();
+    }
+}
+
+JURO_DECL bool thread_pool::is_worker_thread() const noexcept {
+    return detail::current_worker.pool == this;
+}
+
+JURO_DECL std::size_t thread_pool::default_thread_count() noexcept {
+    const auto count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+JURO_DECL task *thread_pool::find_task(std::size_t index) noexcept {
+    auto &self = workers[index];
+    if(auto *work = self.tasks.pop()) {
+        return work;
+    }
+
+    if(injected_count.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard lock { injection_mutex };
+        if(!injected.empty()) {
+            auto *work = injected.front();
+            injected.pop_front();
+            injected_count.fetch_sub(1, std::memory_order_relaxed);
+            return work;
+        }
+    }
+
+    self.seed ^= self.seed << 13;
+    self.seed ^= self.seed >> 17;
+    self.seed ^= self.seed << 5;
+    const auto start = self.seed % worker_count;
+    for(std::size_t offset = 0; offset < worker_count; offset++) {
+        const auto victim = (start + offset) % worker_count;
+        if(victim == index) {
+            continue;
+        }
+        if(auto *work = workers[victim].tasks.steal()) {
+            return work;
+        }
+    }
+    return nullptr;
+}
+
+JURO_DECL void thread_pool::work(std::size_t index) {
+    detail::current_worker = { this, index };
+
+    while(true) {
+        if(auto *found = find_task(index)) {
+            const auto work = std::unique_ptr<task> { found };
+            queued.fetch_sub(1, std::memory_order_seq_cst);
+            try {
+                (*work)();
+            } catch(...) {  }
+            continue;
+        }
+
+        if(queued.load(std::memory_order_seq_cst) > 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock lock { sleep_mutex };
+        if(stopping) {
+            return;
+        }
+
+        idle.fetch_add(1, std::memory_order_seq_cst);
+        available.wait(lock, [this] { 
+            return stopping || queued.load(std::memory_order_seq_cst) > 0; 
+        });
+        idle.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+} /* namespace juro::executors */
+
+#endif /* JURO_IMPL_EXECUTOR_IPP */
@@ -0,0 +1,244 @@
+/**
+ * @file juro/impl/instrumentation.ipp
+ * @brief Contains the definitions of the observer registry and the bundled
+ * trace collector.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_IMPL_INSTRUMENTATION_IPP
+#define JURO_IMPL_INSTRUMENTATION_IPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+#include "juro/instrumentation.hpp"
+
+namespace juro::instrumentation {
+
+namespace detail {
+
+JURO_DECL std::atomic<observer *> &installed_observer() noexcept {
+    static std::atomic<observer *> installed { nullptr };
+    return installed;
+}
+
+JURO_DECL promise_id next_id() noexcept {
+    static std::atomic<promise_id> last { 0 };
+    return last.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+/**
+ * @brief Writes a duration in microseconds with nanosecond precision, as
+ * Chrome trace timestamps are expressed.
+ */
+JURO_DECL void write_microseconds(std::ostream &output, std::chrono::nanoseconds duration) {
+    const auto count = duration.count();
+    output << count / 1000 << '.'
+        << std::setw(3) << std::setfill('0') << count % 1000
+        << std::setfill(' ');
+}
+
+} /* namespace detail */
+
+JURO_DECL observer *set_observer(observer *watcher) noexcept {
+    return detail::installed_observer().exchange(watcher, std::memory_order_acq_rel);
+}
+
+JURO_DECL observer *get_observer() noexcept {
+    return detail::installed_observer().load(std::memory_order_acquire);
+}
+
+JURO_DECL void histogram::record(std::chrono::nanoseconds duration) noexcept {
+    const auto count = static_cast<std::uint64_t>(
+        std::max(duration.count(), std::chrono::nanoseconds::rep { 0 })
+    );
+
+    std::size_t index = 0;
+    while(index + 1 < bucket_count && (std::uint64_t { 1 } << index) < count) {
+        index++;
+    }
+
+    buckets[index]++;
+    samples++;
+    total += duration;
+    longest = std::max(longest, duration);
+}
+
+JURO_DECL std::chrono::nanoseconds histogram::percentile(double fraction) const noexcept {
+    if(samples == 0) {
+        return std::chrono::nanoseconds { 0 };
+    }
+
+    const auto clamped = std::clamp(fraction, 0.0, 1.0);
+    const auto target = std::max<std::uint64_t>(
+        1,
+        static_cast<std::uint64_t>(std::ceil(clamped * static_cast<double>(samples)))
+    );
+
+    std::uint64_t seen = 0;
+    for(std::size_t index = 0; index < bucket_count; index++) {
+        seen += buckets[index];
+        if(seen >= target) {
+            const std::chrono::nanoseconds bound {
+                static_cast<std::chrono::nanoseconds::rep>(std::uint64_t { 1 } << index)
+            };
+            return std::min(bound, longest);
+        }
+    }
+    return longest;
+}
+
+JURO_DECL trace_collector::trace_collector(bool keep_spans) :
+    origin { clock::now() },
+    keep_spans { keep_spans }
+{  }
+
+// Hooks must not throw: whatever cannot be recorded, e.g. for lack of memory,
+// is dropped.
+
+JURO_DECL void trace_collector::created(promise_id id) noexcept {
+    const auto now = clock::now();
+    try {
+        std::lock_guard lock { mutex };
+        tracked.insert_or_assign(id, tracked_promise { 0, now, now });
+    } catch(...) {  }
+}
+
+JURO_DECL void trace_collector::chained(promise_id id, promise_id parent) noexcept {
+    try {
+        std::lock_guard lock { mutex };
+        if(const auto found = tracked.find(id); found != tracked.end()) {
+            found->second.parent = parent;
+        }
+    } catch(...) {  }
+}
+
+JURO_DECL void trace_collector::settled(promise_id id, promise_state state) noexcept {
+    const auto now = clock::now();
+    try {
+        std::lock_guard lock { mutex };
+        const auto found = tracked.find(id);
+        if(found == tracked.end()) {
+            return;
+        }
+
+        const auto &promise = found->second;
+        settle_latency.record(now - promise.created);
+        record_span(span { id, promise.parent, false, state, thread_index(), promise.created, now });
+    } catch(...) {  }
+}
+
+JURO_DECL void trace_collector::unhandled(promise_id, const std::exception_ptr &) noexcept {
+    try {
+        std::lock_guard lock { mutex };
+        unhandled_count++;
+    } catch(...) {  }
+}
+
+JURO_DECL void trace_collector::handler_began(promise_id id) noexcept {
+    const auto now = clock::now();
+    try {
+        std::lock_guard lock { mutex };
+        if(const auto found = tracked.find(id); found != tracked.end()) {
+            found->second.handler_began = now;
+        }
+    } catch(...) {  }
+}
+
+JURO_DECL void trace_collector::handler_ended(promise_id id) noexcept {
+    const auto now = clock::now();
+    try {
+        std::lock_guard lock { mutex };
+        const auto found = tracked.find(id);
+        if(found == tracked.end()) {
+            return;
+        }
+
+        const auto &promise = found->second;
+        handler_duration.record(now - promise.handler_began);
+        record_span(span {
+            id,
+            promise.parent,
+            true,
+            promise_state::PENDING,
+            thread_index(),
+            promise.handler_began,
+            now
+        });
+    } catch(...) {  }
+}
+
+JURO_DECL void trace_collector::destroyed(promise_id id) noexcept {
+    try {
+        std::lock_guard lock { mutex };
+        tracked.erase(id);
+    } catch(...) {  }
+}
+
+JURO_DECL histogram trace_collector::get_settle_latency() const {
+    std::lock_guard lock { mutex };
+    return settle_latency;
+}
+
+JURO_DECL histogram trace_collector::get_handler_duration() const {
+    std::lock_guard lock { mutex };
+    return handler_duration;
+}
+
+JURO_DECL std::size_t trace_collector::unhandled_rejections() const {
+    std::lock_guard lock { mutex };
+    return unhandled_count;
+}
+
+JURO_DECL void trace_collector::write_chrome_trace(std::ostream &output) const {
+    std::lock_guard lock { mutex };
+
+    output << "{\"traceEvents\":[";
+    bool first = true;
+    for(const auto &finished : spans) {
+        output << (first ? "\n" : ",\n");
+        first = false;
+
+        output << "{\"name\":\"" << (finished.handler ? "handler" : "pending")
+            << "\",\"cat\":\"juro\",\"ph\":\"X\",\"ts\":";
+        detail::write_microseconds(output, finished.begin - origin);
+        output << ",\"dur\":";
+        detail::write_microseconds(output, finished.end - finished.begin);
+        output << ",\"pid\":1,\"tid\":" << finished.thread
+            << ",\"args\":{\"id\":" << finished.id
+            << ",\"parent\":" << finished.parent;
+        if(!finished.handler) {
+            output << ",\"state\":\""
+                << (finished.state == promise_state::RESOLVED ? "resolved" : "rejected")
+                << '"';
+        }
+        output << "}}";
+    }
+    output << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+JURO_DECL void trace_collector::clear() {
+    std::lock_guard lock { mutex };
+    spans.clear();
+    settle_latency = histogram {  };
+    handler_duration = histogram {  };
+    unhandled_count = 0;
+}
+
+JURO_DECL std::uint32_t trace_collector::thread_index() {
+    const auto next = static_cast<std::uint32_t>(threads.size());
+    return threads.try_emplace(std::this_thread::get_id(), next).first->second;
+}
+
+JURO_DECL void trace_collector::record_span(span &&finished) {
+    if(keep_spans) {
+        spans.push_back(std::move(finished));
+    }
+}
+
+} /* namespace juro::instrumentation */
+
+#endif /* JURO_IMPL_INSTRUMENTATION_IPP */
@@ -0,0 +1,348 @@
+/**
+ * @file juro/impl/promise.ipp
+ * @brief Contains the definitions of the non-template parts of
+ * `juro::promise_interface`.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_IMPL_PROMISE_IPP
+#define JURO_IMPL_PROMISE_IPP
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include "juro/promise.hpp"
+
+namespace juro {
+
+namespace detail {
+
+#ifdef JURO_INTRUSIVE_PTR
+using owning_ptr = intrusive_ptr<promise_interface>;
+#else
+using owning_ptr = std::shared_ptr<promise_interface>;
+#endif /* JURO_INTRUSIVE_PTR */
+
+/**
+ * @brief Per-thread bookkeeping of running settle handlers.
+ */
+struct settle_context {
+    std::size_t depth = 0;
+    std::size_t batches = 0;
+    std::deque<owning_ptr> deferred;
+};
+
+JURO_DECL thread_local settle_context context;
+
+#ifdef JURO_INSTRUMENTATION
+/**
+ * @brief Reports a settle handler as running for as long as it lives. Only
+ * the identifier is kept, since the handler may release the promise.
+ */
+struct handler_scope {
+    promise_id id;
+
+    explicit handler_scope(promise_id id) noexcept : id { id } {
+        if(auto *watcher = get_observer()) {
+            watcher->handler_began(id);
+        }
+    }
+
+    ~handler_scope() noexcept {
+        if(auto *watcher = get_observer()) {
+            watcher->handler_ended(id);
+        }
+    }
+};
+#endif /* JURO_INSTRUMENTATION */
+
+} /* namespace detail */
+
+#ifdef JURO_COUNT_PROMISES
+JURO_DECL std::atomic<std::size_t> promise_interface::live_count { 0 };
+#endif /* JURO_COUNT_PROMISES */
+
+JURO_DECL promise_interface::promise_interface(promise_state state) noexcept :
+    state { static_cast<std::uint8_t>(state) }
+{
+    count_created();
+    if(state != promise_state::PENDING) {
+        notify(&observer::settled, state);
+    }
+}
+
+JURO_DECL promise_interface::promise_interface(concurrent_promise_tag) noexcept :
+    state { 
+        static_cast<std::uint8_t>(
+            static_cast<std::uint8_t>(promise_state::PENDING) | CONCURRENT
+        ) 
+    }
+{
+    count_created();
+}
+
+JURO_DECL promise_interface::~promise_interface() noexcept {
+    unlink_upstream();
+    unlink_downstream();
+    notify(&observer::destroyed);
+#ifdef JURO_COUNT_PROMISES
+    live_count.fetch_sub(1, std::memory_order_relaxed);
+#endif /* JURO_COUNT_PROMISES */
+}
+
+JURO_DECL void promise_interface::set_settle_handler(settle_handler &&handler) {
+    if(is_concurrent()) {
+        attach_concurrent_handler(std::move(handler));
+        return;
+    }
+
+    unlink_downstream();
+    on_settle = std::move(handler);
+    if(is_settled()) {
+        run_settle_handler();
+    }
+}
+
+JURO_DECL void promise_interface::set_cancel_handler(cancel_handler &&handler) noexcept {
+    if(!is_concurrent() && is_pending()) {
+        cancel_callback = std::move(handler);
+    }
+}
+
+JURO_DECL void promise_interface::link_downstream(promise_interface &next) noexcept {
+    if(is_concurrent() || next.is_concurrent() || !is_pending()) {
+        return;
+    }
+
+    unlink_downstream();
+    next.unlink_upstream();
+    downstream = &next;
+    next.upstream = this;
+}
+
+JURO_DECL void promise_interface::unlink_upstream() noexcept {
+    if(upstream != nullptr) {
+        upstream->downstream = nullptr;
+        upstream = nullptr;
+    }
+}
+
+JURO_DECL void promise_interface::unlink_downstream() noexcept {
+    if(downstream != nullptr) {
+        downstream->upstream = nullptr;
+        downstream = nullptr;
+    }
+}
+
+JURO_DECL void promise_interface::cancel() {
+    if(is_concurrent()) {
+        return;
+    }
+
+    promise_interface *origin = nullptr;
+    for(auto *current = this; current != nullptr; current = current->upstream) {
+        if(!current->is_pending()) {
+            break;
+        }
+        if(current->cancel_callback) {
+            origin = current;
+        }
+    }
+
+    if(origin != nullptr) {
+        auto handler = origin->take_cancel_handler();
+        handler(*origin);
+    }
+}
+
+JURO_DECL void promise_interface::resolved() {
+    const bool attached = publish_state(promise_state::RESOLVED);
+    notify(&observer::settled, promise_state::RESOLVED);
+    if(attached) {
+        dispatch_settle();
+    }
+}
+
+JURO_DECL void promise_interface::rejected(const std::exception_ptr &error) {
+    const bool attached = publish_state(promise_state::REJECTED);
+    notify(&observer::settled, promise_state::REJECTED);
+    if(attached) {
+        dispatch_settle();
+    } else if(!is_concurrent()) {
+        notify(&observer::unhandled, error);
+        throw promise_error { "Unhandled promise rejection" };
+    }
+}
+
+JURO_DECL void promise_interface::attach_concurrent_handler(settle_handler &&handler) {
+    auto current = state.load(std::memory_order_relaxed);
+    do {
+        if(current & (ATTACHING | ATTACHED)) {
+            throw promise_error { 
+                "Attempted to attach a second handler to a concurrent promise" 
+            };
+        }
+    } while(!state.compare_exchange_weak(
+        current, 
+        current | ATTACHING,
+        std::memory_order_acquire,
+        std::memory_order_relaxed
+    ));
+
+    on_settle = std::move(handler);
+
+    const auto previous = state.fetch_or(ATTACHED, std::memory_order_acq_rel);
+    if(previous & STATE_MASK) {
+        run_settle_handler();
+    }
+}
+
+JURO_DECL void promise_interface::dispatch_settle() {
+    auto &local = juro::detail::context;
+    if(local.batches > 0 || local.depth >= JURO_SETTLE_DEPTH) {
+#ifdef JURO_INTRUSIVE_PTR
+        local.deferred.emplace_back(this);
+#else
+        local.deferred.push_back(shared_from_this());
+#endif /* JURO_INTRUSIVE_PTR */
+        return;
+    }
+
+    std::exception_ptr failure;
+    const bool outermost = local.depth++ == 0;
+    try {
+        run_settle_handler();
+    } catch(...) {
+        failure = std::current_exception();
+    }
+
+    if(outermost) {
+        drain_deferred(failure);
+    }
+    local.depth--;
+
+    if(failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+JURO_DECL void promise_interface::drain_deferred(std::exception_ptr &failure) {
+    // Every deferred handler runs even if another one throws; the first
+    // exception is kept for the caller to rethrow once the queue is drained.
+    auto &local = juro::detail::context;
+    while(!local.deferred.empty()) {
+        const auto next = std::move(local.deferred.front());
+        local.deferred.pop_front();
+        try {
+            next->run_settle_handler();
+        } catch(...) {
+            if(!failure) {
+                failure = std::current_exception();
+            }
+        }
+    }
+}
+
+JURO_DECL void promise_interface::run_settle_handler() {
+    // The handler is destroyed as soon as it returns, so whatever it captured
+    // -- most often the chained promise -- is not kept alive by a promise that
+    // has nothing left to deliver.
+    auto handler = std::move(on_settle);
+#ifdef JURO_INSTRUMENTATION
+    const juro::detail::handler_scope scope { trace_id };
+#endif /* JURO_INSTRUMENTATION */
+    handler();
+}
+
+JURO_DECL bool promise_interface::publish_state(promise_state settled_state) noexcept {
+    const auto bits = static_cast<std::uint8_t>(settled_state);
+
+    if(!is_concurrent()) {
+        const auto kept = state.load(std::memory_order_relaxed) & UNOBSERVED;
+        state.store(static_cast<std::uint8_t>(kept | bits), std::memory_order_relaxed);
+        cancel_callback = nullptr;
+        return static_cast<bool>(on_settle);
+    }
+
+    auto current = state.load(std::memory_order_relaxed);
+    while(!state.compare_exchange_weak(
+        current,
+        static_cast<std::uint8_t>((current & ~SETTLING) | bits),
+        std::memory_order_acq_rel,
+        std::memory_order_relaxed
+    ));
+    return current & ATTACHED;
+}
+
+JURO_DECL settle_batch::settle_batch(executor *dispatcher) noexcept :
+    dispatcher { dispatcher },
+    first { juro::detail::context.deferred.size() }
+{
+    juro::detail::context.batches++;
+}
+
+JURO_DECL settle_batch::~settle_batch() noexcept {
+    try {
+        close();
+    } catch(...) {  }
+}
+
+JURO_DECL void settle_batch::close() {
+    if(!open) {
+        return;
+    }
+    open = false;
+
+    auto &local = juro::detail::context;
+    if(--local.batches > 0) {
+        return;
+    }
+
+    // Inside a running handler, the batch joins the enclosing pass even if
+    // it has a dispatcher.
+    if(dispatcher != nullptr && local.depth == 0) {
+        // Only the handlers deferred by this batch are handed over; whatever
+        // was queued before belongs to the settlement running below.
+        const auto begin = local.deferred.begin() + static_cast<std::ptrdiff_t>(first);
+        std::deque<juro::detail::owning_ptr> batched {
+            std::make_move_iterator(begin),
+            std::make_move_iterator(local.deferred.end())
+        };
+        local.deferred.erase(begin, local.deferred.end());
+        if(batched.empty()) {
+            return;
+        }
+
+        dispatcher->schedule([batched = std::move(batched)] () mutable {
+            auto &worker = juro::detail::context;
+            for(auto &deferred : batched) {
+                worker.deferred.push_back(std::move(deferred));
+            }
+            run_deferred();
+        });
+        return;
+    }
+
+    run_deferred();
+}
+
+JURO_DECL void settle_batch::run_deferred() {
+    // Inside a running handler, the outermost settlement drains the queue.
+    auto &local = juro::detail::context;
+    if(local.depth > 0) {
+        return;
+    }
+
+    std::exception_ptr failure;
+    local.depth++;
+    promise_interface::drain_deferred(failure);
+    local.depth--;
+    if(failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+} /* namespace juro */
+
+#endif /* JURO_IMPL_PROMISE_IPP */
@@ -0,0 +1,140 @@
+/**
+ * @file juro/impl/timer.ipp
+ * @brief Contains the definitions of the timer wheel.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_IMPL_TIMER_IPP
+#define JURO_IMPL_TIMER_IPP
+
+#include <algorithm>
+#include "juro/timer.hpp"
+
+namespace juro::timers {
+
+JURO_DECL void timer_node::disarm() noexcept {
+    if(previous == nullptr) {
+        return;
+    }
+
+    *previous = next;
+    if(next != nullptr) {
+        next->previous = previous;
+    }
+    next = nullptr;
+    previous = nullptr;
+    wheel->armed--;
+}
+
+JURO_DECL timer_wheel::timer_wheel(clock::duration resolution, executor *dispatcher) noexcept :
+    origin { clock::now() },
+    resolution { resolution },
+    dispatcher { dispatcher }
+{  }
+
+JURO_DECL timer_wheel::~timer_wheel() {
+    for(auto &level : slots) {
+        for(auto &head : level) {
+            while(head != nullptr) {
+                auto &node = *head;
+                node.disarm();
+                node.discarded();
+            }
+        }
+    }
+}
+
+JURO_DECL void timer_wheel::arm(timer_node &node, clock::time_point deadline) noexcept {
+    node.disarm();
+
+    const auto elapsed = deadline - origin;
+    const auto ticks = elapsed.count() <= 0 ? 
+        std::uint64_t { 0 } : 
+        static_cast<std::uint64_t>((elapsed + resolution - clock::duration { 1 }) / resolution);
+
+    node.expiry = std::max(ticks, current + 1);
+    node.wheel = this;
+    insert(node);
+    armed++;
+}
+
+JURO_DECL std::size_t timer_wheel::advance(clock::time_point now) {
+    if(now <= origin) {
+        return 0;
+    }
+
+    const auto target = static_cast<std::uint64_t>((now - origin) / resolution);
+    std::size_t fired = 0;
+    while(current < target) {
+        if(armed == 0) {
+            current = target;
+            break;
+        }
+
+        current++;
+        for(std::size_t level = 1; level < level_count; level++) {
+            const auto mask = (std::uint64_t { 1 } << (level_bits * level)) - 1;
+            if((current & mask) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        auto &due = slots[0][current & (slot_count - 1)];
+        while(due != nullptr) {
+            auto &node = *due;
+            node.disarm();
+            node.expired();
+            fired++;
+        }
+    }
+    return fired;
+}
+
+JURO_DECL void timer_wheel::insert(timer_node &node) noexcept {
+    constexpr auto span = std::uint64_t { 1 } << (level_bits * level_count);
+    const auto delta = node.expiry > current ? node.expiry - current : 0;
+
+    std::size_t level = 0;
+    while(
+        level + 1 < level_count && 
+        delta >= (std::uint64_t { 1 } << (level_bits * (level + 1)))
+    ) {
+        level++;
+    }
+
+    // Timers beyond the outermost wheel wait in its farthest slot and are
+    // placed again once it cascades.
+    const auto expiry = delta < span ? node.expiry : current + span - 1;
+    auto &head = slots[level][(expiry >> (level_bits * level)) & (slot_count - 1)];
+
+    node.next = head;
+    node.previous = &head;
+    if(head != nullptr) {
+        head->previous = &node.next;
+    }
+    head = &node;
+}
+
+JURO_DECL void timer_wheel::cascade(std::size_t level) noexcept {
+    auto &slot = slots[level][(current >> (level_bits * level)) & (slot_count - 1)];
+    auto *node = std::exchange(slot, nullptr);
+    while(node != nullptr) {
+        auto *following = node->next;
+        node->next = nullptr;
+        node->previous = nullptr;
+        insert(*node);
+        node = following;
+    }
+}
+
+JURO_DECL void delay_promise::expired() noexcept {
+    const auto guard = release_self();
+    try {
+        resolve();
+    } catch(...) {  }
+}
+
+} /* namespace juro::timers */
+
+#endif /* JURO_IMPL_TIMER_IPP */
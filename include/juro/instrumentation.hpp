@@ -0,0 +1,247 @@
+/**
+ * @file juro/instrumentation.hpp
+ * @brief Contains the observer interface through which promises report their
+ * lifecycle, and a bundled collector producing latency histograms and Chrome
+ * traces.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_INSTRUMENTATION_HPP
+#define JURO_INSTRUMENTATION_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iosfwd>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "juro/config.hpp"
+#include "juro/helpers.hpp"
+
+namespace juro::instrumentation {
+
+using namespace juro::helpers;
+
+/**
+ * @brief Identifies a promise in the reports of an observer. Identifiers are
+ * never reused within a process; `0` stands for no promise.
+ */
+using promise_id = std::uint64_t;
+
+/**
+ * @brief Receives the lifecycle events of every promise. Hooks may be called
+ * concurrently from any thread settling or destroying promises, so observers
+ * must synchronise themselves; they must not throw nor settle promises.
+ */
+class observer {
+public:
+    virtual ~observer() = default;
+
+    /**
+     * @brief A promise was constructed, either pending or already settled.
+     */
+    virtual void created(promise_id) noexcept {  }
+
+    /**
+     * @brief A promise, whose identifier comes first, was chained by `then()` 
+     * or `pipe()` to the promise whose outcome will settle it.
+     */
+    virtual void chained(promise_id, promise_id) noexcept {  }
+
+    /**
+     * @brief A promise was resolved or rejected.
+     */
+    virtual void settled(promise_id, promise_state) noexcept {  }
+
+    /**
+     * @brief A promise was rejected with no settle handler attached, right
+     * before `reject()` throws.
+     */
+    virtual void unhandled(promise_id, const std::exception_ptr &) noexcept {  }
+
+    /**
+     * @brief The settle handler of a promise started or finished running.
+     */
+    virtual void handler_began(promise_id) noexcept {  }
+    virtual void handler_ended(promise_id) noexcept {  }
+
+    /**
+     * @brief A promise was destroyed.
+     */
+    virtual void destroyed(promise_id) noexcept {  }
+};
+
+/**
+ * @brief Installs the observer promises report to, replacing the previous
+ * one. Requires `JURO_INSTRUMENTATION` for anything to be reported.
+ * @param watcher The observer, which must outlive its installation, or
+ * `nullptr` to stop reporting.
+ * @return The previously installed observer.
+ */
+observer *set_observer(observer *watcher) noexcept;
+
+/**
+ * @brief Returns the installed observer, if any.
+ */
+observer *get_observer() noexcept;
+
+namespace detail {
+
+/**
+ * @brief Returns a new promise identifier.
+ */
+promise_id next_id() noexcept;
+
+} /* namespace detail */
+
+/**
+ * @brief A histogram of durations with power-of-two buckets: bucket `i`
+ * counts the durations of at most `2^i` nanoseconds not counted by the
+ * previous one.
+ */
+class histogram {
+public:
+    static constexpr std::size_t bucket_count = 64;
+
+private:
+    std::array<std::uint64_t, bucket_count> buckets {  };
+    std::uint64_t samples = 0;
+    std::chrono::nanoseconds total { 0 };
+    std::chrono::nanoseconds longest { 0 };
+
+public:
+    void record(std::chrono::nanoseconds duration) noexcept;
+
+    /**
+     * @brief Returns an upper bound of the duration under which the supplied
+     * fraction of the samples falls, e.g. `0.99` for the 99th percentile.
+     * @param fraction The fraction of samples, within `[0, 1]`
+     * @return The upper bound of the bucket holding that sample, or zero if
+     * the histogram is empty.
+     */
+    std::chrono::nanoseconds percentile(double fraction) const noexcept;
+
+    inline std::uint64_t size() const noexcept { return samples; }
+    inline bool empty() const noexcept { return samples == 0; }
+    inline std::chrono::nanoseconds max() const noexcept { return longest; }
+    inline std::uint64_t bucket(std::size_t index) const noexcept { return buckets[index]; }
+
+    inline std::chrono::nanoseconds mean() const noexcept {
+        return samples == 0 ?
+            std::chrono::nanoseconds { 0 } :
+            total / static_cast<std::int64_t>(samples);
+    }
+};
+
+/**
+ * @brief An observer recording how long promises stay pending and how long
+ * their settle handlers run, as histograms and as spans that can be exported
+ * in the Chrome trace event format, for `chrome://tracing` or Perfetto.
+ * @details Only promises created while the collector is installed are
+ * tracked. Spans accumulate until `clear()` is called unless the collector
+ * was told not to keep them.
+ */
+class trace_collector final : public observer {
+public:
+    using clock = std::chrono::steady_clock;
+
+private:
+    /**
+     * @brief The bookkeeping of a promise alive and tracked.
+     */
+    struct tracked_promise {
+        promise_id parent = 0;
+        clock::time_point created;
+        clock::time_point handler_began;
+    };
+
+    /**
+     * @brief A finished span: a promise staying pending or a handler running.
+     */
+    struct span {
+        promise_id id;
+        promise_id parent;
+        bool handler;
+        promise_state state;
+        std::uint32_t thread;
+        clock::time_point begin;
+        clock::time_point end;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<promise_id, tracked_promise> tracked;
+    std::unordered_map<std::thread::id, std::uint32_t> threads;
+    std::vector<span> spans;
+    histogram settle_latency;
+    histogram handler_duration;
+    std::size_t unhandled_count = 0;
+    clock::time_point origin;
+    bool keep_spans;
+
+public:
+    /**
+     * @brief Creates an empty collector; it must be installed with
+     * `juro::set_observer()` to receive anything.
+     * @param keep_spans Whether to keep the spans exported by
+     * `write_chrome_trace()`, or only the histograms.
+     */
+    explicit trace_collector(bool keep_spans = true);
+
+    void created(promise_id id) noexcept override;
+    void chained(promise_id id, promise_id parent) noexcept override;
+    void settled(promise_id id, promise_state state) noexcept override;
+    void unhandled(promise_id id, const std::exception_ptr &error) noexcept override;
+    void handler_began(promise_id id) noexcept override;
+    void handler_ended(promise_id id) noexcept override;
+    void destroyed(promise_id id) noexcept override;
+
+    /**
+     * @brief Returns the histogram of the time promises stayed pending.
+     */
+    histogram get_settle_latency() const;
+
+    /**
+     * @brief Returns the histogram of the time settle handlers ran.
+     */
+    histogram get_handler_duration() const;
+
+    /**
+     * @brief Returns the amount of rejections no handler was attached to.
+     */
+    std::size_t unhandled_rejections() const;
+
+    /**
+     * @brief Writes the recorded spans as a Chrome trace JSON document. Each
+     * pending period and each handler run is a complete event on the thread
+     * that ended it, carrying the promise and parent identifiers.
+     * @param output The stream to write to
+     */
+    void write_chrome_trace(std::ostream &output) const;
+
+    /**
+     * @brief Drops every recorded span and sample.
+     */
+    void clear();
+
+private:
+    std::uint32_t thread_index();
+    void record_span(span &&finished);
+};
+
+} /* namespace juro::instrumentation */
+
+namespace juro {
+
+using namespace juro::instrumentation;
+
+} /* namespace juro */
+
+#ifdef JURO_HEADER_ONLY
+#include "juro/impl/instrumentation.ipp"
+#endif /* JURO_HEADER_ONLY */
+
+#endif /* JURO_INSTRUMENTATION_HPP */
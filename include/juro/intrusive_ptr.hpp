@@ -0,0 +1,244 @@
+/**
+ * @file juro/intrusive_ptr.hpp
+ * @brief Contains an intrusive reference counted smart pointer and the
+ * reference counter objects it manages.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_INTRUSIVE_PTR_HPP
+#define JURO_INTRUSIVE_PTR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace juro::helpers {
+
+/**
+ * @brief Reference counters are atomic whenever promise handles are: always
+ * when `promise_ptr` is a `std::shared_ptr` and, when it is intrusive, only if
+ * `JURO_ATOMIC_REFCOUNT` is defined.
+ */
+#if !defined(JURO_INTRUSIVE_PTR) || defined(JURO_ATOMIC_REFCOUNT)
+#define JURO_ATOMIC_REFERENCES
+#endif
+
+/**
+ * @brief The type of the reference counter embedded in intrusively counted
+ * objects. It is an atomic integer, suitable for sharing handles across 
+ * threads, if `JURO_ATOMIC_REFERENCES` is defined and a plain one otherwise.
+ */
+#ifdef JURO_ATOMIC_REFERENCES
+using reference_count = std::atomic<std::size_t>;
+#else
+using reference_count = std::size_t;
+#endif /* JURO_ATOMIC_REFERENCES */
+
+/**
+ * @brief Holds an intrusive reference counter. Objects managed by a
+ * `juro::intrusive_ptr` derive from it and provide a `release()` member that
+ * destroys the object once `release_reference()` reports the last reference
+ * was dropped.
+ */
+class ref_counted {
+    /**
+     * @brief The amount of `juro::intrusive_ptr`s currently referencing this
+     * object.
+     */
+    mutable reference_count references { 0 };
+
+protected:
+    ref_counted() noexcept = default;
+    ref_counted(const ref_counted &) noexcept {  }
+    ~ref_counted() noexcept = default;
+
+    ref_counted &operator=(const ref_counted &) noexcept { return *this; }
+
+    /**
+     * @brief Drops a reference.
+     * @return Whether the last reference was dropped.
+     */
+    inline bool release_reference() const noexcept {
+#ifdef JURO_ATOMIC_REFERENCES
+        return references.fetch_sub(1, std::memory_order_acq_rel) == 1;
+#else
+        return --references == 0;
+#endif /* JURO_ATOMIC_REFERENCES */
+    }
+
+public:
+    /**
+     * @brief Acquires a new reference.
+     */
+    inline void retain() const noexcept {
+#ifdef JURO_ATOMIC_REFERENCES
+        references.fetch_add(1, std::memory_order_relaxed);
+#else
+        ++references;
+#endif /* JURO_ATOMIC_REFERENCES */
+    }
+
+    /**
+     * @brief Returns the amount of references currently held.
+     * @return The amount of references currently held.
+     */
+    inline std::size_t use_count() const noexcept {
+#ifdef JURO_ATOMIC_REFERENCES
+        return references.load(std::memory_order_relaxed);
+#else
+        return references;
+#endif /* JURO_ATOMIC_REFERENCES */
+    }
+};
+
+/**
+ * @brief A reference counted object that is deleted with `delete` when its
+ * last reference is dropped.
+ * @tparam T_derived The concrete type of the object
+ */
+template<class T_derived>
+class ref_counted_object : public ref_counted {
+public:
+    /**
+     * @brief Drops a reference, deleting the object if it was the last one.
+     */
+    inline void release() const noexcept {
+        if(release_reference()) {
+            delete static_cast<const T_derived *>(this);
+        }
+    }
+};
+
+/**
+ * @brief A smart pointer that manages an intrusively reference counted object.
+ * Copying it is a plain increment of the counter embedded in the object, so
+ * the object and its counter live in a single allocation.
+ * @tparam T The type of the managed object; must provide `retain()` and
+ * `release()` members.
+ */
+template<class T>
+class intrusive_ptr {
+    template<class> friend class intrusive_ptr;
+
+    T *pointer = nullptr;
+
+public:
+    using element_type = T;
+
+    constexpr intrusive_ptr() noexcept = default;
+    constexpr intrusive_ptr(std::nullptr_t) noexcept {  }
+
+    /**
+     * @brief Acquires a new reference to an object.
+     * @param pointer The object to reference; may be `nullptr`
+     */
+    explicit intrusive_ptr(T *pointer) noexcept : pointer { pointer } {
+        if(pointer != nullptr) {
+            pointer->retain();
+        }
+    }
+
+    intrusive_ptr(const intrusive_ptr &other) noexcept :
+        intrusive_ptr { other.pointer }
+        {  }
+
+    intrusive_ptr(intrusive_ptr &&other) noexcept :
+        pointer { std::exchange(other.pointer, nullptr) }
+        {  }
+
+    template<
+        class T_other,
+        class = std::enable_if_t<std::is_convertible_v<T_other *, T *>>
+    >
+    intrusive_ptr(const intrusive_ptr<T_other> &other) noexcept :
+        intrusive_ptr { static_cast<T *>(other.pointer) }
+        {  }
+
+    template<
+        class T_other,
+        class = std::enable_if_t<std::is_convertible_v<T_other *, T *>>
+    >
+    intrusive_ptr(intrusive_ptr<T_other> &&other) noexcept :
+        pointer { std::exchange(other.pointer, nullptr) }
+        {  }
+
+    ~intrusive_ptr() noexcept { reset(); }
+
+    intrusive_ptr &operator=(const intrusive_ptr &other) noexcept {
+        intrusive_ptr { other }.swap(*this);
+        return *this;
+    }
+
+    intrusive_ptr &operator=(intrusive_ptr &&other) noexcept {
+        intrusive_ptr { std::move(other) }.swap(*this);
+        return *this;
+    }
+
+    intrusive_ptr &operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    /**
+     * @brief Drops the currently held reference, if any.
+     */
+    inline void reset() noexcept {
+        if(pointer != nullptr) {
+            std::exchange(pointer, nullptr)->release();
+        }
+    }
+
+    inline void swap(intrusive_ptr &other) noexcept {
+        std::swap(pointer, other.pointer);
+    }
+
+    inline T *get() const noexcept { return pointer; }
+    inline T &operator*() const noexcept { return *pointer; }
+    inline T *operator->() const noexcept { return pointer; }
+    explicit inline operator bool() const noexcept { return pointer != nullptr; }
+
+    /**
+     * @brief Returns the amount of references held to the managed object.
+     * @return The amount of references or `0` if empty.
+     */
+    inline long use_count() const noexcept {
+        return pointer == nullptr ? 0 : static_cast<long>(pointer->use_count());
+    }
+
+    template<class T_other>
+    friend inline bool operator==(
+        const intrusive_ptr &lhs,
+        const intrusive_ptr<T_other> &rhs
+    ) noexcept {
+        return lhs.get() == rhs.get();
+    }
+
+    template<class T_other>
+    friend inline bool operator!=(
+        const intrusive_ptr &lhs,
+        const intrusive_ptr<T_other> &rhs
+    ) noexcept {
+        return lhs.get() != rhs.get();
+    }
+
+    friend inline bool operator==(const intrusive_ptr &lhs, std::nullptr_t) noexcept {
+        return lhs.get() == nullptr;
+    }
+
+    friend inline bool operator!=(const intrusive_ptr &lhs, std::nullptr_t) noexcept {
+        return lhs.get() != nullptr;
+    }
+};
+
+} /* namespace juro::helpers */
+
+template<class T>
+struct std::hash<juro::helpers::intrusive_ptr<T>> {
+    std::size_t operator()(const juro::helpers::intrusive_ptr<T> &pointer) const noexcept {
+        return std::hash<T *> {  }(pointer.get());
+    }
+};
+
+#endif /* JURO_INTRUSIVE_PTR_HPP */
@@ -0,0 +1,502 @@
+/**
+ * @file juro/pipeline.hpp
+ * @brief Contains fused continuation pipelines, which run a sequence of
+ * handlers off a single settle handler and a single result promise.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_PIPELINE_HPP
+#define JURO_PIPELINE_HPP
+
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "juro/helpers.hpp"
+#include "juro/executor.hpp"
+#include "juro/factories.hpp"
+#include "juro/promise.hpp"
+
+namespace juro::pipelines {
+
+using namespace juro::helpers;
+using namespace juro::executors;
+using namespace juro::factories;
+
+/**
+ * @brief Stands for the reject handler of a stage that only handles
+ * resolution: the rejection is handed to the next stage as is.
+ */
+struct forward_rejection {  };
+
+/**
+ * @brief The resolve handler of a `finally()` stage, which invokes the settle
+ * handler with the resolved value, or `std::nullopt` for `void` promises.
+ * @tparam T_on_settle The type of the settle handler
+ */
+template<class T_on_settle>
+struct settle_forwarder {
+    T_on_settle on_settle;
+
+    inline decltype(auto) operator()() { return on_settle(std::nullopt); }
+
+    template<class T_value>
+    inline decltype(auto) operator()(T_value &value) { return on_settle(value); }
+};
+
+/**
+ * @brief A single step of a pipeline, equivalent to one `then()` call.
+ * @tparam T_on_resolve The type of the resolve handler
+ * @tparam T_on_reject The type of the reject handler
+ */
+template<class T_on_resolve, class T_on_reject>
+struct stage {
+    using resolve_type = T_on_resolve;
+    using reject_type = T_on_reject;
+
+    T_on_resolve on_resolve;
+    T_on_reject on_reject;
+};
+
+/**
+ * @brief Yields the reject handler type a stage would have been given by
+ * `then()` had it been attached to a promise of type `T`.
+ * @tparam T The type the stage receives
+ * @tparam T_stage The type of the stage
+ */
+template<class T, class T_stage>
+using stage_reject_t = std::conditional_t<
+    std::is_same_v<typename T_stage::reject_type, forward_rejection>,
+    rejection_forwarder<resolve_result_t<T, typename T_stage::resolve_type &>>,
+    typename T_stage::reject_type &
+>;
+
+/**
+ * @brief Yields the type a stage hands on to the next one, as the type of the
+ * promise `then()` would have chained.
+ * @tparam T The type the stage receives
+ * @tparam T_stage The type of the stage
+ */
+template<class T, class T_stage>
+using stage_result_t = chained_promise_type<
+    T,
+    typename T_stage::resolve_type &,
+    stage_reject_t<T, T_stage>
+>;
+
+/**
+ * @brief Yields the type of the promise a pipeline settles once every stage
+ * has run.
+ * @tparam T The type of the promise the pipeline is attached to
+ * @tparam ...T_stages The types of the stages
+ */
+template<class T, class ...T_stages>
+struct pipeline_result {
+    using type = T;
+};
+
+template<class T, class T_stage, class ...T_rest>
+struct pipeline_result<T, T_stage, T_rest...> {
+    using type = typename pipeline_result<stage_result_t<T, T_stage>, T_rest...>::type;
+};
+
+template<class T, class ...T_stages>
+using pipeline_result_t = typename pipeline_result<T, T_stages...>::type;
+
+/**
+ * @brief A sequence of stages not attached to any promise yet. Pipelines are
+ * built with `juro::then()`, `juro::rescue()` and `juro::finally()` and
+ * concatenated with `operator|`.
+ * @tparam ...T_stages The types of the stages
+ */
+template<class ...T_stages>
+struct pipeline {
+    std::tuple<T_stages...> stages;
+};
+
+/**
+ * @brief The settle handler of a pipeline: it runs every stage in turn,
+ * handing each one's outcome straight to the next, and settles the result
+ * promise with the last one. A stage that returns a promise suspends the
+ * pipeline, which resumes off that promise's settle handler.
+ * @tparam T_result The type of the result promise
+ * @tparam ...T_stages The types of the stages
+ */
+template<class T_result, class ...T_stages>
+class fused_pipeline {
+    static constexpr std::size_t stage_count = sizeof...(T_stages);
+
+    std::tuple<T_stages...> stages;
+    promise_ptr<T_result> result;
+
+public:
+    fused_pipeline(std::tuple<T_stages...> &&stages, promise_ptr<T_result> result) :
+        stages { std::move(stages) },
+        result { std::move(result) }
+        {  }
+
+    /**
+     * @brief Runs the pipeline from the outcome of the settled promise it is
+     * attached to.
+     * @tparam T The type of the settled promise
+     * @param source The settled promise
+     */
+    template<class T>
+    void run(promise<T> &source) {
+        if(source.is_rejected()) {
+            reject_from<0, T>(source.get_error());
+        } else {
+            resolve_from<0, T>(source.get_value(), settle_access::is_unobserved(source));
+        }
+    }
+
+private:
+    template<std::size_t Index>
+    using stage_type = std::tuple_element_t<Index, std::tuple<T_stages...>>;
+
+    /**
+     * @brief Runs a stage's resolve handler, or settles the result promise
+     * once every stage has run. Passthrough stages hand the value on as is;
+     * the value is moved into the result promise and into handlers that take 
+     * it as an rvalue only when owned, and copied otherwise.
+     * @tparam Index The index of the stage
+     * @tparam T The type the stage receives
+     * @param value The value the stage receives
+     * @param owned Whether no one else can observe the value
+     */
+    template<std::size_t Index, class T>
+    void resolve_from(storage_type<T> &value, bool owned) {
+        if constexpr(Index == stage_count) {
+            if(!result->is_pending()) {
+                return;
+            }
+            if constexpr(std::is_void_v<T>) {
+                settle_access::resolve_owned(result);
+            } else if(owned) {
+                settle_access::resolve_owned(result, std::move(value));
+            } else {
+                settle_access::resolve_owned(result, value);
+            }
+        } else {
+            using resolve_type = typename stage_type<Index>::resolve_type;
+            static_assert(
+                (std::is_void_v<T> && std::is_invocable_v<resolve_type &>) ||
+                std::is_invocable_v<resolve_type &, storage_type<T> &> ||
+                std::is_invocable_v<resolve_type &, storage_type<T> &&>,
+                "Resolve handler has an incompatible signature."
+            );
+
+            auto &on_resolve = std::get<Index>(stages).on_resolve;
+            if constexpr(passes_value_through_v<resolve_type>) {
+                resolve_from<Index + 1, T>(value, owned);
+            } else {
+                deliver<Index + 1, stage_result_t<T, stage_type<Index>>>(
+                    [&] () -> resolve_result_t<T, resolve_type &> {
+                        if constexpr(std::is_void_v<T>) {
+                            return on_resolve();
+                        } else if constexpr(takes_rvalue_v<T, resolve_type &>) {
+                            if(owned) {
+                                return on_resolve(std::move(value));
+                            }
+                            return on_resolve(storage_type<T>(value));
+                        } else {
+                            return on_resolve(value);
+                        }
+                    }
+                );
+            }
+        }
+    }
+
+    /**
+     * @brief Runs a stage's reject handler, or rejects the result promise
+     * once every stage has run.
+     * @tparam Index The index of the stage
+     * @tparam T The type the stage receives
+     * @param error The rejection reason the stage receives
+     */
+    template<std::size_t Index, class T>
+    void reject_from(std::exception_ptr error) {
+        if constexpr(Index == stage_count) {
+            if(result->is_pending()) {
+                result->reject(std::move(error));
+            }
+        } else {
+            using reject_type = typename stage_type<Index>::reject_type;
+            using next_type = stage_result_t<T, stage_type<Index>>;
+
+            if constexpr(std::is_same_v<reject_type, forward_rejection>) {
+                reject_from<Index + 1, next_type>(std::move(error));
+            } else {
+                static_assert(
+                    std::is_invocable_v<reject_type &, std::exception_ptr &>,
+                    "Reject handler has an incompatible signature."
+                );
+
+                auto &on_reject = std::get<Index>(stages).on_reject;
+                deliver<Index + 1, next_type>(
+                    [&] () -> reject_result_t<reject_type &> { return on_reject(error); }
+                );
+            }
+        }
+    }
+
+    /**
+     * @brief Invokes a stage's handler and hands its outcome to the next
+     * stage. Exceptions thrown by the handler become the rejection reason the
+     * next stage receives; later stages run outside of the handler's `try`
+     * block.
+     * @tparam Index The index of the next stage
+     * @tparam T_next The type the next stage receives
+     * @tparam T_handler The type of the functor invoking the handler
+     * @param handler The functor invoking the handler
+     */
+    template<std::size_t Index, class T_next, class T_handler>
+    void deliver(T_handler &&handler) {
+        using returned_type = std::invoke_result_t<T_handler &>;
+
+        if constexpr(std::is_void_v<returned_type>) {
+            try {
+                handler();
+            } catch(...) {
+                return reject_from<Index, T_next>(std::current_exception());
+            }
+            storage_type<T_next> next_value {  };
+            resolve_from<Index, T_next>(next_value, true);
+        } else if constexpr(is_promise_v<returned_type>) {
+            returned_type awaited;
+            try {
+                awaited = handler();
+            } catch(...) {
+                return reject_from<Index, T_next>(std::current_exception());
+            }
+            suspend<Index, T_next>(*awaited);
+        } else {
+            std::optional<storage_type<T_next>> next_value;
+            try {
+                next_value.emplace(handler());
+            } catch(...) {
+                return reject_from<Index, T_next>(std::current_exception());
+            }
+            resolve_from<Index, T_next>(*next_value, true);
+        }
+    }
+
+    /**
+     * @brief Suspends the pipeline until a promise returned by a stage is
+     * settled. The pipeline moves into that promise's settle handler, and
+     * cancelling the result promise cancels the awaited one.
+     * @tparam Index The index of the next stage
+     * @tparam T_next The type the next stage receives
+     * @tparam T The type of the awaited promise
+     * @param awaited The awaited promise
+     */
+    template<std::size_t Index, class T_next, class T>
+    void suspend(promise<T> &awaited) {
+        auto &target = *result;
+        settle_access::attach(awaited, [&awaited, pipeline = std::move(*this)] () mutable {
+            if(awaited.is_rejected()) {
+                pipeline.template reject_from<Index, T_next>(awaited.get_error());
+            } else if constexpr(std::is_void_v<T>) {
+                storage_type<T_next> next_value {  };
+                pipeline.template resolve_from<Index, T_next>(next_value, true);
+            } else if(settle_access::is_unobserved(awaited)) {
+                storage_type<T_next> next_value(std::move(awaited.get_value()));
+                pipeline.template resolve_from<Index, T_next>(next_value, true);
+            } else {
+                storage_type<T_next> next_value(awaited.get_value());
+                pipeline.template resolve_from<Index, T_next>(next_value, true);
+            }
+        });
+        settle_access::link(awaited, target);
+    }
+};
+
+/**
+ * @brief A pipeline bound to the promise it will be attached to. Further
+ * stages may be appended with `operator|`; nothing is attached until the
+ * pipeline is started, explicitly or by converting it to a `promise_ptr`.
+ * @tparam T The type of the promise the pipeline is bound to
+ * @tparam ...T_stages The types of the stages
+ */
+template<class T, class ...T_stages>
+class bound_pipeline {
+    template<class, class ...> friend class bound_pipeline;
+
+    promise_ptr<T> source;
+    std::tuple<T_stages...> stages;
+
+public:
+    using result_type = pipeline_result_t<T, T_stages...>;
+
+    bound_pipeline(promise_ptr<T> source, std::tuple<T_stages...> &&stages) :
+        source { std::move(source) },
+        stages { std::move(stages) }
+        {  }
+
+    /**
+     * @brief Attaches the pipeline to its promise, overwriting any previously
+     * attached settle handler, like `then()`. Like chained promises, the
+     * result promise is concurrent if the source promise is and inherits its
+     * default executor, through which the whole pipeline is dispatched.
+     * @return The result promise.
+     */
+    promise_ptr<result_type> start() && {
+        auto &target = *source;
+        auto result = target.is_concurrent() ?
+            make_concurrent<result_type>() :
+            make_pending<result_type>();
+
+        auto *dispatcher = target.get_executor();
+        if(dispatcher != nullptr) {
+            result->via(*dispatcher);
+        }
+
+        fused_pipeline<result_type, T_stages...> pipeline { std::move(stages), result };
+        if(dispatcher != nullptr) {
+            settle_access::attach(target, [
+                &target,
+                dispatcher,
+                pipeline = std::move(pipeline)
+            ] () mutable {
+                dispatcher->schedule([
+                    source = target.self(),
+                    pipeline = std::move(pipeline)
+                ] () mutable {
+                    pipeline.run(*source);
+                });
+            });
+        } else {
+            settle_access::attach(target, [&target, pipeline = std::move(pipeline)] () mutable {
+                pipeline.run(target);
+            });
+        }
+        settle_access::link(target, *result);
+        return result;
+    }
+
+    inline operator promise_ptr<result_type>() && {
+        return std::move(*this).start();
+    }
+
+    /**
+     * @brief Appends stages to the pipeline.
+     * @tparam ...T_appended The types of the appended stages
+     * @param bound The pipeline to append to
+     * @param appended The stages to append
+     * @return The extended pipeline
+     */
+    template<class ...T_appended>
+    friend bound_pipeline<T, T_stages..., T_appended...> operator|(
+        bound_pipeline &&bound,
+        pipeline<T_appended...> appended
+    ) {
+        return {
+            std::move(bound.source),
+            std::tuple_cat(std::move(bound.stages), std::move(appended.stages))
+        };
+    }
+};
+
+/**
+ * @brief Binds a pipeline to a promise.
+ * @tparam T The type of the promise
+ * @tparam ...T_stages The types of the stages
+ * @param source The promise to attach the pipeline to
+ * @param stages The pipeline to attach
+ * @return A pipeline bound to the promise, which attaches itself once
+ * started or converted to a `promise_ptr`.
+ */
+template<class T, class ...T_stages>
+inline bound_pipeline<T, T_stages...> operator|(
+    const promise_ptr<T> &source,
+    pipeline<T_stages...> stages
+) {
+    return { source, std::move(stages.stages) };
+}
+
+/**
+ * @brief Concatenates two pipelines.
+ * @tparam ...T_first The types of the first pipeline's stages
+ * @tparam ...T_second The types of the second pipeline's stages
+ * @param first The stages to run first
+ * @param second The stages to run next
+ * @return A pipeline running every stage in order
+ */
+template<class ...T_first, class ...T_second>
+inline pipeline<T_first..., T_second...> operator|(
+    pipeline<T_first...> first,
+    pipeline<T_second...> second
+) {
+    return { std::tuple_cat(std::move(first.stages), std::move(second.stages)) };
+}
+
+/**
+ * @brief Creates a pipeline stage equivalent to `.then(on_resolve, on_reject)`.
+ * @tparam T_on_resolve The type of the resolve handler
+ * @tparam T_on_reject The type of the reject handler
+ * @param on_resolve The functor to be invoked when the previous stage resolves.
+ * @param on_reject The functor to be invoked when the previous stage rejects.
+ * @return A single-stage pipeline.
+ */
+template<class T_on_resolve, class T_on_reject>
+inline auto then(T_on_resolve &&on_resolve, T_on_reject &&on_reject) {
+    using stage_type = stage<std::decay_t<T_on_resolve>, std::decay_t<T_on_reject>>;
+    return pipeline<stage_type> {
+        std::tuple<stage_type> {
+            stage_type {
+                std::forward<T_on_resolve>(on_resolve),
+                std::forward<T_on_reject>(on_reject)
+            }
+        }
+    };
+}
+
+/**
+ * @brief Creates a pipeline stage equivalent to `.then(on_resolve)`:
+ * rejections are handed to the next stage as is.
+ * @tparam T_on_resolve The type of the resolve handler
+ * @param on_resolve The functor to be invoked when the previous stage resolves.
+ * @return A single-stage pipeline.
+ */
+template<class T_on_resolve>
+inline auto then(T_on_resolve &&on_resolve) {
+    return then(std::forward<T_on_resolve>(on_resolve), forward_rejection {  });
+}
+
+/**
+ * @brief Creates a pipeline stage equivalent to `.rescue(on_reject)`.
+ * @tparam T_on_reject The type of the reject handler
+ * @param on_reject The functor to be invoked when the previous stage rejects.
+ * @return A single-stage pipeline.
+ */
+template<class T_on_reject>
+inline auto rescue(T_on_reject &&on_reject) {
+    return then(value_passthrough {  }, std::forward<T_on_reject>(on_reject));
+}
+
+/**
+ * @brief Creates a pipeline stage equivalent to `.finally(on_settle)`.
+ * @tparam T_on_settle The type of the settle handler
+ * @param on_settle The functor to be invoked when the previous stage settles.
+ * @return A single-stage pipeline.
+ */
+template<class T_on_settle>
+inline auto finally(T_on_settle &&on_settle) {
+    return then(
+        settle_forwarder<std::decay_t<T_on_settle>> { on_settle },
+        std::forward<T_on_settle>(on_settle)
+    );
+}
+
+} /* namespace juro::pipelines */
+
+namespace juro {
+
+using namespace juro::pipelines;
+
+} /* namespace juro */
+
+#endif /* JURO_PIPELINE_HPP */
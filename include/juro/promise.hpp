@@ -8,62 +8,352 @@
 #ifndef JURO_PROMISE_HPP
 #define JURO_PROMISE_HPP
 
-#include<functional>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <variant>
+#include "juro/config.hpp"
 #include "juro/helpers.hpp"
+#include "juro/instrumentation.hpp"
+#include "juro/function.hpp"
+#include "juro/executor.hpp"
 #include "juro/factories.hpp"
-#include "juro/compose/all.hpp"
+
+/**
+ * @brief The amount of settle handlers that may run nested on a thread's
+ * stack. A promise settled deeper than that has its handler deferred to a
+ * thread-local queue, which the outermost settlement drains once its own
+ * handler returns, so arbitrarily long chains settle in bounded stack depth.
+ * Setting it to `1` trampolines every nested settlement.
+ */
+#ifndef JURO_SETTLE_DEPTH
+#define JURO_SETTLE_DEPTH 16
+#endif /* JURO_SETTLE_DEPTH */
 
 namespace juro {
 
 using namespace juro::helpers;
+using namespace juro::executors;
 using namespace juro::factories;
-using namespace juro::compose;
+using namespace juro::instrumentation;
+
+/**
+ * @brief The type-erased callable invoked when a promise is settled. It is
+ * move-only and stores typical chaining closures without dynamic allocation.
+ */
+using settle_handler = unique_function<void()>;
+
+class promise_interface;
+class settle_batch;
+
+/**
+ * @brief The type-erased callable run when a promise is cancelled, which
+ * receives the cancelled promise. Closures capturing up to two pointers are
+ * stored inline.
+ */
+using cancel_handler = 
+    unique_function<void(promise_interface &), 2 * sizeof(void *)>;
+
+/**
+ * @brief The untyped part of every promise.
+ * @details Only promises that must be released through a type-erased pointer
+ * have a vtable: with `std::shared_ptr`, the control block already knows the
+ * concrete type of the promise, so by default promises are not polymorphic.
+ */
+#ifdef JURO_INTRUSIVE_PTR
+class promise_interface : public ref_counted {
+#else
+class promise_interface : 
+    public std::enable_shared_from_this<promise_interface> {
+#endif /* JURO_INTRUSIVE_PTR */
+    friend struct helpers::settle_access;
+    friend class settle_batch;
 
-class promise_interface {
 private:
     /**
-     * @brief Holds the current state of the promise; Once settled, it cannot be
-     * changed.
+     * @brief Bits of the state word. The two lowest bits hold a 
+     * `promise_state`; `CONSUMED` marks resolved promises whose value was
+     * consumed, `UNOBSERVED` promises only the library can read and the 
+     * others are only used by concurrent promises.
      */
-    promise_state state = promise_state::PENDING;
+    enum state_bits : std::uint8_t {
+        STATE_MASK = 0x03,
+        SETTLING = 0x04,
+        ATTACHING = 0x08,
+        ATTACHED = 0x10,
+        CONCURRENT = 0x20,
+        CONSUMED = 0x40,
+        UNOBSERVED = 0x80
+    };
 
     /**
      * @brief Type-erased callback to be executed once the promise is settled.
+     * It is destroyed as soon as it has run, releasing whatever it captured.
+     */
+    settle_handler on_settle;
+
+    /**
+     * @brief The executor through which continuations attached without an
+     * explicit executor are dispatched; if `nullptr`, they are run inline.
+     */
+    executor *default_executor = nullptr;
+
+    /**
+     * @brief The promise this one waits on and the promise waiting on this
+     * one, along which cancellation travels upstream. Only ordinary promises
+     * are linked; both ends are unlinked when either is destroyed.
+     */
+    promise_interface *upstream = nullptr;
+    promise_interface *downstream = nullptr;
+
+#ifdef JURO_INSTRUMENTATION
+    /**
+     * @brief The identifier this promise is reported by to the installed 
+     * `juro::observer`. Requires `JURO_INSTRUMENTATION`;
+     * it sits where the cancel handler's alignment leaves a gap anyway.
+     */
+    promise_id trace_id = instrumentation::detail::next_id();
+#endif /* JURO_INSTRUMENTATION */
+
+    /**
+     * @brief Callback registered by the producer, invoked if the promise is
+     * cancelled while pending.
+     */
+    cancel_handler cancel_callback;
+
+    /**
+     * @brief Holds the current state of the promise; Once settled, it cannot be
+     * changed. For concurrent promises, it is also the synchronisation point
+     * between settling and handler installation. It also tells which member
+     * of a `promise<T>`'s storage is alive, so it is laid out last, right
+     * before that storage.
      */
-    std::function<void()> on_settle;
+    std::atomic<std::uint8_t> state { 
+        static_cast<std::uint8_t>(promise_state::PENDING) 
+    };
+
+#ifdef JURO_COUNT_PROMISES
+    /**
+     * @brief The amount of promises currently alive, in every thread.
+     */
+    static std::atomic<std::size_t> live_count;
+#endif /* JURO_COUNT_PROMISES */
+
+    inline void count_created() noexcept {
+#ifdef JURO_COUNT_PROMISES
+        live_count.fetch_add(1, std::memory_order_relaxed);
+#endif /* JURO_COUNT_PROMISES */
+        notify(&observer::created);
+    }
 
 protected:
-    promise_interface() noexcept = default;
+    /**
+     * @brief Reports an event of this promise to the installed observer, if
+     * any. Without `JURO_INSTRUMENTATION`, this compiles to nothing.
+     * @tparam T_hook The type of the observer's member function
+     * @tparam ...T_args The types of the arguments following the identifier
+     * @param hook The observer's member function to invoke
+     * @param ...args The arguments following the identifier
+     */
+    template<class T_hook, class ...T_args>
+    inline void notify(
+        [[maybe_unused]] T_hook hook, 
+        [[maybe_unused]] T_args &&...args
+    ) const noexcept {
+#ifdef JURO_INSTRUMENTATION
+        if(auto *watcher = get_observer()) {
+            (watcher->*hook)(trace_id, std::forward<T_args>(args)...);
+        }
+#endif /* JURO_INSTRUMENTATION */
+    }
+
+    /**
+     * @brief Reports this promise as chained to the supplied one.
+     * @param parent The promise whose outcome will settle this one
+     */
+    inline void notify_chained([[maybe_unused]] const promise_interface &parent) const noexcept {
+#ifdef JURO_INSTRUMENTATION
+        notify(&observer::chained, parent.trace_id);
+#endif /* JURO_INSTRUMENTATION */
+    }
+
+    promise_interface() noexcept { count_created(); }
     promise_interface(promise_state state) noexcept;
+    promise_interface(concurrent_promise_tag) noexcept;
     promise_interface(const promise_interface &) = delete;
-    promise_interface(promise_interface &&) noexcept = default;
+    promise_interface(promise_interface &&) = delete;
 
     promise_interface &operator=(const promise_interface &) = delete;
-    promise_interface &operator=(promise_interface &&) noexcept = default;
-    virtual ~promise_interface() = default;
+    promise_interface &operator=(promise_interface &&) = delete;
+#ifdef JURO_INTRUSIVE_PTR
+    virtual ~promise_interface() noexcept;
+#else
+    ~promise_interface() noexcept;
+#endif /* JURO_INTRUSIVE_PTR */
+
+    void set_settle_handler(settle_handler &&handler);
+    void set_cancel_handler(cancel_handler &&handler) noexcept;
+    void link_downstream(promise_interface &next) noexcept;
+    void resolved();
+    void rejected(const std::exception_ptr &error);
+
+    inline cancel_handler take_cancel_handler() noexcept {
+        return std::exchange(cancel_callback, nullptr);
+    }
+
+    /**
+     * @brief Returns whether the value of a resolved promise was consumed.
+     */
+    inline bool is_consumed() const noexcept {
+        return state.load(std::memory_order_relaxed) & CONSUMED;
+    }
+
+    inline void mark_consumed() noexcept {
+        state.fetch_or(CONSUMED, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns whether the library settled this promise through the only
+     * handle to it: no one else can read its value, so whoever observes its
+     * settlement may move the value out.
+     */
+    inline bool is_unobserved() const noexcept {
+        return state.load(std::memory_order_relaxed) & UNOBSERVED;
+    }
+
+    inline void mark_unobserved() noexcept {
+        state.fetch_or(UNOBSERVED, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Cancels the promise this one waits on, if any.
+     */
+    inline void cancel_upstream() {
+        if(upstream != nullptr) {
+            upstream->cancel();
+        }
+    }
+
+    inline void set_default_executor(executor *dispatcher) noexcept {
+        default_executor = dispatcher;
+    }
+
+    /**
+     * @brief Claims the right to settle the promise. For concurrent promises,
+     * only the first of several competing settlers succeeds.
+     * @return Whether the promise may be settled by the caller.
+     */
+    inline bool begin_settle() noexcept {
+        if(!is_concurrent()) {
+            return is_pending();
+        }
+
+        auto current = state.load(std::memory_order_relaxed);
+        do {
+            if(current & (STATE_MASK | SETTLING)) {
+                return false;
+            }
+        } while(!state.compare_exchange_weak(
+            current, 
+            current | SETTLING, 
+            std::memory_order_acquire,
+            std::memory_order_relaxed
+        ));
+        return true;
+    }
+
+    /**
+     * @brief Gives up a settle right claimed by `begin_settle()`, e.g. because
+     * storing the settled value threw.
+     */
+    inline void abort_settle() noexcept {
+        if(is_concurrent()) {
+            state.fetch_and(
+                static_cast<std::uint8_t>(~SETTLING), 
+                std::memory_order_release
+            );
+        }
+    }
 
-    void set_settle_handler(std::function<void()> &&handler) noexcept;
-    void resolved() noexcept;
-    void rejected();
+private:
+    void attach_concurrent_handler(settle_handler &&handler);
+    bool publish_state(promise_state settled_state) noexcept;
+    void dispatch_settle();
+    void run_settle_handler();
+    static void drain_deferred(std::exception_ptr &failure);
+    void unlink_upstream() noexcept;
+    void unlink_downstream() noexcept;
 
 public:
+    /**
+     * @brief Tells the producer upstream that the result of this promise is 
+     * no longer needed.
+     * @details Cancellation travels up the `then()` links to the first pending
+     * promise whose producer registered a cancel callback with `on_cancel()`.
+     * That promise is rejected with a `juro::cancellation_error` once the
+     * callback returns, and the rejection flows back down the chain as usual;
+     * rejections nobody handles are not reported. If no producer along the
+     * chain registered a callback, nothing happens. Concurrent promises ignore
+     * cancellation.
+     */
+    void cancel();
+
+#ifdef JURO_COUNT_PROMISES
+    /**
+     * @brief Returns the amount of promises currently alive, which lets tests
+     * verify that settled chains are released. Requires `JURO_COUNT_PROMISES`.
+     * @return The amount of constructed promises not destroyed yet.
+     */
+    static inline std::size_t live_promises() noexcept {
+        return live_count.load(std::memory_order_relaxed);
+    }
+#endif /* JURO_COUNT_PROMISES */
+
+#ifdef JURO_INSTRUMENTATION
+    /**
+     * @brief Returns the identifier this promise is reported by to the
+     * installed observer. Requires `JURO_INSTRUMENTATION`.
+     * @return The identifier of the promise.
+     */
+    inline promise_id get_id() const noexcept { return trace_id; }
+#endif /* JURO_INSTRUMENTATION */
+
     /**
      * @brief Returns the current state of the promise. A promise is pending
      * when it does not hold anything yet; it is resolved when it holds a
      * `value_type` and is rejected when it holds a `std::exception_ptr`.
      * @return The current state of the promise.
      */
-    inline promise_state get_state() const noexcept { return state; }
+    inline promise_state get_state() const noexcept { 
+        return static_cast<promise_state>(
+            state.load(std::memory_order_acquire) & STATE_MASK
+        ); 
+    }
+
+    /**
+     * @brief Returns the default executor of this promise.
+     * @return The default executor or `nullptr` if continuations run inline.
+     */
+    inline executor *get_executor() const noexcept { return default_executor; }
+
+    /**
+     * @brief Returns whether the promise may be settled and chained from
+     * different threads.
+     * @return Whether the promise is concurrent.
+     */
+    inline bool is_concurrent() const noexcept {
+        return state.load(std::memory_order_relaxed) & CONCURRENT;
+    }
 
     /**
      * @brief Returns whether the promise is pending.
      * @return Whether the promise is pending.
      */
     inline bool is_pending() const noexcept {
-        return state == promise_state::PENDING;
+        return get_state() == promise_state::PENDING;
     }
 
     /**
@@ -71,7 +361,7 @@ public:
      * @return Whether the promise is resolved.
      */
     inline bool is_resolved() const noexcept {
-        return state == promise_state::RESOLVED;
+        return get_state() == promise_state::RESOLVED;
     }
 
     /**
@@ -79,7 +369,7 @@ public:
      * @return Whether the promise is rejected.
      */
     inline bool is_rejected() const noexcept {
-        return state == promise_state::REJECTED;
+        return get_state() == promise_state::REJECTED;
     }
 
 
@@ -88,9 +378,30 @@ public:
      * @return Whether the promise is either resolved or rejected.
      */
     inline bool is_settled() const noexcept {
-        return state != promise_state::PENDING;
+        return get_state() != promise_state::PENDING;
+    }
+
+#ifdef JURO_INTRUSIVE_PTR
+    /**
+     * @brief Drops a reference to the promise, destroying it if it was the 
+     * last one.
+     */
+    inline void release() const noexcept {
+        if(release_reference()) {
+            const_cast<promise_interface *>(this)->destroy();
+        }
     }
 
+protected:
+    /**
+     * @brief Destroys the promise and frees its memory once no references are
+     * left. Promises created with custom allocators override this.
+     */
+    virtual void destroy() noexcept { delete this; }
+
+public:
+#endif /* JURO_INTRUSIVE_PTR */
+
 #ifdef JURO_TEST
     /**
      * @brief Helper function to determine if this promise has a settle handler
@@ -104,6 +415,63 @@ public:
 
 };
 
+/**
+ * @brief Defers the settle handlers of every promise settled on the calling
+ * thread while the batch is open, then runs them all in one pass when it is
+ * closed.
+ * @details Settling many unrelated promises in a row -- e.g. every completion
+ * returned by one `epoll_wait()` -- normally runs each continuation chain 
+ * right away, interleaving chains that share nothing. In a batch, every 
+ * promise is marked settled first and its handler queued; closing the batch
+ * then drains the queue, either on the calling thread or as a single task of
+ * an executor. Rejections nobody handles still throw from `reject()`. Batches
+ * opened while another one is open, or closed inside a running handler, join
+ * the enclosing pass instead of draining on their own, even if they were
+ * given an executor.
+ * @warning A batch must be closed on the thread that opened it.
+ */
+class settle_batch {
+    executor *dispatcher;
+    std::size_t first;
+    bool open = true;
+
+public:
+    /**
+     * @brief Opens a batch.
+     * @param dispatcher The executor running the deferred handlers as a 
+     * single task; if `nullptr`, they run on the thread closing the batch.
+     */
+    explicit settle_batch(executor *dispatcher = nullptr) noexcept;
+
+    explicit settle_batch(executor &dispatcher) noexcept :
+        settle_batch(&dispatcher)
+        {  }
+
+    settle_batch(const settle_batch &) = delete;
+    settle_batch(settle_batch &&) = delete;
+
+    /**
+     * @brief Closes the batch if still open. Exceptions thrown by the deferred
+     * handlers are discarded; call `close()` to observe them.
+     */
+    ~settle_batch() noexcept;
+
+    settle_batch &operator=(const settle_batch &) = delete;
+    settle_batch &operator=(settle_batch &&) = delete;
+
+    /**
+     * @brief Closes the batch, running or scheduling the deferred handlers.
+     * Every handler runs even if another one throws; the first exception is 
+     * rethrown once all of them ran. Closing a closed batch does nothing.
+     */
+    void close();
+
+    inline bool is_open() const noexcept { return open; }
+
+private:
+    static void run_deferred();
+};
+
 /**
  * @brief A promise represents a value that is not available yet.
  * @tparam T The type of the promised value; defaults to `void` if unspecified.
@@ -130,19 +498,17 @@ public:
      */
     using value_type = storage_type<T>;
 
-    /**
-     * @brief Represents the possible values a promise can hold: a pending
-     * promise holds an `empty_type`, a resolved promise holds a `value_type` 
-     * and a rejected promise holds an `std::exception_ptr`.
-     */
-    using settle_type = 
-        std::variant<empty_type, value_type, std::exception_ptr>;
-
 private:
     /**
-     * @brief Holds the settled value or `empty_type` if the promise is pending.
+     * @brief Holds the resolved value or the rejection reason. The state of
+     * the promise tells which member, if any, is alive: a pending promise 
+     * holds nothing, a resolved promise holds a `value_type` unless it was
+     * consumed and a rejected promise holds an `std::exception_ptr`.
      */
-    settle_type value;
+    union {
+        value_type stored_value;
+        std::exception_ptr stored_error;
+    };
 
 public:
     /**
@@ -150,7 +516,7 @@ public:
      * @warning This should not be called directly; use `juro::make_pending()` 
      * or `juro::make_promise()` instead.
      */
-    promise() = default;
+    promise() noexcept {  }
 
     /**
      * @brief Constructs a resolved promise.
@@ -162,7 +528,7 @@ public:
     template<class T_value>
     promise(resolved_promise_tag, T_value &&value) :
         promise_interface { promise_state::RESOLVED },
-        value { std::forward<T_value>(value) }
+        stored_value { std::forward<T_value>(value) }
         {  }
 
     /**
@@ -176,12 +542,28 @@ public:
     template<class T_value>
     promise(rejected_promise_tag, T_value &&value) : 
         promise_interface { promise_state::REJECTED },
-        value { rejection_value(std::forward<T_value>(value)) }
+        stored_error { rejection_value(std::forward<T_value>(value)) }
+        {  }
+
+    /**
+     * @brief Constructs a pending concurrent promise.
+     * @warning This should not be called directly; use `juro::make_concurrent()`
+     * instead.
+     */
+    promise(concurrent_promise_tag tag) :
+        promise_interface { tag }
         {  }
 
     promise(promise &&) = delete;
     promise(const promise &) = delete;
-    ~promise() noexcept = default;
+
+    ~promise() noexcept {
+        if(has_value()) {
+            stored_value.~value_type();
+        } else if(is_rejected()) {
+            stored_error.~exception_ptr();
+        }
+    }
 
     promise &operator=(promise &&) = delete;
     promise &operator=(const promise &) = delete;
@@ -193,7 +575,10 @@ public:
      * @return The resolved value.
      */
     value_type &get_value() {
-        return std::get<value_type>(value);
+        if(!has_value()) {
+            throw std::bad_variant_access {  };
+        }
+        return stored_value;
     }
 
     /**
@@ -202,7 +587,10 @@ public:
      * @return The rejected value.
      */
     std::exception_ptr &get_error() {
-        return std::get<std::exception_ptr>(value);
+        if(!is_rejected()) {
+            throw std::bad_variant_access {  };
+        }
+        return stored_error;
     }
 
     /**
@@ -219,34 +607,119 @@ public:
             "Resolved value is not convertible to promise type"
         );
 
-        if(is_settled()) {
+        if(!begin_settle()) {
             throw promise_error { "Attempted to resolve an already settled promise" };
         }
 
-        value = std::forward<T_value>(resolved_value);
+        try {
+            ::new(static_cast<void *>(&stored_value)) 
+                value_type(std::forward<T_value>(resolved_value));
+        } catch(...) {
+            abort_settle();
+            throw;
+        }
         resolved();
     }
 
     /**
      * @brief Rejects the promise with a given value. Fires the settle handler 
      * if there is one attached, otherwise throws a `juro::promise_exception`.
+     * Concurrent promises do not throw; the rejection is delivered once a 
+     * handler is attached.
      * @tparam T_value The value type with which to settle the promise.
      * @param rejected_value The value with which to settle the promise. If it 
      * is not an `std::exception_ptr`, it will be stored into one.
      */
     template<class T_value = promise_error>
     void reject(T_value &&rejected_value = promise_error { "Promise was rejected" }) {
-        if(is_settled()) {
+        if(!begin_settle()) {
             throw promise_error { "Attempted to reject an already settled promise" };
         }
 
-        value = rejection_value(std::forward<T_value>(rejected_value));
-        rejected();
+        try {
+            ::new(static_cast<void *>(&stored_error)) std::exception_ptr(
+                rejection_value(std::forward<T_value>(rejected_value))
+            );
+        } catch(...) {
+            abort_settle();
+            throw;
+        }
+        rejected(stored_error);
+    }
+
+    /**
+     * @brief Sets the default executor of this promise: continuations attached
+     * without an explicit executor are dispatched through it instead of being
+     * run inline. Chained promises inherit it.
+     * @param default_executor The executor to be used as default. It must
+     * outlive every continuation dispatched through it.
+     * @return A pointer to this promise, for convenient chaining.
+     */
+    promise_ptr<T> via(executor &default_executor) {
+        set_default_executor(&default_executor);
+        return self();
+    }
+
+    /**
+     * @brief Registers the callback through which the producer of this 
+     * promise learns it was cancelled, e.g. to abort the underlying work. It
+     * replaces any previously registered one and is dropped once the promise
+     * settles. Settled and concurrent promises ignore it.
+     * @tparam T_on_cancel The type of the callback; must be invocable without
+     * arguments.
+     * @param on_cancel The functor to be invoked upon cancellation.
+     * @return A pointer to this promise, for convenient chaining.
+     */
+    template<class T_on_cancel>
+    promise_ptr<T> on_cancel(T_on_cancel &&on_cancel) {
+        static_assert(
+            std::is_invocable_v<T_on_cancel &>,
+            "Cancel callback has an incompatible signature."
+        );
+        set_cancel_handler(cancellation(std::forward<T_on_cancel>(on_cancel)));
+        return self();
+    }
+
+    /**
+     * @brief Takes over the settle handler of this promise to broadcast its
+     * outcome to any amount of listeners, without chaining a promise for 
+     * each. Requires `juro/shared_promise.hpp`.
+     * @return A `juro::shared_promise_ptr<T>`.
+     */
+    template<class T_shared = shared_promise<T>>
+    inline intrusive_ptr<T_shared> share() {
+        return T_shared::create(*this);
+    }
+
+    /**
+     * @brief Returns the amount of `promise_ptr`s currently referencing this
+     * promise.
+     * @return The amount of references held.
+     */
+    inline long use_count() const noexcept {
+#ifdef JURO_INTRUSIVE_PTR
+        return static_cast<long>(ref_counted::use_count());
+#else
+        return this->weak_from_this().use_count();
+#endif /* JURO_INTRUSIVE_PTR */
+    }
+
+    /**
+     * @brief Returns a new pointer to this promise.
+     * @return A pointer sharing ownership of this promise.
+     */
+    inline promise_ptr<T> self() {
+#ifdef JURO_INTRUSIVE_PTR
+        return promise_ptr<T> { this };
+#else
+        return std::static_pointer_cast<promise>(this->shared_from_this());
+#endif /* JURO_INTRUSIVE_PTR */
     }
 
     /**
      * @brief Attaches a settle handler to the promise, overwriting any
-     * previously attached one.
+     * previously attached one. Concurrent promises accept a single handler; 
+     * attaching another throws a `juro::promise_error`.
      * @tparam T_on_resolve The type of the resolve handler; should receive the 
      * promised type as parameter, preferably as a reference.
      * @tparam T_on_reject The type of the reject handler; should receive an
@@ -257,32 +730,165 @@ public:
      * functors provided.
      * @see `juro::helpers::chained_promise_type`
      */
-    template<class T_on_resolve, class T_on_reject>
+    template<
+        class T_on_resolve, 
+        class T_on_reject,
+        std::enable_if_t<
+            !is_executor_v<bare_t<T_on_resolve>> &&
+            !takes_rvalue_v<value_type, T_on_resolve>, 
+            int
+        > = 0
+    >
     auto then(T_on_resolve &&on_resolve, T_on_reject &&on_reject) {
+        if(auto *dispatcher = get_executor()) {
+            return then(
+                *dispatcher,
+                std::forward<T_on_resolve>(on_resolve),
+                std::forward<T_on_reject>(on_reject)
+            );
+        }
+
         assert_resolve_invocable<T_on_resolve>();
         assert_reject_invocable<T_on_reject>();
         
         using next_value_type = 
             chained_promise_type<T, T_on_resolve, T_on_reject>;
 
-        return make_promise<next_value_type>([&] (auto &next_promise) {
+        auto next_promise = make_chained_promise<next_value_type>();
+        if constexpr(forwards_rejection_v<T_on_reject>) {
+            // The forwarder is stateless: leaving it out of the capture keeps
+            // a handler capturing a pointer within the inline buffer.
             set_settle_handler([
-               this,
-               next_promise,
-               on_resolve = std::forward<T_on_resolve>(on_resolve),
-               on_reject = std::forward<T_on_reject>(on_reject)
-           ] {
-                try {
-                    if(is_resolved()) {
-                        handle_resolve(on_resolve, next_promise);
-                    } else if(is_rejected()) {
-                        handle_reject(on_reject, next_promise);
-                    }
-                } catch(...) {
-                    next_promise->reject(std::current_exception());
-                }
+                this,
+                next_promise,
+                on_resolve = std::forward<T_on_resolve>(on_resolve)
+            ] () mutable {
+                std::decay_t<T_on_reject> on_reject {  };
+                settle_chained(on_resolve, on_reject, next_promise);
+            });
+        } else {
+            set_settle_handler([
+                this,
+                next_promise,
+                on_resolve = std::forward<T_on_resolve>(on_resolve),
+                on_reject = std::forward<T_on_reject>(on_reject)
+            ] () mutable {
+                settle_chained(on_resolve, on_reject, next_promise);
+            });
+        }
+        link_downstream(*next_promise);
+        return next_promise;
+    }
+
+    /**
+     * @brief Attaches a settle handler to the promise, overwriting any
+     * previously attached one. Once the promise is settled, the handler is
+     * dispatched through the supplied executor instead of being run inline.
+     * @tparam T_executor The type of the executor; must have a `schedule()` 
+     * member function that takes a `juro::task`.
+     * @tparam T_on_resolve The type of the resolve handler
+     * @tparam T_on_reject The type of the reject handler
+     * @param dispatcher The executor through which to run the handler. It must
+     * outlive the dispatched handler.
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @param on_reject The functor to be invoked when the promise is rejected.
+     * @return A new promise of a type that depends on the types returned by the
+     * functors provided.
+     */
+    template<
+        class T_executor, 
+        class T_on_resolve, 
+        class T_on_reject,
+        std::enable_if_t<!takes_rvalue_v<value_type, T_on_resolve>, int> = 0
+    >
+    auto then(
+        T_executor &dispatcher, 
+        T_on_resolve &&on_resolve, 
+        T_on_reject &&on_reject
+    ) {
+        static_assert(
+            is_executor_v<T_executor>, 
+            "Executor has an incompatible interface."
+        );
+        assert_resolve_invocable<T_on_resolve>();
+        assert_reject_invocable<T_on_reject>();
+        
+        using next_value_type = 
+            chained_promise_type<T, T_on_resolve, T_on_reject>;
+
+        auto next_promise = make_chained_promise<next_value_type>();
+        set_settle_handler([
+            this,
+            dispatcher = &dispatcher,
+            next_promise,
+            on_resolve = std::forward<T_on_resolve>(on_resolve),
+            on_reject = std::forward<T_on_reject>(on_reject)
+        ] () mutable {
+            dispatcher->schedule([
+                self = self(),
+                next_promise = std::move(next_promise),
+                on_resolve = std::move(on_resolve),
+                on_reject = std::move(on_reject)
+            ] () mutable {
+                self->settle_chained(on_resolve, on_reject, next_promise);
             });
         });
+        link_downstream(*next_promise);
+        return next_promise;
+    }
+
+    /**
+     * @brief Attaches a settle handler whose resolve handler only takes the 
+     * resolved value as an rvalue, e.g. `[] (T &&value) { ... }`. The value is
+     * moved into the handler instead of copied, as by `consume()`.
+     * @tparam T_on_resolve The type of the resolve handler
+     * @tparam T_on_reject The type of the reject handler
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @param on_reject The functor to be invoked when the promise is rejected.
+     * @return A new promise of a type that depends on the types returned by the
+     * functors provided.
+     */
+    template<
+        class T_on_resolve, 
+        class T_on_reject,
+        std::enable_if_t<takes_rvalue_v<value_type, T_on_resolve>, int> = 0
+    >
+    inline auto then(T_on_resolve &&on_resolve, T_on_reject &&on_reject) {
+        return consume(
+            std::forward<T_on_resolve>(on_resolve),
+            std::forward<T_on_reject>(on_reject)
+        );
+    }
+
+    /**
+     * @brief Attaches a settle handler whose resolve handler only takes the 
+     * resolved value as an rvalue, to be dispatched through the supplied 
+     * executor.
+     * @tparam T_executor The type of the executor
+     * @tparam T_on_resolve The type of the resolve handler
+     * @tparam T_on_reject The type of the reject handler
+     * @param dispatcher The executor through which to run the handler
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @param on_reject The functor to be invoked when the promise is rejected.
+     * @return A new promise of a type that depends on the types returned by the
+     * functors provided.
+     */
+    template<
+        class T_executor, 
+        class T_on_resolve, 
+        class T_on_reject,
+        std::enable_if_t<takes_rvalue_v<value_type, T_on_resolve>, int> = 0
+    >
+    inline auto then(
+        T_executor &dispatcher, 
+        T_on_resolve &&on_resolve, 
+        T_on_reject &&on_reject
+    ) {
+        return then(
+            dispatcher,
+            consumer(std::forward<T_on_resolve>(on_resolve)),
+            std::forward<T_on_reject>(on_reject)
+        );
     }
 
     /**
@@ -300,7 +906,30 @@ public:
     inline auto then(T_on_resolve &&on_resolve) {
         return then(
             std::forward<T_on_resolve>(on_resolve),
-            [this] (auto &error) -> resolve_result_t<T, T_on_resolve> { std::rethrow_exception(error); }
+            rethrow_handler<T_on_resolve>()
+        );
+    }
+
+    /**
+     * @brief Attaches a resolve handler to the promise, to be dispatched 
+     * through the supplied executor.
+     * @tparam T_executor The type of the executor
+     * @tparam T_on_resolve The type of the resolve handler
+     * @param dispatcher The executor through which to run the handler
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @return A new promise of a type that depends on the type returned by the
+     * functor provided.
+     */
+    template<
+        class T_executor, 
+        class T_on_resolve,
+        std::enable_if_t<is_executor_v<T_executor>, int> = 0
+    >
+    inline auto then(T_executor &dispatcher, T_on_resolve &&on_resolve) {
+        return then(
+            dispatcher,
+            std::forward<T_on_resolve>(on_resolve),
+            rethrow_handler<T_on_resolve>()
         );
     }
 
@@ -317,14 +946,26 @@ public:
      */
     template<class T_on_reject>
     inline auto rescue(T_on_reject &&on_reject) {
-        if constexpr(is_void) {
-            return then([] {}, std::forward<T_on_reject>(on_reject));
-        } else {
-            return then(
-                [] (auto &value) { return value; },
-                std::forward<T_on_reject>(on_reject)
-            );
-        }
+        return then(passthrough_handler(), std::forward<T_on_reject>(on_reject));
+    }
+
+    /**
+     * @brief Attaches a reject handler to the promise, to be dispatched 
+     * through the supplied executor.
+     * @tparam T_executor The type of the executor
+     * @tparam T_on_reject The type of the reject handler
+     * @param dispatcher The executor through which to run the handler
+     * @param on_reject The functor to be invoked when the promise is rejected.
+     * @return A new promise of a type that depends on the type returned by the
+     * functor provided.
+     */
+    template<class T_executor, class T_on_reject>
+    inline auto rescue(T_executor &dispatcher, T_on_reject &&on_reject) {
+        return then(
+            dispatcher,
+            passthrough_handler(), 
+            std::forward<T_on_reject>(on_reject)
+        );
     }
 
     /**
@@ -352,7 +993,169 @@ public:
         }
     }
 
+    /**
+     * @brief Attaches a settle handler to the promise, to be dispatched 
+     * through the supplied executor.
+     * @tparam T_executor The type of the executor
+     * @tparam T_on_settle The type of the settle handler
+     * @param dispatcher The executor through which to run the handler
+     * @param on_settle The functor to be invoked when the promise is settled.
+     * @return A new promise of a type that depends on the type returned by the
+     * functor provided.
+     */
+    template<class T_executor, class T_on_settle>
+    inline auto finally(T_executor &dispatcher, T_on_settle &&on_settle) {
+        assert_settle_invocable<T_on_settle>();
+
+        if constexpr(is_void) {
+            return then(
+                dispatcher,
+                [=] { return on_settle(std::nullopt); }, 
+                std::forward<T_on_settle>(on_settle)
+            );
+        } else {
+            return then(dispatcher, on_settle, on_settle);
+        }
+    }
+
+    /**
+     * @brief Attaches a settle handler that consumes the resolved value: it is
+     * moved into the resolve handler and destroyed here once the handler
+     * returns, instead of living as long as this promise. The promise stays
+     * resolved but no longer holds a value, so `get_value()` throws afterwards.
+     * For `void` promises, this is the same as `then()`.
+     * @tparam T_on_resolve The type of the resolve handler; should receive the
+     * promised type by value or as an rvalue reference.
+     * @tparam T_on_reject The type of the reject handler
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @param on_reject The functor to be invoked when the promise is rejected.
+     * @return A new promise of a type that depends on the types returned by the
+     * functors provided.
+     */
+    template<class T_on_resolve, class T_on_reject>
+    inline auto consume(T_on_resolve &&on_resolve, T_on_reject &&on_reject) {
+        return then(
+            consumer(std::forward<T_on_resolve>(on_resolve)),
+            std::forward<T_on_reject>(on_reject)
+        );
+    }
+
+    /**
+     * @brief Attaches a resolve handler that consumes the resolved value. In
+     * case of rejection, the error will be propagated down the promise chain.
+     * @see `promise<T>::consume(on_resolve, on_reject)`
+     * @tparam T_on_resolve The type of the resolve handler
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @return A new promise of a type that depends on the type returned by the
+     * functor provided.
+     */
+    template<class T_on_resolve>
+    inline auto consume(T_on_resolve &&on_resolve) {
+        return then(consumer(std::forward<T_on_resolve>(on_resolve)));
+    }
+
 private:
+    /**
+     * @brief Wraps a resolve handler so that it receives the resolved value as
+     * an rvalue and the value is destroyed once the handler returns.
+     * @tparam T_on_resolve The type of the resolve handler
+     * @param on_resolve The resolve handler to be wrapped
+     */
+    template<class T_on_resolve>
+    inline auto consumer(T_on_resolve &&on_resolve) {
+        if constexpr(is_void) {
+            return std::forward<T_on_resolve>(on_resolve);
+        } else {
+            static_assert(
+                std::is_invocable_v<T_on_resolve &, value_type &&>,
+                "Resolve handler has an incompatible signature."
+            );
+            return [
+                this, 
+                on_resolve = std::forward<T_on_resolve>(on_resolve)
+            ] (value_type &resolved_value) mutable 
+                -> std::decay_t<std::invoke_result_t<T_on_resolve &, value_type &&>> {
+                auto consumed = std::move(resolved_value);
+                resolved_value.~value_type();
+                mark_consumed();
+                return on_resolve(std::move(consumed));
+            };
+        }
+    }
+
+    /**
+     * @brief Creates the promise returned by a chaining function. Chained 
+     * promises of concurrent promises are concurrent as well, because they are 
+     * settled on whichever thread settles their predecessor.
+     * @tparam T_next The type of the chained promise
+     * @return The newly created chained promise
+     */
+    template<class T_next>
+    inline promise_ptr<T_next> make_chained_promise() const {
+        auto next_promise = is_concurrent() ? 
+            make_concurrent<T_next>() : 
+            make_pending<T_next>();
+        next_promise->set_default_executor(get_executor());
+        next_promise->notify_chained(*this);
+        return next_promise;
+    }
+
+    /**
+     * @brief Returns the reject handler used by `then(on_resolve)`, which 
+     * propagates the rejection down the promise chain without rethrowing it.
+     * @tparam T_on_resolve The type of the resolve handler
+     */
+    template<class T_on_resolve>
+    static inline auto rethrow_handler() noexcept {
+        return rejection_forwarder<resolve_result_t<T, T_on_resolve>> {  };
+    }
+
+    /**
+     * @brief Returns the resolve handler used by `rescue()`, which passes the
+     * resolved value down the promise chain.
+     */
+    static inline auto passthrough_handler() noexcept {
+        return value_passthrough {  };
+    }
+
+    /**
+     * @brief Invokes the appropriate handler for the current state and settles
+     * the chained promise accordingly.
+     * @tparam T_on_resolve The type of the resolve handler
+     * @tparam T_on_reject The type of the reject handler
+     * @tparam T_next_promise The type of the chained promise
+     * @param on_resolve The resolve handler
+     * @param on_reject The reject handler
+     * @param next_promise The chained promise
+     */
+    template<class T_on_resolve, class T_on_reject, class T_next_promise>
+    void settle_chained(
+        T_on_resolve &on_resolve, 
+        T_on_reject &on_reject, 
+        T_next_promise &next_promise
+    ) {
+        if(!next_promise->is_pending()) {
+            return;
+        }
+
+        if constexpr(forwards_rejection_v<T_on_reject>) {
+            if(is_rejected()) {
+                next_promise->reject(stored_error);
+                return;
+            }
+        }
+
+        try {
+            if(is_resolved()) {
+                handle_resolve(on_resolve, next_promise);
+            } else if(is_rejected()) {
+                handle_reject(on_reject, next_promise);
+            }
+        } catch(...) {
+            next_promise->reject(std::current_exception());
+        }
+    }
+
     /**
      * @brief Asserts that a particular callable type is suitable to be invoked
      * when the promise is resolved.
@@ -395,7 +1198,8 @@ private:
 
     /**
      * @brief Handles promise resolution, calling the resolve handler and 
-     * resolving the chained promise.
+     * resolving the chained promise. A passed through value is moved on when 
+     * nothing else can read it.
      * @tparam T_on_resolve The type of the resolve handler
      * @tparam T_next_promise The type of the chained promise
      * @param on_resolve The resolve handler to be invoked
@@ -406,24 +1210,30 @@ private:
         if constexpr(is_void) {
             if constexpr(resolves_void_v<T, T_on_resolve>) {
                 on_resolve();
-                next_promise->resolve();
+                settle_access::resolve_owned(next_promise);
             }
             if constexpr(resolves_value_v<T, T_on_resolve>) {
-                next_promise->resolve(on_resolve());
+                settle_access::resolve_owned(next_promise, on_resolve());
             }
             if constexpr(resolves_promise_v<T, T_on_resolve>) {
                 on_resolve()->pipe(next_promise);
             }
+        } else if constexpr(passes_value_through_v<T_on_resolve>) {
+            if(is_unobserved()) {
+                settle_access::resolve_owned(next_promise, std::move(get_value()));
+            } else {
+                settle_access::resolve_owned(next_promise, get_value());
+            }
         } else {
             if constexpr(resolves_void_v<T, T_on_resolve>) {
-                on_resolve(std::get<T>(value));
-                next_promise->resolve();
+                on_resolve(get_value());
+                settle_access::resolve_owned(next_promise);
             }
             if constexpr(resolves_value_v<T, T_on_resolve>) {
-                next_promise->resolve(on_resolve(std::get<T>(value)));
+                settle_access::resolve_owned(next_promise, on_resolve(get_value()));
             }
             if constexpr(resolves_promise_v<T, T_on_resolve>) {
-                on_resolve(std::get<T>(value))->pipe(next_promise);
+                on_resolve(get_value())->pipe(next_promise);
             }
 
         }
@@ -440,15 +1250,15 @@ private:
     template<class T_on_reject, class T_next_promise>
     void handle_reject(T_on_reject &&on_reject, T_next_promise &next_promise) {
         if constexpr(rejects_void_v<T_on_reject>) {
-            on_reject(std::get<std::exception_ptr>(value));
-            next_promise->resolve();
+            on_reject(stored_error);
+            settle_access::resolve_owned(next_promise);
         }
         if constexpr(rejects_value_v<T_on_reject>) {
-            auto &rejected_value = std::get<std::exception_ptr>(value);
-            next_promise->resolve(on_reject(rejected_value));
+            auto &rejected_value = stored_error;
+            settle_access::resolve_owned(next_promise, on_reject(rejected_value));
         }
         if constexpr(rejects_promise_v<T_on_reject>) {
-            auto &rejected_value = std::get<std::exception_ptr>(value);
+            auto &rejected_value = stored_error;
             on_reject(rejected_value)->pipe(next_promise);
 
         }
@@ -474,7 +1284,8 @@ private:
     
     /**
      * @brief Pipes a promise into another: when the current promise is settled,
-     * the next will be too with the same state and value.
+     * the next will be too with the same state and value. Cancelling the 
+     * target promise cancels this one.
      * @tparam T_next_promise The target promise type
      * @param next_promise the The target promise
      */
@@ -482,15 +1293,68 @@ private:
     inline void pipe(T_next_promise &&next_promise) {
         if constexpr(is_void) {
             then(
-                [=] { next_promise->resolve(); },
-                [=] (auto &error) { next_promise->reject(std::move(error)); }
+                [=] { 
+                    if(next_promise->is_pending()) {
+                        next_promise->resolve(); 
+                    }
+                },
+                [=] (auto &error) { 
+                    if(next_promise->is_pending()) {
+                        next_promise->reject(std::move(error)); 
+                    }
+                }
             );
         } else {
             then(
-                [=] (auto &value) { next_promise->resolve(std::move(value)); },
-                [=] (auto &error) { next_promise->reject(std::move(error)); }
+                [=] (auto &value) { 
+                    if(next_promise->is_pending()) {
+                        next_promise->resolve(std::move(value)); 
+                    }
+                },
+                [=] (auto &error) { 
+                    if(next_promise->is_pending()) {
+                        next_promise->reject(std::move(error)); 
+                    }
+                }
             );
         }
+        link_downstream(*next_promise);
+        next_promise->notify_chained(*this);
+    }
+
+    /**
+     * @brief Returns whether the promise holds its resolved value.
+     */
+    inline bool has_value() const noexcept {
+        return is_resolved() && !is_consumed();
+    }
+
+protected:
+    /**
+     * @brief Wraps a producer's cancel callback into the handler run by
+     * `cancel()`. Once the callback returns, the promise is rejected with a 
+     * `juro::cancellation_error`, unless the callback settled it already.
+     * @tparam T_on_cancel The type of the callback
+     * @param on_cancel The callback to be wrapped
+     */
+    template<class T_on_cancel>
+    static inline cancel_handler cancellation(T_on_cancel &&on_cancel) {
+        return [
+            on_cancel = std::forward<T_on_cancel>(on_cancel)
+        ] (promise_interface &cancelled) mutable {
+            auto &target = static_cast<promise &>(cancelled);
+            const auto guard = target.self();
+            try {
+                on_cancel();
+                if(target.is_pending()) {
+                    target.reject(cancellation_error { "Promise was cancelled" });
+                }
+            } catch(const promise_error &) {
+                if(target.is_pending()) {
+                    throw;
+                }
+            }
+        };
     }
     
 #ifdef JURO_TEST
@@ -499,27 +1363,160 @@ public:
      * @brief Helper function to determine if this promise holds a determinate 
      * value type.
      * @tparam T_value The type being evaluated.
-     * @return Whether the promise's value container holds a value of type 
-     * `T_value` or not.
+     * @return Whether the promise's storage holds a value of type `T_value`
+     * or not.
      */
     template<class T_value>
     inline bool holds_value() const noexcept { 
-        return std::holds_alternative<T_value>(value); 
+        if constexpr(std::is_same_v<T_value, value_type>) {
+            return has_value();
+        } else if constexpr(std::is_same_v<T_value, std::exception_ptr>) {
+            return is_rejected();
+        } else if constexpr(std::is_same_v<T_value, empty_type>) {
+            return is_empty();
+        } else {
+            return false;
+        }
     }
 
     /**
      * @brief Helper function to determine if this promise holds no meaningful 
-     * value, i.e., an `empty_type`.
-     * @return Whether this promise's value container holds a value of type
-     * `empty_type` or not.
+     * value, i.e., it is pending or its value was consumed.
+     * @return Whether this promise's storage is empty or not.
      */
     inline bool is_empty() const noexcept {
-        return std::holds_alternative<empty_type>(value);
+        return is_pending() || is_consumed();
     }
 
 #endif /* JURO_TEST */
 };
 
+#ifdef JURO_INTRUSIVE_PTR
+/**
+ * @brief A promise that was allocated by a custom allocator and that returns
+ * its memory to it once the last reference is dropped.
+ * @warning This should not be used directly; use the allocator-aware promise
+ * factories instead.
+ * @tparam T The type of the promised value
+ * @tparam T_allocator The type of the allocator
+ */
+template<class T, class T_allocator>
+class allocated_promise final : public promise<T> {
+    using allocator_type = typename std::allocator_traits<T_allocator>::
+        template rebind_alloc<allocated_promise>;
+    using allocator_traits = std::allocator_traits<allocator_type>;
+
+    /**
+     * @brief The allocator that owns this promise's memory.
+     */
+    allocator_type allocator;
+
+public:
+    template<class ...T_args>
+    allocated_promise(const allocator_type &allocator, T_args &&...args) :
+        promise<T> { std::forward<T_args>(args)... },
+        allocator { allocator }
+        {  }
+
+    /**
+     * @brief Allocates and constructs a new promise.
+     * @tparam ...T_args The types of the promise constructor arguments
+     * @param allocator The allocator with which to allocate the promise
+     * @param ...args The promise constructor arguments
+     * @return The newly created promise
+     */
+    template<class ...T_args>
+    static promise_ptr<T> create(const T_allocator &allocator, T_args &&...args) {
+        allocator_type rebound { allocator };
+        auto *memory = allocator_traits::allocate(rebound, 1);
+        try {
+            ::new(static_cast<void *>(memory)) 
+                allocated_promise { rebound, std::forward<T_args>(args)... };
+        } catch(...) {
+            allocator_traits::deallocate(rebound, memory, 1);
+            throw;
+        }
+        return promise_ptr<T> { memory };
+    }
+
+protected:
+    void destroy() noexcept override {
+        allocator_type owner { std::move(allocator) };
+        this->~allocated_promise();
+        allocator_traits::deallocate(owner, this, 1);
+    }
+};
+#endif /* JURO_INTRUSIVE_PTR */
+
+/**
+ * @brief Resolves every promise in a range with the matching value of another
+ * range, in a single `juro::settle_batch`: every promise is resolved before 
+ * any continuation runs.
+ * @tparam T_iterator The type of the promises' iterators; must be an input 
+ * iterator over `promise_ptr<T>`s
+ * @tparam T_value_iterator The type of the values' iterators; values are
+ * copied unless the iterator is a `std::move_iterator`
+ * @param dispatcher The executor running the continuations as a single task
+ * @param first The beginning of the promises
+ * @param last The end of the promises
+ * @param values The beginning of the values, at least as many as promises
+ */
+template<class T_iterator, class T_value_iterator>
+void resolve_all(
+    executor &dispatcher, 
+    T_iterator first, 
+    T_iterator last, 
+    T_value_iterator values
+) {
+    settle_batch batch { dispatcher };
+    for(; first != last; ++first, ++values) {
+        (*first)->resolve(*values);
+    }
+    batch.close();
+}
+
+/**
+ * @brief Resolves every promise in a range with the matching value of another
+ * range, then runs their continuations on the calling thread in one pass.
+ * @see `juro::resolve_all(executor &, T_iterator, T_iterator, T_value_iterator)`
+ */
+template<class T_iterator, class T_value_iterator>
+void resolve_all(T_iterator first, T_iterator last, T_value_iterator values) {
+    settle_batch batch;
+    for(; first != last; ++first, ++values) {
+        (*first)->resolve(*values);
+    }
+    batch.close();
+}
+
 } /* namespace juro */
 
-#endif /* JURO_PROMISE_HPP */
\ No newline at end of file
+/**
+ * @brief Declares that `juro::promise<T>` is explicitly instantiated in some
+ * other translation unit, which must then use `JURO_INSTANTIATE_PROMISE(T)`:
+ * the members of the class are compiled and emitted once, instead of in every
+ * translation unit using them. It expands to nothing in header-only builds.
+ * @param T The type of the promised value
+ */
+#ifdef JURO_HEADER_ONLY
+#define JURO_EXTERN_PROMISE(T)
+#else
+#define JURO_EXTERN_PROMISE(T) extern template class juro::promise<T>
+#endif /* JURO_HEADER_ONLY */
+
+/**
+ * @brief Explicitly instantiates `juro::promise<T>`, the counterpart of
+ * `JURO_EXTERN_PROMISE(T)`. It must appear in a single translation unit.
+ * @param T The type of the promised value
+ */
+#define JURO_INSTANTIATE_PROMISE(T) template class juro::promise<T>
+
+/* libjuro instantiates the most common promise types. */
+JURO_EXTERN_PROMISE(void);
+JURO_EXTERN_PROMISE(int);
+
+#ifdef JURO_HEADER_ONLY
+#include "juro/impl/promise.ipp"
+#endif /* JURO_HEADER_ONLY */
+
+#endif /* JURO_PROMISE_HPP */
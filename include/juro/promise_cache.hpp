@@ -0,0 +1,216 @@
+/**
+ * @file juro/promise_cache.hpp
+ * @brief Contains promise caches, which memoize asynchronous lookups by key
+ * and deduplicate the lookups still in flight.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_PROMISE_CACHE_HPP
+#define JURO_PROMISE_CACHE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include "juro/helpers.hpp"
+#include "juro/promise.hpp"
+#include "juro/shared_promise.hpp"
+
+namespace juro {
+
+/**
+ * @brief Memoizes the promises returned by a loader, keyed by request.
+ * @details The first lookup of a key invokes the loader and shares the
+ * promise it returns; every other lookup of that key, whether the promise is
+ * still pending or already resolved, receives the same shared promise, so
+ * each key is loaded once and its value is stored once for every waiter.
+ * Entries are dropped when they are rejected, when they were loaded more than
+ * the time-to-live ago and have settled, or when they are the least recently
+ * used and the cache is full. Dropped entries are never served again, but
+ * waiters holding them are unaffected; a pending entry dropped for room will
+ * be loaded anew by the next lookup.
+ * @warning Promise caches are not synchronised; like shared promises, they
+ * must be used on the thread settling the loaded promises.
+ * @tparam K The type of the keys
+ * @tparam V The type of the loaded values
+ * @tparam T_hash The hasher of the keys
+ * @tparam T_equal The equality comparator of the keys
+ */
+template<
+    class K,
+    class V,
+    class T_hash = std::hash<K>,
+    class T_equal = std::equal_to<K>
+>
+class promise_cache {
+public:
+    using clock = std::chrono::steady_clock;
+    using key_type = K;
+    using value_type = V;
+
+private:
+    /**
+     * @brief The keys, from the most to the least recently used, pointing into
+     * the entries, whose addresses are stable.
+     */
+    using order_type = std::list<const K *>;
+
+    struct entry {
+        shared_promise_ptr<V> shared;
+        clock::time_point loaded;
+        typename order_type::iterator position;
+    };
+
+    using entries_type = std::unordered_map<K, entry, T_hash, T_equal>;
+
+    entries_type entries;
+    order_type order;
+    std::size_t capacity;
+    clock::duration time_to_live;
+
+public:
+    /**
+     * @brief Creates an empty cache.
+     * @param capacity The amount of entries kept before the least recently
+     * used is dropped; a cache without capacity keeps nothing.
+     * @param time_to_live For how long after its load began a settled entry
+     * is served. Pending entries never expire.
+     */
+    explicit promise_cache(
+        std::size_t capacity,
+        clock::duration time_to_live = clock::duration::max()
+    ) :
+        capacity { capacity },
+        time_to_live { time_to_live }
+    {  }
+
+    promise_cache(const promise_cache &) = delete;
+    promise_cache &operator=(const promise_cache &) = delete;
+
+    /**
+     * @brief Returns the shared promise of a key, invoking the loader only if
+     * no usable entry is cached.
+     * @tparam T_loader The type of the loader; should receive a `const K &`
+     * and return a `juro::promise_ptr<V>`.
+     * @param key The key to look up
+     * @param loader The functor starting the load of the key
+     * @param now The current time, against which entries expire
+     * @return A `juro::shared_promise_ptr<V>`, which can be listened to by
+     * any amount of waiters or forked into an ordinary promise.
+     */
+    template<class T_loader>
+    shared_promise_ptr<V> get(const K &key, T_loader &&loader, clock::time_point now = clock::now()) {
+        static_assert(
+            std::is_same_v<std::invoke_result_t<T_loader &, const K &>, promise_ptr<V>>,
+            "Loader must return a `juro::promise_ptr<V>`."
+        );
+
+        if(auto cached = find(key, now)) {
+            return cached;
+        }
+
+        auto shared = std::invoke(loader, key)->share();
+
+        // The loader may have cached the key itself, through a reentrant
+        // lookup; the newest load wins.
+        erase(key);
+        if(capacity == 0 || shared->is_rejected()) {
+            return shared;
+        }
+
+        const auto inserted = entries.try_emplace(key, entry { shared, now, {  } }).first;
+        inserted->second.position = order.insert(order.begin(), &inserted->first);
+        while(entries.size() > capacity) {
+            drop(entries.find(*order.back()));
+        }
+        return shared;
+    }
+
+    /**
+     * @brief Returns the shared promise of a key if a usable entry is cached,
+     * marking it as the most recently used, or a null pointer otherwise.
+     * Unusable entries found are dropped.
+     * @param key The key to look up
+     * @param now The current time, against which entries expire
+     */
+    shared_promise_ptr<V> find(const K &key, clock::time_point now = clock::now()) {
+        const auto found = entries.find(key);
+        if(found == entries.end()) {
+            return nullptr;
+        }
+
+        auto &cached = found->second;
+        if(!is_usable(cached, now)) {
+            drop(found);
+            return nullptr;
+        }
+
+        order.splice(order.begin(), order, cached.position);
+        return cached.shared;
+    }
+
+    /**
+     * @brief Drops the entry of a key, if any.
+     * @return Whether an entry was dropped.
+     */
+    bool erase(const K &key) {
+        const auto found = entries.find(key);
+        if(found == entries.end()) {
+            return false;
+        }
+
+        drop(found);
+        return true;
+    }
+
+    /**
+     * @brief Drops every rejected and expired entry, which lookups would only
+     * drop when they come across them.
+     * @param now The current time, against which entries expire
+     * @return The amount of entries dropped.
+     */
+    std::size_t purge(clock::time_point now = clock::now()) {
+        std::size_t dropped = 0;
+        for(auto current = entries.begin(); current != entries.end();) {
+            const auto next = std::next(current);
+            if(!is_usable(current->second, now)) {
+                drop(current);
+                dropped++;
+            }
+            current = next;
+        }
+        return dropped;
+    }
+
+    /**
+     * @brief Drops every entry.
+     */
+    void clear() noexcept {
+        order.clear();
+        entries.clear();
+    }
+
+    inline std::size_t size() const noexcept { return entries.size(); }
+    inline bool empty() const noexcept { return entries.empty(); }
+    inline std::size_t get_capacity() const noexcept { return capacity; }
+    inline clock::duration get_time_to_live() const noexcept { return time_to_live; }
+
+private:
+    inline bool is_usable(const entry &cached, clock::time_point now) const noexcept {
+        const auto &shared = *cached.shared;
+        return shared.is_pending() ||
+            (shared.is_resolved() && now - cached.loaded < time_to_live);
+    }
+
+    void drop(typename entries_type::iterator found) noexcept {
+        order.erase(found->second.position);
+        entries.erase(found);
+    }
+};
+
+} /* namespace juro */
+
+#endif /* JURO_PROMISE_CACHE_HPP */
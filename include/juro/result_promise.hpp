@@ -0,0 +1,812 @@
+/**
+ * @file juro/result_promise.hpp
+ * @brief Contains result promises, which reject with a value of an error type
+ * instead of a `std::exception_ptr`, and their compositions.
+ * @details Nothing in this header throws, catches or rethrows, so it may be
+ * used in translation units built with `-fno-exceptions`.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_RESULT_PROMISE_HPP
+#define JURO_RESULT_PROMISE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "juro/helpers.hpp"
+#include "juro/function.hpp"
+#include "juro/intrusive_ptr.hpp"
+
+namespace juro::results {
+
+using namespace juro::helpers;
+
+template<class T, class E>
+class result_promise;
+
+/**
+ * @brief An intrusive pointer to a `result_promise<T, E>`.
+ * @tparam T The type of the promised value
+ * @tparam E The type of the rejection reason
+ */
+template<class T, class E>
+using result_promise_ptr = intrusive_ptr<result_promise<T, E>>;
+
+/**
+ * @brief Type trait to detect if a type is a `result_promise_ptr`.
+ * @tparam T The type to inspect
+ */
+template<class T>
+struct is_result_promise : public std::false_type {  };
+
+template<class T, class E>
+struct is_result_promise<result_promise_ptr<T, E>> : public std::true_type {  };
+
+template<class T>
+static constexpr inline bool is_result_promise_v = is_result_promise<T>::value;
+
+/**
+ * @brief Maps the type returned by a handler to the value type of the promise
+ * it settles: handlers returning a `result_promise_ptr<T, E>` settle it with
+ * the returned promise's outcome, every other handler resolves it with what
+ * it returns.
+ * @tparam T The type returned by the handler
+ */
+template<class T>
+struct result_value { using type = T; };
+
+template<class T, class E>
+struct result_value<result_promise_ptr<T, E>> { using type = T; };
+
+template<class T>
+using result_value_t = typename result_value<T>::type;
+
+namespace detail {
+
+/**
+ * @brief The handler standing for a missing resolve handler, which forwards
+ * the value to the chained promise.
+ */
+struct value_forwarder {  };
+
+/**
+ * @brief The handler standing for a missing reject handler, which forwards
+ * the error to the chained promise.
+ */
+struct error_forwarder {  };
+
+/**
+ * @brief The type returned by a handler invoked with `T_args`, or by a
+ * forwarder standing for it: `T_forwarded`.
+ */
+template<class T_forwarded, class T_handler, class ...T_args>
+struct handler_result { using type = std::invoke_result_t<T_handler &, T_args &...>; };
+
+template<class T_forwarded, class ...T_args>
+struct handler_result<T_forwarded, value_forwarder, T_args...> { using type = T_forwarded; };
+
+template<class T_forwarded, class ...T_args>
+struct handler_result<T_forwarded, error_forwarder, T_args...> { using type = T_forwarded; };
+
+/**
+ * @brief Whether a type returned by a handler may settle a result promise of
+ * error type `E`: it is not a result promise, or one with the same error type.
+ */
+template<class T, class E>
+static constexpr inline bool carries_error_v =
+    !is_result_promise_v<T> || std::is_same_v<T, result_promise_ptr<result_value_t<T>, E>>;
+
+/**
+ * @brief Grants compositions access to the internals of result promises.
+ */
+struct result_access {
+    template<class T, class E, class T_handler>
+    static inline void attach(result_promise<T, E> &target, T_handler &&handler) {
+        target.attach(std::forward<T_handler>(handler));
+    }
+
+    /**
+     * @brief Resolves a promise through a handle held by the library. If it
+     * is the only handle, nobody else can read the value, so whoever observes
+     * the settlement may move it out.
+     */
+    template<class T, class E, class ...T_values>
+    static inline void resolve_owned(
+        const result_promise_ptr<T, E> &target,
+        T_values &&...values
+    ) {
+        target->unobserved = target.use_count() == 1;
+        target->resolve(std::forward<T_values>(values)...);
+    }
+
+    /**
+     * @brief Rejects a promise through a handle held by the library; see
+     * `resolve_owned()`.
+     */
+    template<class T, class E, class T_error>
+    static inline void reject_owned(
+        const result_promise_ptr<T, E> &target,
+        T_error &&error
+    ) {
+        target->unobserved = target.use_count() == 1;
+        target->reject(std::forward<T_error>(error));
+    }
+
+    template<class T, class E>
+    static inline bool is_unobserved(const result_promise<T, E> &target) noexcept {
+        return target.unobserved;
+    }
+
+    /**
+     * @brief Settles a promise the library holds with the outcome of another
+     * one, moving out of it if nobody else can read it.
+     * @param target The promise to settle
+     * @param source The settled promise
+     * @param movable Whether the outcome of `source` may be moved out
+     */
+    template<class T, class E>
+    static void settle_from(
+        const result_promise_ptr<T, E> &target,
+        result_promise<T, E> &source,
+        bool movable
+    ) {
+        if(source.is_rejected()) {
+            if(movable) {
+                reject_owned(target, std::move(source.get_error()));
+            } else {
+                reject_owned(target, source.get_error());
+            }
+        } else if constexpr(std::is_void_v<T>) {
+            resolve_owned(target);
+        } else if(movable) {
+            resolve_owned(target, std::move(source.get_value()));
+        } else {
+            resolve_owned(target, source.get_value());
+        }
+    }
+
+    /**
+     * @brief Settles a chained promise with the outcome of a handler. If the
+     * handler returns a result promise, the chained promise follows it.
+     * @param next The chained promise
+     * @param handler The handler to invoke
+     * @param ...args The arguments of the handler
+     */
+    template<class T, class E, class T_handler, class ...T_args>
+    static void deliver(
+        const result_promise_ptr<T, E> &next,
+        T_handler &handler,
+        T_args &...args
+    ) {
+        using handler_type = std::invoke_result_t<T_handler &, T_args &...>;
+
+        if constexpr(std::is_void_v<handler_type>) {
+            std::invoke(handler, args...);
+            resolve_owned(next);
+        } else if constexpr(is_result_promise_v<handler_type>) {
+            follow(next, std::invoke(handler, args...));
+        } else {
+            resolve_owned(next, std::invoke(handler, args...));
+        }
+    }
+
+    /**
+     * @brief Settles a chained promise with the outcome of a promise returned
+     * by a handler, once it is settled. The returned promise is kept alive by
+     * its own settle handler until then.
+     */
+    template<class T, class E>
+    static void follow(
+        const result_promise_ptr<T, E> &next,
+        result_promise_ptr<T, E> &&followed
+    ) {
+        if(followed->is_settled()) {
+            settle_from(next, *followed, followed.use_count() == 1);
+            return;
+        }
+
+        auto &target = *followed;
+        target.attach([next, followed = std::move(followed)] {
+            settle_from(next, *followed, followed.use_count() == 1);
+        });
+    }
+};
+
+} /* namespace detail */
+
+/**
+ * @brief A promise whose rejection reason is a value of type `E`, e.g. a
+ * `std::error_code`, instead of a `std::exception_ptr`.
+ * @details Rejections are stored in the promise like values are and handed
+ * to reject handlers as `E &`; nothing is thrown or rethrown as they travel
+ * down a chain. Handlers resolve the chained promise with what they return,
+ * or settle it like the `result_promise_ptr<U, E>` they return, which is how
+ * a handler rejects. Unlike `promise<T>`, exceptions thrown by handlers are
+ * not turned into rejections but propagate out of the call settling the
+ * promise, and a rejection nobody handles is simply kept in the promise.
+ * @warning Result promises are not synchronised; they must be settled and
+ * listened to on the same thread.
+ * @tparam T The type of the promised value
+ * @tparam E The type of the rejection reason
+ */
+template<class T, class E>
+class result_promise : public ref_counted_object<result_promise<T, E>> {
+    friend struct detail::result_access;
+
+public:
+    static constexpr inline bool is_void = std::is_void_v<T>;
+
+    using type = T;
+    using error_type = E;
+    using value_type = storage_type<T>;
+    using settle_type = std::variant<empty_type, value_type, E>;
+
+private:
+    settle_type value;
+
+    /**
+     * @brief Type-erased callback to be executed once the promise is settled.
+     * It is destroyed as soon as it has run, releasing whatever it captured.
+     */
+    unique_function<void()> on_settle;
+
+    /**
+     * @brief Whether the library settled the promise through the only handle
+     * to it, so that its outcome may be moved out.
+     */
+    bool unobserved = false;
+
+public:
+    inline promise_state get_state() const noexcept {
+        return static_cast<promise_state>(value.index());
+    }
+
+    inline bool is_pending() const noexcept { return value.index() == 0; }
+    inline bool is_resolved() const noexcept { return value.index() == 1; }
+    inline bool is_rejected() const noexcept { return value.index() == 2; }
+    inline bool is_settled() const noexcept { return !is_pending(); }
+
+    /**
+     * @brief Returns the resolved value; the promise must be resolved.
+     */
+    inline value_type &get_value() noexcept { return *std::get_if<1>(&value); }
+    inline const value_type &get_value() const noexcept { return *std::get_if<1>(&value); }
+
+    /**
+     * @brief Returns the rejection reason; the promise must be rejected.
+     */
+    inline E &get_error() noexcept { return *std::get_if<2>(&value); }
+    inline const E &get_error() const noexcept { return *std::get_if<2>(&value); }
+
+    /**
+     * @brief Resolves the promise and runs its settle handler, if any.
+     * @tparam ...T_values The types of the arguments
+     * @param ...values The arguments the value is constructed from
+     * @return Whether the promise was pending; settled promises are left
+     * untouched.
+     */
+    template<class ...T_values>
+    bool resolve(T_values &&...values) {
+        if(!is_pending()) {
+            return false;
+        }
+        value.template emplace<1>(std::forward<T_values>(values)...);
+        settled();
+        return true;
+    }
+
+    /**
+     * @brief Rejects the promise and runs its settle handler, if any.
+     * @tparam T_error The type of the rejection reason
+     * @param error The rejection reason
+     * @return Whether the promise was pending; settled promises are left
+     * untouched.
+     */
+    template<class T_error>
+    bool reject(T_error &&error) {
+        if(!is_pending()) {
+            return false;
+        }
+        value.template emplace<2>(std::forward<T_error>(error));
+        settled();
+        return true;
+    }
+
+    /**
+     * @brief Attaches a settle handler to the promise, overwriting any
+     * previously attached one.
+     * @tparam T_on_resolve The type of the resolve handler; receives a
+     * `T &`, or nothing if `T` is `void`.
+     * @tparam T_on_reject The type of the reject handler; receives an `E &`
+     * and must return the same type as the resolve handler.
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @param on_reject The functor to be invoked when the promise is rejected.
+     * @return A `result_promise_ptr<U, E>`, where `U` is the type returned by
+     * the handlers or, if they return a `result_promise_ptr<U, E>`, its
+     * value type.
+     */
+    template<class T_on_resolve, class T_on_reject>
+    auto then(T_on_resolve &&on_resolve, T_on_reject &&on_reject) {
+        return chain(
+            std::forward<T_on_resolve>(on_resolve),
+            std::forward<T_on_reject>(on_reject)
+        );
+    }
+
+    /**
+     * @brief Attaches a resolve handler to the promise; rejections are
+     * forwarded to the chained promise.
+     * @tparam T_on_resolve The type of the resolve handler
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @return A `result_promise_ptr<U, E>`; see `then(on_resolve, on_reject)`.
+     */
+    template<class T_on_resolve>
+    inline auto then(T_on_resolve &&on_resolve) {
+        return chain(std::forward<T_on_resolve>(on_resolve), detail::error_forwarder {  });
+    }
+
+    /**
+     * @brief Attaches a reject handler to the promise; values are forwarded to
+     * the chained promise.
+     * @tparam T_on_reject The type of the reject handler; receives an `E &`
+     * and must return a `T`, or a `result_promise_ptr<T, E>`.
+     * @param on_reject The functor to be invoked when the promise is rejected.
+     * @return A `result_promise_ptr<T, E>`.
+     */
+    template<class T_on_reject>
+    inline auto rescue(T_on_reject &&on_reject) {
+        return chain(detail::value_forwarder {  }, std::forward<T_on_reject>(on_reject));
+    }
+
+private:
+    using resolve_arguments = std::conditional_t<is_void, std::tuple<>, std::tuple<value_type>>;
+
+    template<class T_forwarded, class T_handler, class T_arguments>
+    struct resolve_result;
+
+    template<class T_forwarded, class T_handler, class ...T_args>
+    struct resolve_result<T_forwarded, T_handler, std::tuple<T_args...>> {
+        using type = typename detail::handler_result<T_forwarded, T_handler, T_args...>::type;
+    };
+
+    template<class T_on_resolve, class T_on_reject>
+    auto chain(T_on_resolve &&on_resolve, T_on_reject &&on_reject) {
+        using resolve_type = bare_t<T_on_resolve>;
+        using reject_type = bare_t<T_on_reject>;
+        using resolve_handler_type =
+            typename resolve_result<T, resolve_type, resolve_arguments>::type;
+        using next_value_type = result_value_t<std::conditional_t<
+            std::is_same_v<resolve_type, detail::value_forwarder>,
+            typename detail::handler_result<T, reject_type, E>::type,
+            resolve_handler_type
+        >>;
+        using reject_handler_type =
+            typename detail::handler_result<next_value_type, reject_type, E>::type;
+
+        static_assert(
+            std::is_same_v<result_value_t<resolve_handler_type>, next_value_type> &&
+            std::is_same_v<result_value_t<reject_handler_type>, next_value_type>,
+            "Resolve and reject handlers must settle the same type."
+        );
+        static_assert(
+            detail::carries_error_v<resolve_handler_type, E> &&
+            detail::carries_error_v<reject_handler_type, E>,
+            "Handlers must return result promises of the same error type."
+        );
+
+        auto next = result_promise_ptr<next_value_type, E> {
+            new result_promise<next_value_type, E> {  }
+        };
+        attach([
+            this,
+            next,
+            on_resolve = std::forward<T_on_resolve>(on_resolve),
+            on_reject = std::forward<T_on_reject>(on_reject)
+        ] () mutable {
+            settle_chained(on_resolve, on_reject, next);
+        });
+        return next;
+    }
+
+    template<class T_on_resolve, class T_on_reject, class T_next>
+    void settle_chained(T_on_resolve &on_resolve, T_on_reject &on_reject, const T_next &next) {
+        using access = detail::result_access;
+
+        if(is_resolved()) {
+            if constexpr(std::is_same_v<T_on_resolve, detail::value_forwarder>) {
+                if constexpr(is_void) {
+                    access::resolve_owned(next);
+                } else if(unobserved) {
+                    access::resolve_owned(next, std::move(get_value()));
+                } else {
+                    access::resolve_owned(next, get_value());
+                }
+            } else if constexpr(is_void) {
+                access::deliver(next, on_resolve);
+            } else {
+                access::deliver(next, on_resolve, get_value());
+            }
+        } else if constexpr(std::is_same_v<T_on_reject, detail::error_forwarder>) {
+            if(unobserved) {
+                access::reject_owned(next, std::move(get_error()));
+            } else {
+                access::reject_owned(next, get_error());
+            }
+        } else {
+            access::deliver(next, on_reject, get_error());
+        }
+    }
+
+    /**
+     * @brief Stores a settle handler, or runs it at once if the promise is
+     * already settled.
+     */
+    template<class T_handler>
+    void attach(T_handler &&handler) {
+        if(is_settled()) {
+            std::invoke(handler);
+            return;
+        }
+        on_settle = std::forward<T_handler>(handler);
+    }
+
+    void settled() {
+        if(on_settle) {
+            // The handler is destroyed as soon as it returns, releasing what
+            // it captured.
+            auto handler = std::move(on_settle);
+            handler();
+        }
+    }
+};
+
+/**
+ * @brief Creates a pending result promise.
+ * @tparam T The type of the promised value
+ * @tparam E The type of the rejection reason
+ * @return A `result_promise_ptr<T, E>`.
+ */
+template<class T, class E>
+inline result_promise_ptr<T, E> make_pending_result() {
+    return result_promise_ptr<T, E> { new result_promise<T, E> {  } };
+}
+
+/**
+ * @brief Creates a resolved result promise.
+ * @tparam E The type of the rejection reason
+ * @tparam T_value The type of the value
+ * @param value The value
+ * @return A `result_promise_ptr<std::decay_t<T_value>, E>`.
+ */
+template<class E, class T_value>
+inline auto make_resolved_result(T_value &&value) {
+    auto promise = make_pending_result<std::decay_t<T_value>, E>();
+    promise->resolve(std::forward<T_value>(value));
+    return promise;
+}
+
+/**
+ * @brief Creates a resolved void result promise.
+ * @tparam E The type of the rejection reason
+ * @return A `result_promise_ptr<void, E>`.
+ */
+template<class E>
+inline auto make_resolved_result() {
+    auto promise = make_pending_result<void, E>();
+    promise->resolve();
+    return promise;
+}
+
+/**
+ * @brief Creates a rejected result promise.
+ * @tparam T The type of the promised value
+ * @tparam T_error The type of the rejection reason
+ * @param error The rejection reason
+ * @return A `result_promise_ptr<T, std::decay_t<T_error>>`.
+ */
+template<class T, class T_error>
+inline auto make_rejected_result(T_error &&error) {
+    auto promise = make_pending_result<T, std::decay_t<T_error>>();
+    promise->reject(std::forward<T_error>(error));
+    return promise;
+}
+
+namespace detail {
+
+/**
+ * @brief Stores a child's value into a slot, moving it out if nobody else
+ * can read it.
+ */
+template<class T_slot, class T, class E>
+inline void transfer_result(T_slot &slot, result_promise<T, E> &child) {
+    if(result_access::is_unobserved(child)) {
+        slot.emplace(std::move(child.get_value()));
+    } else {
+        slot.emplace(child.get_value());
+    }
+}
+
+/**
+ * @brief Coordinates an `all()` call over result promises.
+ * @details Each child's value is stored into an optional slot as it resolves;
+ * the first rejection settles the composed promise, which is then released
+ * so that later children are ignored.
+ * @tparam T_result The type the composed promise resolves with
+ * @tparam E The type of the rejection reason
+ * @tparam T_slots The type holding the children's values: a tuple of
+ * optional values, a vector of them or, for void results, an empty tuple
+ */
+template<class T_result, class E, class T_slots>
+class result_all_coordinator :
+    public ref_counted_object<result_all_coordinator<T_result, E, T_slots>> {
+    T_slots slots;
+    std::size_t remaining;
+    result_promise_ptr<T_result, E> promise;
+
+public:
+    template<class ...T_args>
+    result_all_coordinator(
+        const result_promise_ptr<T_result, E> &promise,
+        std::size_t count,
+        T_args &&...args
+    ) :
+        slots(std::forward<T_args>(args)...),
+        remaining { count },
+        promise { promise }
+    {  }
+
+    template<std::size_t Index, class T>
+    void attach(result_promise<T, E> &child) {
+        result_access::attach(child, [&child, guard = intrusive_ptr { this }] {
+            if(guard->reject_from(child)) {
+                return;
+            }
+            if constexpr(!std::is_void_v<T_result>) {
+                transfer_result(std::get<Index>(guard->slots), child);
+            }
+            guard->complete();
+        });
+    }
+
+    template<class T>
+    void attach(result_promise<T, E> &child, std::size_t index) {
+        result_access::attach(child, [&child, index, guard = intrusive_ptr { this }] {
+            if(guard->reject_from(child)) {
+                return;
+            }
+            if constexpr(!std::is_void_v<T_result>) {
+                transfer_result(guard->slots[index], child);
+            }
+            guard->complete();
+        });
+    }
+
+private:
+    /**
+     * @brief Rejects the composed promise if the child is rejected.
+     * @return Whether the child must be ignored: it was rejected or the
+     * composed promise is already settled.
+     */
+    template<class T>
+    bool reject_from(result_promise<T, E> &child) {
+        if(!promise) {
+            return true;
+        }
+        if(!child.is_rejected()) {
+            return false;
+        }
+
+        const auto settled = std::move(promise);
+        if(result_access::is_unobserved(child)) {
+            result_access::reject_owned(settled, std::move(child.get_error()));
+        } else {
+            result_access::reject_owned(settled, child.get_error());
+        }
+        return true;
+    }
+
+    void complete() {
+        if(--remaining > 0) {
+            return;
+        }
+
+        const auto settled = std::move(promise);
+        if constexpr(std::is_void_v<T_result>) {
+            result_access::resolve_owned(settled);
+        } else {
+            result_access::resolve_owned(settled, collect(slots));
+        }
+    }
+
+    template<class ...T_values>
+    static T_result collect(std::tuple<std::optional<T_values>...> &values) {
+        return std::apply([] (auto &...value) {
+            return T_result { std::move(*value)... };
+        }, values);
+    }
+
+    template<class T>
+    static T_result collect(std::vector<std::optional<T>> &values) {
+        T_result result;
+        result.reserve(values.size());
+        for(auto &value : values) {
+            result.push_back(std::move(*value));
+        }
+        return result;
+    }
+};
+
+template<class E, class ...T_values, std::size_t ...Indices>
+auto all_of(
+    std::index_sequence<Indices...>,
+    const result_promise_ptr<T_values, E> &...children
+) {
+    constexpr bool all_void = std::conjunction_v<std::is_void<T_values>...>;
+    using result_type = std::conditional_t<
+        all_void,
+        void,
+        std::tuple<storage_type<T_values>...>
+    >;
+    using slots_type = std::conditional_t<
+        all_void,
+        std::tuple<>,
+        std::tuple<std::optional<storage_type<T_values>>...>
+    >;
+    using coordinator_type = result_all_coordinator<result_type, E, slots_type>;
+
+    auto promise = make_pending_result<result_type, E>();
+    auto coordinator = intrusive_ptr {
+        new coordinator_type { promise, sizeof...(T_values) }
+    };
+    (coordinator->template attach<Indices>(*children), ...);
+    return promise;
+}
+
+/**
+ * @brief Coordinates a `race()` call over result promises: the first child to
+ * settle settles the composed promise, which is then released.
+ */
+template<class T, class E>
+class result_race_coordinator : public ref_counted_object<result_race_coordinator<T, E>> {
+    result_promise_ptr<T, E> promise;
+
+public:
+    result_race_coordinator(const result_promise_ptr<T, E> &promise) :
+        promise { promise }
+    {  }
+
+    void attach(result_promise<T, E> &child) {
+        result_access::attach(child, [&child, guard = intrusive_ptr { this }] {
+            if(!guard->promise) {
+                return;
+            }
+            const auto settled = std::move(guard->promise);
+            result_access::settle_from(settled, child, result_access::is_unobserved(child));
+        });
+    }
+};
+
+} /* namespace detail */
+
+/**
+ * @brief Creates a result promise that resolves once every supplied result
+ * promise is resolved, or rejects with the first rejection reason. Like every
+ * composition, it takes over the children's settle handlers.
+ * @tparam E The type of the rejection reason, shared by every child
+ * @tparam T_first The value type of the first child
+ * @tparam ...T_values The value types of the other children
+ * @return A `result_promise_ptr<std::tuple<...>, E>` holding the children's
+ * values or, if every child is void, a `result_promise_ptr<void, E>`.
+ */
+template<class E, class T_first, class ...T_values>
+inline auto all(
+    const result_promise_ptr<T_first, E> &first,
+    const result_promise_ptr<T_values, E> &...others
+) {
+    return detail::all_of<E>(
+        std::index_sequence_for<T_first, T_values...> {  },
+        first,
+        others...
+    );
+}
+
+/**
+ * @brief Creates a result promise that resolves once every result promise in
+ * a vector is resolved, or rejects with the first rejection reason.
+ * @tparam T The value type of the children
+ * @tparam E The type of the rejection reason
+ * @param promises The promises to compose
+ * @return A `result_promise_ptr<std::vector<T>, E>` holding the values in
+ * order or, if `T` is `void`, a `result_promise_ptr<void, E>`.
+ */
+template<class T, class E>
+auto all(const std::vector<result_promise_ptr<T, E>> &promises) {
+    constexpr bool is_void = std::is_void_v<T>;
+    using result_type = std::conditional_t<is_void, void, std::vector<T>>;
+    using slots_type = std::conditional_t<
+        is_void,
+        std::tuple<>,
+        std::vector<std::optional<storage_type<T>>>
+    >;
+    using coordinator_type = detail::result_all_coordinator<result_type, E, slots_type>;
+
+    auto promise = make_pending_result<result_type, E>();
+    if(promises.empty()) {
+        promise->resolve();
+        return promise;
+    }
+
+    auto coordinator = [&] {
+        if constexpr(is_void) {
+            return intrusive_ptr { new coordinator_type { promise, promises.size() } };
+        } else {
+            return intrusive_ptr {
+                new coordinator_type { promise, promises.size(), promises.size() }
+            };
+        }
+    }();
+    for(std::size_t index = 0; index < promises.size(); index++) {
+        coordinator->attach(*promises[index], index);
+    }
+    return promise;
+}
+
+/**
+ * @brief Creates a result promise that settles as soon as any supplied result
+ * promise is settled, in the same way. Like every composition, it takes over
+ * the children's settle handlers.
+ * @tparam T The value type, shared by every child
+ * @tparam E The type of the rejection reason, shared by every child
+ * @return A `result_promise_ptr<T, E>`.
+ */
+template<class T, class E, class ...T_others>
+auto race(const result_promise_ptr<T, E> &first, const T_others &...others) {
+    static_assert(
+        std::conjunction_v<std::is_same<T_others, result_promise_ptr<T, E>>...>,
+        "Raced result promises must share their value and error types."
+    );
+
+    auto promise = make_pending_result<T, E>();
+    auto coordinator = intrusive_ptr {
+        new detail::result_race_coordinator<T, E> { promise }
+    };
+    coordinator->attach(*first);
+    (coordinator->attach(*others), ...);
+    return promise;
+}
+
+/**
+ * @brief Creates a result promise that settles as soon as any result promise
+ * in a vector is settled, in the same way. If the vector is empty, the
+ * returned promise never settles.
+ * @tparam T The value type of the children
+ * @tparam E The type of the rejection reason
+ * @param promises The promises to compose
+ * @return A `result_promise_ptr<T, E>`.
+ */
+template<class T, class E>
+auto race(const std::vector<result_promise_ptr<T, E>> &promises) {
+    auto promise = make_pending_result<T, E>();
+    auto coordinator = intrusive_ptr {
+        new detail::result_race_coordinator<T, E> { promise }
+    };
+    for(const auto &child : promises) {
+        coordinator->attach(*child);
+    }
+    return promise;
+}
+
+} /* namespace juro::results */
+
+namespace juro {
+
+using namespace juro::results;
+
+} /* namespace juro */
+
+#endif /* JURO_RESULT_PROMISE_HPP */
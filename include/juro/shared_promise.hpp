@@ -0,0 +1,232 @@
+/**
+ * @file juro/shared_promise.hpp
+ * @brief Contains shared promises, which broadcast the outcome of a promise to
+ * any amount of listeners.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_SHARED_PROMISE_HPP
+#define JURO_SHARED_PROMISE_HPP
+
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "juro/helpers.hpp"
+#include "juro/function.hpp"
+#include "juro/factories.hpp"
+#include "juro/promise.hpp"
+
+namespace juro {
+
+template<class T>
+class shared_promise;
+
+/**
+ * @brief An intrusive pointer to a `shared_promise<T>`.
+ * @tparam T The type of the shared value
+ */
+template<class T>
+using shared_promise_ptr = intrusive_ptr<shared_promise<T>>;
+
+/**
+ * @brief A read-only view of a promise's outcome that accepts any amount of
+ * listeners.
+ * @details The outcome is stored once, in the shared promise, and every
+ * listener receives a `const` reference to it. Listeners are not chained
+ * promises: they are plain callables kept in a small buffer that holds the
+ * first few of them inline. Listeners attached after settlement run
+ * immediately.
+ * @warning Shared promises are not synchronised; they can only be created from
+ * ordinary promises and must be listened to on the thread settling them.
+ * @tparam T The type of the shared value
+ */
+template<class T>
+class shared_promise : public ref_counted_object<shared_promise<T>> {
+public:
+    static constexpr inline bool is_void = std::is_void_v<T>;
+
+    using type = T;
+    using value_type = storage_type<T>;
+    using settle_type =
+        std::variant<empty_type, value_type, std::exception_ptr>;
+
+private:
+    using listener = unique_function<void(const shared_promise &)>;
+
+    /**
+     * @brief The amount of listeners stored without dynamic allocation.
+     */
+    static constexpr std::size_t inline_listeners = 2;
+
+    settle_type value;
+    std::array<listener, inline_listeners> local_listeners;
+    std::vector<listener> extra_listeners;
+    std::size_t listener_count = 0;
+
+public:
+    /**
+     * @brief Creates a shared promise that takes over the settle handler of a
+     * promise.
+     * @warning This should not be called directly; use `promise<T>::share()`
+     * instead.
+     * @param source The promise to share
+     * @return The newly created shared promise.
+     */
+    static shared_promise_ptr<T> create(promise<T> &source) {
+        if(source.is_concurrent()) {
+            throw promise_error { "Concurrent promises cannot be shared" };
+        }
+
+        shared_promise_ptr<T> shared { new shared_promise {  } };
+        settle_access::attach(source, [&source, shared] { shared->settle(source); });
+        return shared;
+    }
+
+    inline promise_state get_state() const noexcept {
+        return static_cast<promise_state>(value.index());
+    }
+
+    inline bool is_pending() const noexcept { return value.index() == 0; }
+    inline bool is_resolved() const noexcept { return value.index() == 1; }
+    inline bool is_rejected() const noexcept { return value.index() == 2; }
+    inline bool is_settled() const noexcept { return !is_pending(); }
+
+    /**
+     * @brief Returns the shared value. If the promise is not resolved, will
+     * propagate a `std::bad_variant_access` exception.
+     */
+    inline const value_type &get_value() const { return std::get<1>(value); }
+
+    /**
+     * @brief Returns the shared rejection reason. If the promise is not
+     * rejected, will propagate a `std::bad_variant_access` exception.
+     */
+    inline const std::exception_ptr &get_error() const { return std::get<2>(value); }
+
+    /**
+     * @brief Adds a listener. Unlike `promise<T>::then()`, no promise is
+     * chained and previously added listeners are kept.
+     * @tparam T_on_resolve The type of the resolve handler; should receive a
+     * `const T &`, or nothing if `T` is `void`.
+     * @tparam T_on_reject The type of the reject handler; should receive a
+     * `const std::exception_ptr &`.
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     * @param on_reject The functor to be invoked when the promise is rejected.
+     */
+    template<class T_on_resolve, class T_on_reject>
+    void then(T_on_resolve &&on_resolve, T_on_reject &&on_reject) {
+        static_assert(
+            (is_void && std::is_invocable_v<T_on_resolve &>) ||
+            std::is_invocable_v<T_on_resolve &, const value_type &>,
+            "Resolve handler has an incompatible signature."
+        );
+        static_assert(
+            std::is_invocable_v<T_on_reject &, const std::exception_ptr &>,
+            "Reject handler has an incompatible signature."
+        );
+
+        listen([
+            on_resolve = std::forward<T_on_resolve>(on_resolve),
+            on_reject = std::forward<T_on_reject>(on_reject)
+        ] (const shared_promise &shared) mutable {
+            if(shared.is_rejected()) {
+                on_reject(shared.get_error());
+            } else if constexpr(is_void) {
+                on_resolve();
+            } else {
+                on_resolve(shared.get_value());
+            }
+        });
+    }
+
+    /**
+     * @brief Adds a listener that is only invoked if the promise is resolved.
+     * @tparam T_on_resolve The type of the resolve handler
+     * @param on_resolve The functor to be invoked when the promise is resolved.
+     */
+    template<class T_on_resolve>
+    inline void then(T_on_resolve &&on_resolve) {
+        then(std::forward<T_on_resolve>(on_resolve), [] (const std::exception_ptr &) {  });
+    }
+
+    /**
+     * @brief Creates an ordinary promise that settles like this one, with a
+     * copy of the shared value, for consumers that need to chain further.
+     * @return A `promise_ptr<T>`.
+     */
+    promise_ptr<T> fork() {
+        auto forked = make_pending<T>();
+        then(
+            [forked] (auto &...shared_value) { forked->resolve(shared_value...); },
+            [forked] (const std::exception_ptr &error) {
+                try {
+                    forked->reject(error);
+                } catch(const promise_error &) {  }
+            }
+        );
+        return forked;
+    }
+
+private:
+    shared_promise() = default;
+
+    void listen(listener &&added) {
+        if(is_settled()) {
+            added(*this);
+            return;
+        }
+
+        if(listener_count < inline_listeners) {
+            local_listeners[listener_count] = std::move(added);
+        } else {
+            extra_listeners.push_back(std::move(added));
+        }
+        listener_count++;
+    }
+
+    /**
+     * @brief Stores the outcome of the shared promise and broadcasts it to the
+     * listeners. Every listener runs even if another one throws; the first
+     * exception is rethrown afterwards.
+     * @param source The settled shared promise
+     */
+    void settle(promise<T> &source) {
+        if(source.is_rejected()) {
+            value.template emplace<2>(source.get_error());
+        } else if(settle_access::is_unobserved(source)) {
+            value.template emplace<1>(std::move(source.get_value()));
+        } else {
+            value.template emplace<1>(source.get_value());
+        }
+
+        const auto guard = intrusive_ptr { this };
+        std::exception_ptr failure;
+        for(std::size_t index = 0; index < listener_count; index++) {
+            auto &current = index < inline_listeners ?
+                local_listeners[index] :
+                extra_listeners[index - inline_listeners];
+            try {
+                current(*this);
+            } catch(...) {
+                if(!failure) {
+                    failure = std::current_exception();
+                }
+            }
+            current = nullptr;
+        }
+        listener_count = 0;
+        extra_listeners.clear();
+
+        if(failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+};
+
+} /* namespace juro */
+
+#endif /* JURO_SHARED_PROMISE_HPP */
@@ -0,0 +1,505 @@
+/**
+ * @file juro/stream.hpp
+ * @brief Contains asynchronous streams, which deliver a sequence of values
+ * one promise at a time through a bounded buffer, and their combinators.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_STREAM_HPP
+#define JURO_STREAM_HPP
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "juro/helpers.hpp"
+#include "juro/factories.hpp"
+#include "juro/promise.hpp"
+
+namespace juro::streams {
+
+using namespace juro::helpers;
+using namespace juro::factories;
+
+template<class T>
+class stream;
+
+/**
+ * @brief An intrusive pointer to a `stream<T>`.
+ * @tparam T The type of the streamed values
+ */
+template<class T>
+using stream_ptr = intrusive_ptr<stream<T>>;
+
+/**
+ * @brief An asynchronous sequence of values flowing from a producer to a
+ * consumer through a bounded buffer.
+ * @details The consumer reads values one at a time with `next()`, which
+ * returns a promise of the next value, or of `std::nullopt` once the stream
+ * is closed and drained. The producer writes with `push()`, whose promise is
+ * resolved as soon as the value fits in the buffer: a producer that awaits
+ * it before pushing again never gets more than `capacity` values ahead of
+ * the consumer. A stream with no capacity hands every value straight from
+ * the producer to a waiting consumer.
+ * @warning Streams are not synchronised; push and read on the thread settling
+ * the promises involved. Only one `next()` may be pending at a time. A stream
+ * read by a combinator must eventually be closed or failed, and the stream
+ * the combinator returns drained, for both to be released.
+ * @tparam T The type of the streamed values
+ */
+template<class T>
+class stream : public ref_counted_object<stream<T>> {
+    static_assert(!std::is_void_v<T>, "Streams of void are not supported.");
+
+public:
+    using type = T;
+    using item_type = std::optional<T>;
+
+private:
+    /**
+     * @brief A value pushed while the buffer was full, along with the promise
+     * its producer awaits.
+     */
+    struct blocked_write {
+        T value;
+        promise_ptr<void> written;
+    };
+
+    std::deque<T> buffer;
+    std::deque<blocked_write> blocked;
+    promise_ptr<item_type> reader;
+    std::exception_ptr error;
+    std::size_t capacity;
+    bool closed = false;
+
+public:
+    /**
+     * @brief Creates an empty stream.
+     * @warning This should not be called directly; use `juro::make_stream()`
+     * instead.
+     * @param capacity The amount of values buffered before `push()` waits
+     * @return The newly created stream.
+     */
+    static stream_ptr<T> create(std::size_t capacity) {
+        return stream_ptr<T> { new stream { capacity } };
+    }
+
+    inline std::size_t size() const noexcept { return buffer.size(); }
+    inline bool empty() const noexcept { return buffer.empty() && blocked.empty(); }
+    inline std::size_t get_capacity() const noexcept { return capacity; }
+
+    /**
+     * @brief Returns whether the producer finished the stream, by closing or
+     * failing it. Values still buffered may be read nonetheless.
+     */
+    inline bool is_closed() const noexcept { return closed; }
+
+    /**
+     * @brief Writes a value to the stream.
+     * @tparam T_value The type of the value; must be convertible to `T`.
+     * @param value The value to write
+     * @return A `promise_ptr<void>` resolved once the value was handed to the
+     * consumer or buffered; it is already resolved unless the buffer is full.
+     */
+    template<class T_value>
+    promise_ptr<void> push(T_value &&value) {
+        static_assert(
+            std::is_convertible_v<T_value, T>,
+            "Pushed value is not convertible to stream type"
+        );
+
+        if(closed) {
+            throw promise_error { "Attempted to push into a closed stream" };
+        }
+
+        if(reader != nullptr) {
+            const auto waiting = std::move(reader);
+            waiting->resolve(item_type(std::forward<T_value>(value)));
+            return make_resolved();
+        }
+
+        if(buffer.size() < capacity) {
+            buffer.emplace_back(std::forward<T_value>(value));
+            return make_resolved();
+        }
+
+        auto written = make_pending<void>();
+        blocked.push_back(blocked_write { T(std::forward<T_value>(value)), written });
+        return written;
+    }
+
+    /**
+     * @brief Finishes the stream: once every written value is read, `next()`
+     * yields `std::nullopt`. Closing a closed stream does nothing.
+     */
+    void close() {
+        if(closed) {
+            return;
+        }
+
+        closed = true;
+        if(reader != nullptr) {
+            const auto waiting = std::move(reader);
+            waiting->resolve(std::nullopt);
+        }
+    }
+
+    /**
+     * @brief Finishes the stream with an error: once every written value is
+     * read, `next()` is rejected with it. Finishing a closed stream does
+     * nothing.
+     * @tparam T_value The type of the rejection reason
+     * @param rejected_value The rejection reason. If it is not an
+     * `std::exception_ptr`, it will be stored into one.
+     */
+    template<class T_value = promise_error>
+    void fail(T_value &&rejected_value = promise_error { "Stream failed" }) {
+        if(closed) {
+            return;
+        }
+
+        using bare_type = std::remove_cv_t<std::remove_reference_t<T_value>>;
+        if constexpr(std::is_same_v<bare_type, std::exception_ptr>) {
+            error = std::forward<T_value>(rejected_value);
+        } else {
+            error = std::make_exception_ptr(std::forward<T_value>(rejected_value));
+        }
+
+        closed = true;
+        if(reader != nullptr) {
+            const auto waiting = std::move(reader);
+            try {
+                waiting->reject(error);
+            } catch(const promise_error &) {  }
+        }
+    }
+
+    /**
+     * @brief Reads the next value of the stream. Reading makes room in the
+     * buffer, which resolves the oldest blocked `push()`, if any.
+     * @return A `promise_ptr<std::optional<T>>`, already settled if a value
+     * was available or the stream is finished and drained.
+     */
+    promise_ptr<item_type> next() {
+        if(reader != nullptr) {
+            throw promise_error { "Attempted to read a stream already being read" };
+        }
+
+        if(!buffer.empty()) {
+            auto value = std::move(buffer.front());
+            buffer.pop_front();
+            admit();
+            return make_resolved<item_type>(std::move(value));
+        }
+
+        if(!blocked.empty()) {
+            auto write = std::move(blocked.front());
+            blocked.pop_front();
+            write.written->resolve();
+            return make_resolved<item_type>(std::move(write.value));
+        }
+
+        if(error) {
+            return make_rejected<item_type>(error);
+        }
+
+        if(closed) {
+            return make_resolved<item_type>(std::nullopt);
+        }
+
+        reader = make_pending<item_type>();
+        return reader;
+    }
+
+private:
+    explicit stream(std::size_t capacity) noexcept : capacity { capacity } {  }
+
+    /**
+     * @brief Moves the oldest blocked value into the buffer, if there is room,
+     * and resolves the promise its producer awaits.
+     */
+    void admit() {
+        if(blocked.empty() || buffer.size() >= capacity) {
+            return;
+        }
+
+        auto write = std::move(blocked.front());
+        blocked.pop_front();
+        buffer.push_back(std::move(write.value));
+        write.written->resolve();
+    }
+};
+
+/**
+ * @brief Creates an empty stream.
+ * @tparam T The type of the streamed values
+ * @param capacity The amount of values buffered before `push()` waits
+ * @return A `stream_ptr<T>`.
+ */
+template<class T>
+inline stream_ptr<T> make_stream(std::size_t capacity = 1) {
+    return stream<T>::create(capacity);
+}
+
+/**
+ * @brief Reads a stream and feeds its items to a step, which writes whatever
+ * it derives from them into a target stream. The pump reads on while the
+ * step's writes complete right away and suspends on whichever promise is
+ * pending otherwise, so buffered values are processed in a loop rather than
+ * down a chain of nested handlers.
+ * @warning This should not be used directly; use the stream combinators.
+ * @tparam T The type of the source stream
+ * @tparam T_target The type of the target stream
+ * @tparam T_step The type of the step; receives an `std::optional<T> &`,
+ * empty at the end of the source, and the target stream, and returns the
+ * `promise_ptr<void>` of its last write.
+ */
+template<class T, class T_target, class T_step>
+class stream_pump {
+    stream_ptr<T> source;
+    stream_ptr<T_target> target;
+    T_step step;
+
+public:
+    stream_pump(stream_ptr<T> source, stream_ptr<T_target> target, T_step &&step) :
+        source { std::move(source) },
+        target { std::move(target) },
+        step { std::move(step) }
+        {  }
+
+    /**
+     * @brief Pumps items until one of the promises involved is pending or
+     * the source is finished.
+     */
+    void run() {
+        for(;;) {
+            auto item = source->next();
+            if(item->is_pending()) {
+                auto &awaited = *item;
+                settle_access::attach(awaited, [&awaited, pump = std::move(*this)] () mutable {
+                    if(pump.feed(awaited)) {
+                        pump.run();
+                    }
+                });
+                return;
+            }
+
+            if(!feed(*item)) {
+                return;
+            }
+        }
+    }
+
+private:
+    /**
+     * @brief Hands a settled item to the step.
+     * @param item The settled item
+     * @return Whether the pump may read on right away; if not, it either
+     * finished or moved into the handler of a pending write.
+     */
+    bool feed(promise<std::optional<T>> &item) {
+        if(item.is_rejected()) {
+            target->fail(item.get_error());
+            return false;
+        }
+
+        auto &value = item.get_value();
+        promise_ptr<void> written;
+        try {
+            written = step(value, *target);
+        } catch(...) {
+            target->fail(std::current_exception());
+            return false;
+        }
+
+        if(!value.has_value()) {
+            if(written->is_pending()) {
+                settle_access::attach(*written, [target = std::move(target)] { target->close(); });
+            } else {
+                target->close();
+            }
+            return false;
+        }
+
+        if(written->is_pending()) {
+            settle_access::attach(*written, [pump = std::move(*this)] () mutable { pump.run(); });
+            return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Starts pumping a stream into a new one through a step.
+ * @tparam T_target The type of the target stream
+ * @tparam T The type of the source stream
+ * @tparam T_step The type of the step
+ * @param source The stream to read
+ * @param capacity The capacity of the target stream
+ * @param step The step
+ * @return The target stream.
+ */
+template<class T_target, class T, class T_step>
+stream_ptr<T_target> transform(
+    const stream_ptr<T> &source,
+    std::size_t capacity,
+    T_step &&step
+) {
+    auto target = make_stream<T_target>(capacity);
+    stream_pump<T, T_target, std::decay_t<T_step>> {
+        source,
+        target,
+        std::decay_t<T_step>(std::forward<T_step>(step))
+    }.run();
+    return target;
+}
+
+/**
+ * @brief Creates a stream of the values of another one passed through a
+ * function. The source is read ahead only as far as the new stream's buffer
+ * allows.
+ * @tparam T The type of the source stream
+ * @tparam T_mapper The type of the function; receives a `T &`.
+ * @param source The stream to read
+ * @param mapper The function to apply to each value
+ * @return A stream of the returned values, with the capacity of the source.
+ * An exception thrown by the function fails it.
+ */
+template<class T, class T_mapper>
+auto map(const stream_ptr<T> &source, T_mapper &&mapper) {
+    static_assert(
+        std::is_invocable_v<T_mapper &, T &>,
+        "Mapping function has an incompatible signature."
+    );
+    using mapped_type = std::decay_t<std::invoke_result_t<T_mapper &, T &>>;
+
+    return transform<mapped_type>(
+        source,
+        source->get_capacity(),
+        [mapper = std::forward<T_mapper>(mapper)] (
+            std::optional<T> &value,
+            stream<mapped_type> &target
+        ) mutable {
+            return value.has_value() ? target.push(mapper(*value)) : make_resolved();
+        }
+    );
+}
+
+/**
+ * @brief Creates a stream of the values of another one that satisfy a
+ * predicate.
+ * @tparam T The type of the source stream
+ * @tparam T_predicate The type of the predicate; receives a `const T &`.
+ * @param source The stream to read
+ * @param predicate The predicate values must satisfy to be kept
+ * @return A stream of the kept values, with the capacity of the source.
+ */
+template<class T, class T_predicate>
+auto filter(const stream_ptr<T> &source, T_predicate &&predicate) {
+    static_assert(
+        std::is_invocable_r_v<bool, T_predicate &, const T &>,
+        "Predicate has an incompatible signature."
+    );
+
+    return transform<T>(
+        source,
+        source->get_capacity(),
+        [predicate = std::forward<T_predicate>(predicate)] (
+            std::optional<T> &value,
+            stream<T> &target
+        ) mutable {
+            if(value.has_value() && predicate(std::as_const(*value))) {
+                return target.push(std::move(*value));
+            }
+            return make_resolved();
+        }
+    );
+}
+
+/**
+ * @brief Creates a stream of the values of another one grouped in vectors of
+ * a given size; the last vector holds whatever is left when the source is
+ * closed, if anything.
+ * @tparam T The type of the source stream
+ * @param source The stream to read
+ * @param size The amount of values in every vector but the last; must not be
+ * zero.
+ * @return A `stream_ptr<std::vector<T>>` with a single slot of buffer, so at
+ * most two vectors are alive at a time. If the source fails, the incomplete
+ * vector is dropped.
+ */
+template<class T>
+auto batch(const stream_ptr<T> &source, std::size_t size) {
+    if(size == 0) {
+        throw promise_error { "Batches must not be empty" };
+    }
+
+    return transform<std::vector<T>>(
+        source,
+        1,
+        [size, pending = std::vector<T> {  }] (
+            std::optional<T> &value,
+            stream<std::vector<T>> &target
+        ) mutable {
+            if(value.has_value()) {
+                if(pending.empty()) {
+                    pending.reserve(size);
+                }
+                pending.push_back(std::move(*value));
+            }
+
+            if(pending.size() == size || (!value.has_value() && !pending.empty())) {
+                return target.push(std::exchange(pending, std::vector<T> {  }));
+            }
+            return make_resolved();
+        }
+    );
+}
+
+/**
+ * @brief Reads a stream to its end, invoking a function with every value.
+ * @tparam T The type of the stream
+ * @tparam T_consumer The type of the function; receives a `T &`.
+ * @param source The stream to read
+ * @param consumer The function to invoke with each value
+ * @return A `promise_ptr<void>` resolved once the stream was drained, or
+ * rejected if it failed or the function threw.
+ */
+template<class T, class T_consumer>
+promise_ptr<void> for_each(const stream_ptr<T> &source, T_consumer &&consumer) {
+    static_assert(
+        std::is_invocable_v<T_consumer &, T &>,
+        "Consumer has an incompatible signature."
+    );
+
+    // The values are drained into a stream nobody reads, which only tells
+    // how the source ended.
+    auto sink = transform<void_type>(
+        source,
+        0,
+        [consumer = std::forward<T_consumer>(consumer)] (
+            std::optional<T> &value,
+            stream<void_type> &
+        ) mutable {
+            if(value.has_value()) {
+                consumer(*value);
+            }
+            return make_resolved();
+        }
+    );
+
+    return sink->next()->then([] (std::optional<void_type> &) {  });
+}
+
+} /* namespace juro::streams */
+
+namespace juro {
+
+using namespace juro::streams;
+
+} /* namespace juro */
+
+#endif /* JURO_STREAM_HPP */
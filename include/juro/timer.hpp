@@ -0,0 +1,620 @@
+/**
+ * @file juro/timer.hpp
+ * @brief Contains a hierarchical timer wheel and the promise factories and
+ * combinators built on top of it.
+ * @author André Medeiros
+*/
+
+#ifndef JURO_TIMER_HPP
+#define JURO_TIMER_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include "juro/config.hpp"
+#include "juro/allocation.hpp"
+#include "juro/executor.hpp"
+#include "juro/promise.hpp"
+
+namespace juro::timers {
+
+using namespace juro::helpers;
+using namespace juro::allocation;
+using namespace juro::executors;
+
+class timer_wheel;
+
+/**
+ * @brief The rejection reason of a promise whose deadline passed before it
+ * was settled.
+ */
+struct timeout_error : promise_error {
+    using promise_error::promise_error;
+};
+
+/**
+ * @brief An intrusive timer: objects that must be told when a deadline passes
+ * derive from it, so arming and disarming a timer never allocates.
+ * @details Armed nodes are linked into one of the wheel's slots; a node
+ * destroyed while armed unlinks itself.
+ */
+class timer_node {
+    friend class timer_wheel;
+
+    timer_node *next = nullptr;
+    timer_node **previous = nullptr;
+    timer_wheel *wheel = nullptr;
+    std::uint64_t expiry = 0;
+
+protected:
+    timer_node() noexcept = default;
+    timer_node(const timer_node &) = delete;
+    ~timer_node() noexcept { disarm(); }
+
+    timer_node &operator=(const timer_node &) = delete;
+
+    /**
+     * @brief Invoked by `timer_wheel::advance()` once the deadline passed.
+     * The node is already disarmed and may be armed again.
+     */
+    virtual void expired() noexcept = 0;
+
+    /**
+     * @brief Invoked when the wheel is destroyed while the node is armed. The
+     * node is already disarmed.
+     */
+    virtual void discarded() noexcept {  }
+
+public:
+    /**
+     * @brief Returns whether the node is armed in a wheel.
+     */
+    inline bool is_armed() const noexcept { return previous != nullptr; }
+
+    /**
+     * @brief Removes the node from its wheel, if armed.
+     */
+    void disarm() noexcept;
+};
+
+/**
+ * @brief A hierarchical timer wheel.
+ * @details Time is divided into ticks of a fixed resolution. Timers expiring
+ * within the next 64 ticks sit in the innermost wheel; farther timers sit in
+ * one of three coarser wheels, each 64 times coarser than the previous one,
+ * and cascade inwards as time goes by. Arming and disarming a timer is O(1).
+ * Timers fire from `advance()`, which the owner calls periodically, e.g. once
+ * per event loop tick. A timer never fires before its deadline and fires on
+ * the first `advance()` of a tick past it.
+ * @warning This class is not synchronised; arm timers and advance the wheel
+ * on the same thread.
+ */
+class timer_wheel {
+public:
+    using clock = std::chrono::steady_clock;
+
+private:
+    static constexpr std::size_t level_bits = 6;
+    static constexpr std::size_t slot_count = std::size_t { 1 } << level_bits;
+    static constexpr std::size_t level_count = 4;
+
+    std::array<std::array<timer_node *, slot_count>, level_count> slots {  };
+    clock::time_point origin;
+    clock::duration resolution;
+    std::uint64_t current = 0;
+    std::size_t armed = 0;
+    executor *dispatcher;
+
+public:
+    /**
+     * @brief Creates an empty wheel.
+     * @param resolution The duration of a tick
+     * @param dispatcher The default executor of the promises created by the
+     * timer factories, if any; it must outlive them.
+     */
+    explicit timer_wheel(
+        clock::duration resolution = std::chrono::milliseconds { 1 },
+        executor *dispatcher = nullptr
+    ) noexcept;
+
+    timer_wheel(const timer_wheel &) = delete;
+    timer_wheel(timer_wheel &&) = delete;
+
+    /**
+     * @brief Disarms every timer still armed.
+     */
+    ~timer_wheel();
+
+    timer_wheel &operator=(const timer_wheel &) = delete;
+    timer_wheel &operator=(timer_wheel &&) = delete;
+
+    /**
+     * @brief Arms a timer, disarming it first if it was armed already.
+     * @param node The timer to arm
+     * @param deadline The point in time after which the timer fires
+     */
+    void arm(timer_node &node, clock::time_point deadline) noexcept;
+
+    /**
+     * @brief Fires every timer whose deadline passed by the supplied time.
+     * @param now The current time
+     * @return The amount of timers fired.
+     */
+    std::size_t advance(clock::time_point now = clock::now());
+
+    inline std::size_t size() const noexcept { return armed; }
+    inline bool empty() const noexcept { return armed == 0; }
+    inline clock::duration get_resolution() const noexcept { return resolution; }
+    inline executor *get_executor() const noexcept { return dispatcher; }
+
+private:
+    friend class timer_node;
+
+    void insert(timer_node &node) noexcept;
+    void cascade(std::size_t level) noexcept;
+};
+
+/**
+ * @brief A promise that carries its own timer. While armed, the promise keeps
+ * itself alive, like any producer holding the promise it will settle; the 
+ * reference is dropped once the timer fires or the promise is cancelled.
+ * @tparam T The type of the promise
+ */
+template<class T>
+class timer_promise : public promise<T>, public timer_node {
+    promise_ptr<T> armed_self;
+
+public:
+    timer_promise() {
+        this->set_cancel_handler(this->cancellation([this] {
+            disarm();
+            armed_self = nullptr;
+        }));
+    }
+
+    /**
+     * @brief Arms the promise's timer.
+     * @param wheel The wheel driving the timer
+     * @param deadline The point in time after which the timer fires
+     */
+    void arm(timer_wheel &wheel, timer_wheel::clock::time_point deadline) {
+        wheel.arm(*this, deadline);
+        armed_self = this->self();
+    }
+
+protected:
+    /**
+     * @brief Drops the promise's reference to itself.
+     * @return The dropped reference, which keeps the promise alive until
+     * discarded.
+     */
+    inline promise_ptr<T> release_self() noexcept {
+        return std::move(armed_self);
+    }
+
+    void discarded() noexcept override {
+        armed_self = nullptr;
+    }
+};
+
+/**
+ * @brief A promise that is resolved when its timer fires.
+ * @warning This should not be used directly; use `juro::delay()` instead.
+ */
+class delay_promise final : public timer_promise<void> {
+protected:
+    void expired() noexcept override;
+};
+
+/**
+ * @brief A promise that follows another one unless a deadline passes first,
+ * in which case it is rejected with a `juro::timeout_error` and the followed
+ * promise is cancelled.
+ * @warning This should not be used directly; use `juro::with_deadline()` or
+ * `juro::timeout()` instead.
+ * @tparam T The type of the followed promise
+ */
+template<class T>
+class deadline_promise final : public timer_promise<T> {
+public:
+    /**
+     * @brief Settles this promise like the followed one, unless the deadline
+     * passed already.
+     * @param followed The settled promise being followed
+     */
+    void follow(promise<T> &followed) {
+        this->disarm();
+        const auto guard = this->release_self();
+        if(!this->is_pending()) {
+            return;
+        }
+
+        if(followed.is_rejected()) {
+            this->reject(followed.get_error());
+        } else if constexpr(std::is_void_v<T>) {
+            this->resolve();
+        } else if(settle_access::is_unobserved(followed)) {
+            this->resolve(std::move(followed.get_value()));
+        } else {
+            this->resolve(followed.get_value());
+        }
+    }
+
+protected:
+    void expired() noexcept override {
+        const auto guard = this->release_self();
+        try {
+            try {
+                this->reject(timeout_error { "Promise timed out" });
+            } catch(const promise_error &) {  }
+            this->cancel_upstream();
+        } catch(...) {  }
+    }
+};
+
+/**
+ * @brief How `juro::retry()` bounds and spaces its attempts.
+ */
+struct retry_policy {
+    /**
+     * @brief The maximum amount of attempts, the first one included.
+     */
+    std::size_t max_attempts = 3;
+
+    /**
+     * @brief The delay between the first and the second attempts.
+     */
+    timer_wheel::clock::duration initial_delay = std::chrono::milliseconds { 100 };
+
+    /**
+     * @brief The factor by which the delay grows after every further attempt.
+     */
+    double multiplier = 2.0;
+
+    /**
+     * @brief The delay is never longer than this.
+     */
+    timer_wheel::clock::duration max_delay = std::chrono::seconds { 30 };
+
+    /**
+     * @brief The fraction of every delay, within `[0, 1]`, of which a random
+     * part is cut, so that callers failing together do not retry together.
+     */
+    double jitter = 0.0;
+};
+
+/**
+ * @brief The default retry predicate of `juro::retry()`: every rejection but
+ * a cancellation is retried.
+ */
+struct retry_always {
+    inline bool operator()(const std::exception_ptr &) const noexcept { return true; }
+};
+
+/**
+ * @brief A promise that settles like the first successful attempt of a
+ * factory, or like the last one, waiting on its own timer between them.
+ * @details The factory, the predicate and the backoff state live in the
+ * promise itself, so retrying allocates nothing but the attempts; no promise
+ * is chained per attempt and the next attempt is made from the wheel rather
+ * than from the settle handler of the previous one. While an attempt is
+ * pending, cancelling this promise cancels the attempt, whose rejection is
+ * then not retried.
+ * @warning This should not be used directly; use `juro::retry()` instead.
+ * @tparam T The type of the attempts
+ * @tparam T_factory The type of the factory making the attempts
+ * @tparam T_predicate The type of the predicate telling retried rejections
+ */
+template<class T, class T_factory, class T_predicate>
+class retry_promise final : public timer_promise<T> {
+    using clock = timer_wheel::clock;
+
+    T_factory factory;
+    T_predicate should_retry;
+    retry_policy policy;
+    timer_wheel &wheel;
+    clock::duration backoff;
+    std::size_t attempts = 0;
+    std::minstd_rand random;
+
+public:
+    template<class T_factory_arg, class T_predicate_arg>
+    retry_promise(
+        timer_wheel &wheel,
+        const retry_policy &policy,
+        T_factory_arg &&factory,
+        T_predicate_arg &&should_retry
+    ) :
+        factory(std::forward<T_factory_arg>(factory)),
+        should_retry(std::forward<T_predicate_arg>(should_retry)),
+        policy { policy },
+        wheel { wheel },
+        backoff { std::min(policy.initial_delay, policy.max_delay) },
+        random {
+            static_cast<std::minstd_rand::result_type>(clock::now().time_since_epoch().count())
+        }
+    {  }
+
+    inline std::size_t get_attempts() const noexcept { return attempts; }
+
+    /**
+     * @brief Makes an attempt. Factories that throw or return concurrent
+     * promises count as rejected attempts.
+     */
+    void attempt() {
+        attempts++;
+
+        promise_ptr<T> child;
+        try {
+            child = std::invoke(factory);
+            if(child->is_concurrent()) {
+                throw promise_error { "Concurrent promises cannot be retried" };
+            }
+        } catch(...) {
+            fail(std::current_exception());
+            return;
+        }
+
+        auto &attempted = *child;
+        settle_access::attach(attempted, [this, &attempted, guard = this->self()] {
+            follow(attempted);
+        });
+        if(this->is_pending()) {
+            settle_access::link(attempted, *this);
+        }
+    }
+
+protected:
+    void expired() noexcept override {
+        const auto guard = this->release_self();
+        try {
+            attempt();
+        } catch(...) {  }
+    }
+
+private:
+    void follow(promise<T> &attempted) {
+        if(!this->is_pending()) {
+            return;
+        }
+
+        if(attempted.is_rejected()) {
+            fail(attempted.get_error());
+        } else if constexpr(std::is_void_v<T>) {
+            this->resolve();
+        } else if(settle_access::is_unobserved(attempted)) {
+            this->resolve(std::move(attempted.get_value()));
+        } else {
+            this->resolve(attempted.get_value());
+        }
+    }
+
+    void fail(std::exception_ptr error) {
+        if(
+            attempts >= policy.max_attempts ||
+            is_cancellation(error) ||
+            !std::invoke(should_retry, std::as_const(error))
+        ) {
+            this->reject(error);
+            return;
+        }
+
+        this->arm(wheel, clock::now() + next_delay());
+    }
+
+    /**
+     * @brief Returns the jittered delay before the next attempt and grows the
+     * one after it.
+     */
+    clock::duration next_delay() {
+        const auto jitter = std::clamp(policy.jitter, 0.0, 1.0);
+        const auto cut = std::uniform_real_distribution<double> { 0.0, jitter }(random);
+        const auto delay = std::chrono::duration_cast<clock::duration>(backoff * (1.0 - cut));
+
+        const auto grown = std::min(
+            static_cast<double>(backoff.count()) * policy.multiplier,
+            static_cast<double>(policy.max_delay.count())
+        );
+        backoff = clock::duration { static_cast<clock::rep>(grown) };
+        return delay;
+    }
+
+    static bool is_cancellation(const std::exception_ptr &error) noexcept {
+        try {
+            std::rethrow_exception(error);
+        } catch(const cancellation_error &) {
+            return true;
+        } catch(...) {
+            return false;
+        }
+    }
+};
+
+/**
+ * @brief Allocates a promise carrying a timer.
+ * @tparam T_promise The type of the promise
+ * @tparam ...T_args The types of the arguments of its constructor
+ * @param ...args The arguments of its constructor
+ * @return An owning pointer to the newly created promise
+ */
+template<class T_promise, class ...T_args>
+auto construct_timer(T_args &&...args) {
+#ifdef JURO_INTRUSIVE_PTR
+    return intrusive_ptr<T_promise> { new T_promise { std::forward<T_args>(args)... } };
+#else
+    return make_shared_object<T_promise>(std::forward<T_args>(args)...);
+#endif /* JURO_INTRUSIVE_PTR */
+}
+
+/**
+ * @brief Creates a promise that is resolved once the supplied duration
+ * elapses. The timer lives inside the promise, so no further allocation is
+ * made; cancelling the promise disarms it.
+ * @tparam T_rep The representation type of the duration
+ * @tparam T_period The period type of the duration
+ * @param wheel The wheel driving the timer
+ * @param duration The time to wait
+ * @return A `promise_ptr<void>`.
+ */
+template<class T_rep, class T_period>
+promise_ptr<void> delay(
+    timer_wheel &wheel,
+    std::chrono::duration<T_rep, T_period> duration
+) {
+    auto timer = construct_timer<delay_promise>();
+    if(auto *dispatcher = wheel.get_executor()) {
+        timer->via(*dispatcher);
+    }
+    timer->arm(wheel, timer_wheel::clock::now() + duration);
+    return timer;
+}
+
+/**
+ * @brief Creates a promise that settles like the supplied one, unless the
+ * deadline passes first: then it is rejected with a `juro::timeout_error` and
+ * the supplied promise is cancelled. The timer lives inside the returned
+ * promise and is disarmed as soon as the supplied promise settles.
+ * @warning The settle handler of the supplied promise is taken over, like by
+ * `then()`. Concurrent promises are not supported.
+ * @tparam T The type of the promise
+ * @param promise The promise to follow
+ * @param wheel The wheel driving the deadline
+ * @param deadline The point in time by which the promise must settle
+ * @return A `promise_ptr<T>`.
+ */
+template<class T>
+promise_ptr<T> with_deadline(
+    const promise_ptr<T> &promise,
+    timer_wheel &wheel,
+    timer_wheel::clock::time_point deadline
+) {
+    if(promise->is_concurrent()) {
+        throw promise_error { "Deadlines cannot be set on concurrent promises" };
+    }
+
+    auto timer = construct_timer<deadline_promise<T>>();
+    if(auto *dispatcher = promise->get_executor()) {
+        timer->via(*dispatcher);
+    } else if(auto *dispatcher = wheel.get_executor()) {
+        timer->via(*dispatcher);
+    }
+
+    auto &followed = *promise;
+    settle_access::attach(followed, [&followed, timer] { timer->follow(followed); });
+    if(timer->is_pending()) {
+        settle_access::link(followed, *timer);
+        timer->arm(wheel, deadline);
+    }
+    return timer;
+}
+
+/**
+ * @brief Creates a promise that settles like the supplied one, unless the
+ * supplied duration elapses first.
+ * @see `juro::with_deadline()`
+ * @tparam T The type of the promise
+ * @tparam T_rep The representation type of the duration
+ * @tparam T_period The period type of the duration
+ * @param promise The promise to follow
+ * @param wheel The wheel driving the deadline
+ * @param duration The time the promise has to settle
+ * @return A `promise_ptr<T>`.
+ */
+template<class T, class T_rep, class T_period>
+inline promise_ptr<T> timeout(
+    const promise_ptr<T> &promise,
+    timer_wheel &wheel,
+    std::chrono::duration<T_rep, T_period> duration
+) {
+    return with_deadline(promise, wheel, timer_wheel::clock::now() + duration);
+}
+
+/**
+ * @brief Creates a promise that settles like the first resolved attempt of a
+ * factory. Rejected attempts are retried after an exponentially growing
+ * delay, until the policy's attempts are exhausted or the predicate declines
+ * a rejection; the composed promise is then rejected like the last attempt.
+ * Cancellations are never retried.
+ * @details A single promise is allocated for all attempts and holds its own
+ * timer, so no chain grows and no recursion happens across attempts. The
+ * first attempt is made right away; further attempts are made by
+ * `timer_wheel::advance()`. If the first attempt fails for good right away,
+ * the returned promise is already rejected.
+ * @warning The wheel must outlive the returned promise's attempts. Attempts
+ * must not be concurrent promises.
+ * @tparam T_factory The type of the factory; should take no arguments and
+ * return a `juro::promise_ptr<T>`.
+ * @tparam T_predicate The type of the predicate; should receive a
+ * `const std::exception_ptr &` and return whether to retry.
+ * @param wheel The wheel driving the delays
+ * @param policy The bounds and spacing of the attempts
+ * @param factory The functor making an attempt
+ * @param should_retry The functor telling whether a rejection is retried
+ * @return A `promise_ptr<T>`.
+ */
+template<class T_factory, class T_predicate = retry_always>
+auto retry(
+    timer_wheel &wheel,
+    const retry_policy &policy,
+    T_factory &&factory,
+    T_predicate &&should_retry = T_predicate {  }
+) {
+    using attempt_type = std::invoke_result_t<std::decay_t<T_factory> &>;
+    static_assert(
+        is_promise_v<attempt_type>,
+        "Factory must return a `juro::promise_ptr<T>`."
+    );
+    static_assert(
+        std::is_invocable_r_v<bool, std::decay_t<T_predicate> &, const std::exception_ptr &>,
+        "Retry predicate has an incompatible signature."
+    );
+
+    using value_type = typename attempt_type::element_type::type;
+    using promise_type = retry_promise<
+        value_type,
+        std::decay_t<T_factory>,
+        std::decay_t<T_predicate>
+    >;
+
+    auto retried = construct_timer<promise_type>(
+        wheel,
+        policy,
+        std::forward<T_factory>(factory),
+        std::forward<T_predicate>(should_retry)
+    );
+    if(auto *dispatcher = wheel.get_executor()) {
+        retried->via(*dispatcher);
+    }
+
+    // Like a promise made by `make_rejected()`, a promise rejected before
+    // being returned is not an unhandled rejection.
+    try {
+        retried->attempt();
+    } catch(const promise_error &) {
+        if(!retried->is_rejected()) {
+            throw;
+        }
+    }
+    return promise_ptr<value_type> { std::move(retried) };
+}
+
+} /* namespace juro::timers */
+
+namespace juro {
+
+using namespace juro::timers;
+
+} /* namespace juro */
+
+#ifdef JURO_HEADER_ONLY
+#include "juro/impl/timer.ipp"
+#endif /* JURO_HEADER_ONLY */
+
+#endif /* JURO_TIMER_HPP */
@@ -0,0 +1 @@
+#include "juro/impl/instrumentation.ipp"
@@ -0,0 +1 @@
+#include "juro/impl/timer.ipp"
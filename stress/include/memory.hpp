@@ -0,0 +1,28 @@
+#ifndef JURO_STRESS_MEMORY_HPP
+#define JURO_STRESS_MEMORY_HPP
+
+#include <cstddef>
+
+namespace juro::stress {
+
+/**
+ * @brief Returns the amount of bytes currently allocated through the global
+ * `operator new`.
+ */
+std::size_t live_bytes() noexcept;
+
+/**
+ * @brief Returns the largest amount of bytes allocated at once through the
+ * global `operator new` since the last call to `reset_peak_bytes()`.
+ */
+std::size_t peak_bytes() noexcept;
+
+/**
+ * @brief Lowers the high-water mark reported by `peak_bytes()` to the bytes
+ * currently allocated.
+ */
+void reset_peak_bytes() noexcept;
+
+} /* namespace juro::stress */
+
+#endif /* JURO_STRESS_MEMORY_HPP */
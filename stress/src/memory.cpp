@@ -0,0 +1,64 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "memory.hpp"
+
+namespace {
+
+std::atomic<std::size_t> allocated { 0 };
+std::atomic<std::size_t> peak { 0 };
+
+/**
+ * @brief Every block is prefixed with its size, so that it can be discounted
+ * when freed. The prefix keeps blocks aligned as `operator new` must.
+ */
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+} /* anonymous namespace */
+
+namespace juro::stress {
+
+std::size_t live_bytes() noexcept {
+    return allocated.load(std::memory_order_relaxed);
+}
+
+std::size_t peak_bytes() noexcept {
+    return peak.load(std::memory_order_relaxed);
+}
+
+void reset_peak_bytes() noexcept {
+    peak.store(allocated.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+} /* namespace juro::stress */
+
+// As in the benchmarks, the replacements live in their own translation unit so
+// that the compiler never pairs an inlined `new` with an inlined `delete`.
+void *operator new(std::size_t size) {
+    auto *block = static_cast<unsigned char *>(std::malloc(header_size + size));
+    if(block == nullptr) {
+        throw std::bad_alloc {  };
+    }
+    *reinterpret_cast<std::size_t *>(block) = size;
+
+    const auto current = 
+        allocated.fetch_add(size, std::memory_order_relaxed) + size;
+    auto highest = peak.load(std::memory_order_relaxed);
+    while(current > highest && 
+        !peak.compare_exchange_weak(highest, current, std::memory_order_relaxed)) {  }
+
+    return block + header_size;
+}
+
+void operator delete(void *block) noexcept {
+    if(block == nullptr) {
+        return;
+    }
+    auto *start = static_cast<unsigned char *>(block) - header_size;
+    allocated.fetch_sub(*reinterpret_cast<std::size_t *>(start), std::memory_order_relaxed);
+    std::free(start);
+}
+
+void operator delete(void *block, std::size_t) noexcept {
+    operator delete(block);
+}
@@ -0,0 +1,535 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "juro/promise.hpp"
+#include "juro/compose/all.hpp"
+#include "juro/compose/race.hpp"
+#include "memory.hpp"
+
+#ifndef JURO_COUNT_PROMISES
+#error "The stress harness counts live promises and requires JURO_COUNT_PROMISES"
+#endif /* JURO_COUNT_PROMISES */
+
+#if defined(JURO_INTRUSIVE_PTR) && !defined(JURO_ATOMIC_REFCOUNT)
+#error "Promises shared across threads require JURO_ATOMIC_REFCOUNT"
+#endif /* defined(JURO_INTRUSIVE_PTR) && !defined(JURO_ATOMIC_REFCOUNT) */
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/**
+ * @brief The value producers resolve promises with: the time of settlement,
+ * in ticks of `clock_type`.
+ */
+using stamp = std::int64_t;
+
+struct options {
+    std::size_t producers = 4;
+    std::size_t operations = 200000;
+    std::size_t length = 16;
+    std::size_t fanout = 8;
+    std::size_t depth = 64;
+    std::size_t window = 1024;
+    bool batch = false;
+    std::vector<std::string> scenarios;
+};
+
+inline stamp now() noexcept {
+    return clock_type::now().time_since_epoch().count();
+}
+
+inline std::chrono::nanoseconds since(stamp settled) noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock_type::duration { now() - settled }
+    );
+}
+
+/**
+ * @brief An executor standing for an application's event loop: tasks may be
+ * scheduled from any thread and are run by the thread calling `run_until()`,
+ * which sleeps while there is nothing to do.
+ */
+class event_loop final : public juro::executor {
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<juro::task> tasks;
+    std::size_t peak_promises = 0;
+
+public:
+    void schedule(juro::task &&work) override {
+        {
+            std::lock_guard lock { mutex };
+            tasks.push_back(std::move(work));
+        }
+        ready.notify_one();
+    }
+
+    /**
+     * @brief Runs tasks until the supplied predicate holds, sampling the
+     * amount of live promises after each one.
+     */
+    template<class T_predicate>
+    void run_until(const T_predicate &done) {
+        while(!done()) {
+            run_one();
+        }
+    }
+
+    /**
+     * @brief Runs the tasks queued so far without waiting for others.
+     */
+    void run_pending() {
+        std::size_t pending;
+        {
+            std::lock_guard lock { mutex };
+            pending = tasks.size();
+        }
+        while(pending-- > 0) {
+            run_one();
+        }
+    }
+
+    inline std::size_t get_peak_promises() const noexcept { return peak_promises; }
+
+    inline void reset_peak_promises() noexcept {
+        peak_promises = juro::promise_interface::live_promises();
+    }
+
+private:
+    void run_one() {
+        juro::task work;
+        {
+            std::unique_lock lock { mutex };
+            ready.wait(lock, [this] { return !tasks.empty(); });
+            work = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        work();
+        peak_promises = std::max(peak_promises, juro::promise_interface::live_promises());
+    }
+};
+
+/**
+ * @brief A set of threads standing for an application's I/O threads: each
+ * one resolves the promises submitted to it with the time of settlement,
+ * either one by one or all it has at once in a `juro::settle_batch`.
+ * Promises are spread over the threads in turns; the threads drain every
+ * submitted promise before being joined.
+ */
+class producers {
+    struct lane {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::vector<juro::promise_ptr<stamp>> pending;
+        bool stopping = false;
+    };
+
+    std::vector<std::unique_ptr<lane>> lanes;
+    std::vector<std::thread> threads;
+    std::size_t next = 0;
+    bool batch;
+
+public:
+    producers(std::size_t count, bool batch) : batch { batch } {
+        for(std::size_t index = 0; index < count; index++) {
+            lanes.push_back(std::make_unique<lane>());
+        }
+        for(auto &target : lanes) {
+            threads.emplace_back([this, &target = *target] { produce(target); });
+        }
+    }
+
+    producers(const producers &) = delete;
+    producers &operator=(const producers &) = delete;
+
+    ~producers() {
+        for(auto &target : lanes) {
+            {
+                std::lock_guard lock { target->mutex };
+                target->stopping = true;
+            }
+            target->ready.notify_one();
+        }
+        for(auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    void submit(juro::promise_ptr<stamp> promise) {
+        auto &target = *lanes[next++ % lanes.size()];
+        {
+            std::lock_guard lock { target.mutex };
+            target.pending.push_back(std::move(promise));
+        }
+        target.ready.notify_one();
+    }
+
+private:
+    void produce(lane &source) {
+        std::vector<juro::promise_ptr<stamp>> taken;
+        for(;;) {
+            {
+                std::unique_lock lock { source.mutex };
+                source.ready.wait(lock, [&] {
+                    return source.stopping || !source.pending.empty();
+                });
+                if(source.pending.empty()) {
+                    return;
+                }
+                taken.swap(source.pending);
+            }
+
+            if(batch) {
+                const std::vector<stamp> stamps(taken.size(), now());
+                juro::resolve_all(taken.begin(), taken.end(), stamps.begin());
+            } else {
+                for(auto &promise : taken) {
+                    promise->resolve(now());
+                }
+            }
+            taken.clear();
+        }
+    }
+};
+
+/**
+ * @brief Every latency a scenario recorded, kept raw so that percentiles are
+ * exact rather than bucket bounds.
+ */
+class samples {
+    std::vector<std::chrono::nanoseconds> values;
+    bool sorted = true;
+
+public:
+    inline void reserve(std::size_t count) { values.reserve(count); }
+
+    inline void record(std::chrono::nanoseconds value) {
+        values.push_back(value);
+        sorted = false;
+    }
+
+    /**
+     * @brief Returns the smallest recorded value that at least `rank` of the
+     * values do not exceed, or zero if nothing was recorded.
+     */
+    std::chrono::nanoseconds percentile(double rank) {
+        if(values.empty()) {
+            return std::chrono::nanoseconds { 0 };
+        }
+        if(!sorted) {
+            std::sort(values.begin(), values.end());
+            sorted = true;
+        }
+        const auto position = static_cast<std::size_t>(
+            std::ceil(rank * static_cast<double>(values.size()))
+        );
+        return values[std::clamp<std::size_t>(position, 1, values.size()) - 1];
+    }
+
+    inline std::chrono::nanoseconds max() { return percentile(1.0); }
+};
+
+/**
+ * @brief What a scenario measured: the settle-to-continuation latencies,
+ * along with the amount of promises and bytes alive at the worst moment.
+ */
+struct report {
+    samples latency;
+    std::size_t expected = 0;
+    std::size_t completed = 0;
+    std::chrono::nanoseconds elapsed { 0 };
+    std::size_t peak_promises = 0;
+    std::size_t leaked_promises = 0;
+    std::size_t peak_bytes = 0;
+
+    inline bool passed() const noexcept {
+        return completed == expected && leaked_promises == 0;
+    }
+};
+
+/**
+ * @brief The state a scenario's units of work share: each unit records its
+ * latency once its last continuation runs on the loop.
+ */
+struct context {
+    const options &settings;
+    event_loop &loop;
+    producers &sources;
+    report &results;
+
+    inline void complete(stamp settled) {
+        results.latency.record(since(settled));
+        results.completed++;
+    }
+
+    /**
+     * @brief Creates a concurrent promise and hands it to a producer at once,
+     * so that it may be settled while continuations are still being attached.
+     */
+    juro::promise_ptr<stamp> request() {
+        auto promise = juro::make_concurrent<stamp>();
+        sources.submit(promise);
+        return promise;
+    }
+};
+
+/**
+ * @brief Returns how many units of `size` promises make up a scenario.
+ */
+inline std::size_t units_of(const options &settings, std::size_t size) noexcept {
+    return std::max<std::size_t>(settings.operations / std::max<std::size_t>(size, 1), 1);
+}
+
+/**
+ * @brief A continuation on the loop for each settled promise.
+ */
+void settle(context &ctx) {
+    ctx.request()->then(ctx.loop, [&ctx] (stamp settled) {
+        ctx.complete(settled);
+    });
+}
+
+/**
+ * @brief Chains of `length` continuations, the first dispatched to the loop.
+ */
+void chain(context &ctx) {
+    auto promise = ctx.request()->then(ctx.loop, [] (stamp settled) {
+        return settled;
+    });
+    for(std::size_t step = 1; step < ctx.settings.length; step++) {
+        promise = promise->then([] (stamp settled) { return settled; });
+    }
+    promise->then([&ctx] (stamp settled) { ctx.complete(settled); });
+}
+
+/**
+ * @brief `all()` over `fanout` promises, measured from the last settlement.
+ */
+void fan_in(context &ctx) {
+    std::vector<juro::promise_ptr<stamp>> children;
+    children.reserve(ctx.settings.fanout);
+    for(std::size_t child = 0; child < ctx.settings.fanout; child++) {
+        children.push_back(ctx.request());
+    }
+    juro::all(children)->then(ctx.loop, [&ctx] (std::vector<stamp> &settled) {
+        ctx.complete(*std::max_element(settled.begin(), settled.end()));
+    });
+}
+
+/**
+ * @brief `race()` among `fanout` promises, measured from the first
+ * settlement. The losers are still settled by the producers.
+ */
+void first_of(context &ctx) {
+    std::vector<juro::promise_ptr<stamp>> children;
+    children.reserve(ctx.settings.fanout);
+    for(std::size_t child = 0; child < ctx.settings.fanout; child++) {
+        children.push_back(ctx.request());
+    }
+    juro::race(children.begin(), children.end())->then(ctx.loop, [&ctx] (stamp settled) {
+        ctx.complete(settled);
+    });
+}
+
+/**
+ * @brief Issues a request and, once it is settled, another one from its
+ * continuation on the loop, `depth` times; the outermost promise is settled
+ * by the innermost request, through every promise returned in between.
+ */
+juro::promise_ptr<stamp> descend(context &ctx, std::size_t depth) {
+    if(depth == 0) {
+        return ctx.request();
+    }
+    return ctx.request()->then(ctx.loop, [&ctx, depth] (stamp) {
+        return descend(ctx, depth - 1);
+    });
+}
+
+/**
+ * @brief Asynchronous recursion `depth` levels deep, measured from the
+ * innermost settlement to the outermost continuation. The settlement unwinds
+ * through every level on the producer thread before reaching the loop.
+ */
+void recursion(context &ctx) {
+    descend(ctx, ctx.settings.depth - 1)->then(ctx.loop, [&ctx] (stamp settled) {
+        ctx.complete(settled);
+    });
+}
+
+struct scenario {
+    const char *name;
+    std::size_t (*units)(const options &);
+    void (*issue)(context &);
+};
+
+const scenario scenarios[] = {
+    { "settle", [] (const options &settings) { return units_of(settings, 1); }, settle },
+    { "chain", [] (const options &settings) { return units_of(settings, settings.length); }, chain },
+    { "all", [] (const options &settings) { return units_of(settings, settings.fanout); }, fan_in },
+    { "race", [] (const options &settings) { return units_of(settings, settings.fanout); }, first_of },
+    { "recursion", [] (const options &settings) { return units_of(settings, settings.depth); }, recursion },
+};
+
+/**
+ * @brief Runs a scenario the way an event loop would: units are issued from
+ * the loop while it handles the continuations of the ones in flight, at most
+ * `window` of them at any time.
+ */
+report run(const scenario &target, const options &settings) {
+    report results;
+    results.expected = target.units(settings);
+    results.latency.reserve(results.expected);
+    event_loop loop;
+    const auto baseline_promises = juro::promise_interface::live_promises();
+    juro::stress::reset_peak_bytes();
+    const auto baseline_bytes = juro::stress::live_bytes();
+    loop.reset_peak_promises();
+
+    const auto start = clock_type::now();
+    {
+        producers sources { settings.producers, settings.batch };
+        context ctx { settings, loop, sources, results };
+        for(std::size_t issued = 0; issued < results.expected; issued++) {
+            loop.run_until([&] { return issued - results.completed < settings.window; });
+            target.issue(ctx);
+            loop.run_pending();
+        }
+        loop.run_until([&] { return results.completed >= results.expected; });
+    }
+    results.elapsed = clock_type::now() - start;
+
+    // The producers are joined, so nothing schedules on the loop anymore.
+    loop.run_pending();
+    results.peak_promises = loop.get_peak_promises() - baseline_promises;
+    results.peak_bytes = juro::stress::peak_bytes() - baseline_bytes;
+    const auto live = juro::promise_interface::live_promises();
+    results.leaked_promises = live > baseline_promises ? live - baseline_promises : 0;
+    return results;
+}
+
+void print_header() {
+    std::printf(
+        "%-10s %10s %12s %10s %10s %10s %10s %10s %8s %12s\n",
+        "scenario", "units", "units/s", "p50 ns", "p99 ns", "p999 ns", "max ns",
+        "peak live", "leaked", "peak bytes"
+    );
+}
+
+void print(const char *name, report &results) {
+    const auto seconds = std::chrono::duration<double>(results.elapsed).count();
+    std::printf(
+        "%-10s %10zu %12.0f %10lld %10lld %10lld %10lld %10zu %8zu %12zu%s\n",
+        name,
+        results.completed,
+        seconds > 0 ? static_cast<double>(results.completed) / seconds : 0.0,
+        static_cast<long long>(results.latency.percentile(0.5).count()),
+        static_cast<long long>(results.latency.percentile(0.99).count()),
+        static_cast<long long>(results.latency.percentile(0.999).count()),
+        static_cast<long long>(results.latency.max().count()),
+        results.peak_promises,
+        results.leaked_promises,
+        results.peak_bytes,
+        results.passed() ? "" : "  FAILED"
+    );
+}
+
+void usage(const char *program) {
+    std::fprintf(stderr,
+        "usage: %s [options] [scenario...]\n"
+        "scenarios: settle chain all race recursion (default: every one)\n"
+        "  --producers N   producer threads settling promises (default 4)\n"
+        "  --operations N  promises settled per scenario (default 200000)\n"
+        "  --length N      continuations per chain (default 16)\n"
+        "  --fanout N      children per all() and race() (default 8)\n"
+        "  --depth N       levels of asynchronous recursion (default 64)\n"
+        "  --window N      units in flight at once (default 1024)\n"
+        "  --batch         settle each producer's promises in a settle_batch\n",
+        program
+    );
+}
+
+bool parse(int argc, char **argv, options &settings) {
+    for(int index = 1; index < argc; index++) {
+        const char *argument = argv[index];
+        std::size_t *target = nullptr;
+        if(std::strcmp(argument, "--producers") == 0) {
+            target = &settings.producers;
+        } else if(std::strcmp(argument, "--operations") == 0) {
+            target = &settings.operations;
+        } else if(std::strcmp(argument, "--length") == 0) {
+            target = &settings.length;
+        } else if(std::strcmp(argument, "--fanout") == 0) {
+            target = &settings.fanout;
+        } else if(std::strcmp(argument, "--depth") == 0) {
+            target = &settings.depth;
+        } else if(std::strcmp(argument, "--window") == 0) {
+            target = &settings.window;
+        } else if(std::strcmp(argument, "--batch") == 0) {
+            settings.batch = true;
+            continue;
+        } else if(argument[0] != '-') {
+            settings.scenarios.emplace_back(argument);
+            continue;
+        } else {
+            return false;
+        }
+
+        if(++index == argc) {
+            return false;
+        }
+        char *end = nullptr;
+        *target = static_cast<std::size_t>(std::strtoull(argv[index], &end, 10));
+        if(end == argv[index] || *end != '\0' || *target == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} /* anonymous namespace */
+
+int main(int argc, char **argv) {
+    options settings;
+    if(!parse(argc, argv, settings)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<const scenario *> selected;
+    for(const auto &candidate : scenarios) {
+        const auto wanted = settings.scenarios.empty() || std::find(
+            settings.scenarios.begin(),
+            settings.scenarios.end(),
+            candidate.name
+        ) != settings.scenarios.end();
+        if(wanted) {
+            selected.push_back(&candidate);
+        }
+    }
+    if(selected.size() < std::max<std::size_t>(settings.scenarios.size(), 1)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    bool passed = true;
+    print_header();
+    for(const auto *target : selected) {
+        auto results = run(*target, settings);
+        print(target->name, results);
+        passed = passed && results.passed();
+    }
+    return passed ? 0 : 1;
+}
@@ -1,9 +1,14 @@
 #ifndef JURO_TEST_HELPERS_HPP
 #define JURO_TEST_HELPERS_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <stdexcept>
+#include <string>
 #include <variant>
+#include <vector>
 
 namespace juro::test::helpers {
 
@@ -62,6 +67,137 @@ inline safe_result<void> rescue(std::exception_ptr &error) {
     return error;
 }
 
+struct copy_counter {
+    std::size_t *copies = nullptr;
+
+    copy_counter() noexcept = default;
+    explicit copy_counter(std::size_t &copies) noexcept : copies { &copies } {  }
+
+    copy_counter(const copy_counter &other) noexcept : copies { other.copies } {
+        if(copies != nullptr) {
+            ++*copies;
+        }
+    }
+
+    copy_counter(copy_counter &&) noexcept = default;
+
+    copy_counter &operator=(const copy_counter &other) noexcept {
+        copies = other.copies;
+        if(copies != nullptr) {
+            ++*copies;
+        }
+        return *this;
+    }
+
+    copy_counter &operator=(copy_counter &&) noexcept = default;
+};
+
+[[gnu::noinline]] inline std::uintptr_t stack_position() {
+    volatile int marker = 0;
+    return reinterpret_cast<std::uintptr_t>(&marker);
+}
+
+struct allocation_counter {
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+};
+
+template<class T>
+struct counting_allocator {
+    using value_type = T;
+
+    allocation_counter *counter;
+
+    counting_allocator(allocation_counter &counter) noexcept : 
+        counter { &counter }
+        {  }
+
+    template<class T_other>
+    counting_allocator(const counting_allocator<T_other> &other) noexcept :
+        counter { other.counter }
+        {  }
+
+    T *allocate(std::size_t n) {
+        counter->allocations++;
+        return std::allocator<T> {  }.allocate(n);
+    }
+
+    void deallocate(T *pointer, std::size_t n) noexcept {
+        counter->deallocations++;
+        std::allocator<T> {  }.deallocate(pointer, n);
+    }
+
+    template<class T_other>
+    friend bool operator==(
+        const counting_allocator &lhs, 
+        const counting_allocator<T_other> &rhs
+    ) noexcept {
+        return lhs.counter == rhs.counter;
+    }
+
+    template<class T_other>
+    friend bool operator!=(
+        const counting_allocator &lhs, 
+        const counting_allocator<T_other> &rhs
+    ) noexcept {
+        return lhs.counter != rhs.counter;
+    }
+};
+
+#ifdef JURO_INSTRUMENTATION
+struct lifecycle_event {
+    std::string hook;
+    juro::promise_id id;
+    juro::promise_id other = 0;
+
+    friend bool operator==(const lifecycle_event &lhs, const lifecycle_event &rhs) {
+        return lhs.hook == rhs.hook && lhs.id == rhs.id && lhs.other == rhs.other;
+    }
+};
+
+struct event_recorder final : public juro::observer {
+    std::vector<lifecycle_event> events;
+
+    void created(juro::promise_id id) noexcept override {
+        events.push_back({ "created", id });
+    }
+
+    void chained(juro::promise_id id, juro::promise_id parent) noexcept override {
+        events.push_back({ "chained", id, parent });
+    }
+
+    void settled(juro::promise_id id, juro::promise_state state) noexcept override {
+        events.push_back({ "settled", id, static_cast<juro::promise_id>(state) });
+    }
+
+    void unhandled(juro::promise_id id, const std::exception_ptr &) noexcept override {
+        events.push_back({ "unhandled", id });
+    }
+
+    void handler_began(juro::promise_id id) noexcept override {
+        events.push_back({ "handler_began", id });
+    }
+
+    void handler_ended(juro::promise_id id) noexcept override {
+        events.push_back({ "handler_ended", id });
+    }
+
+    void destroyed(juro::promise_id id) noexcept override {
+        events.push_back({ "destroyed", id });
+    }
+
+    std::vector<lifecycle_event> of(juro::promise_id id) const {
+        std::vector<lifecycle_event> selected;
+        for(const auto &event : events) {
+            if(event.id == id) {
+                selected.push_back(event);
+            }
+        }
+        return selected;
+    }
+};
+#endif /* JURO_INSTRUMENTATION */
+
 } /* namespace juro::test::helpers */
 
 #endif /* JURO_TEST_HELPERS_HPP */
\ No newline at end of file
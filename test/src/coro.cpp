@@ -0,0 +1,185 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "juro/coro.hpp"
+
+using namespace std::string_literals;
+
+namespace {
+
+juro::promise_ptr<int> forward(juro::promise_ptr<int> awaited) {
+    co_return co_await awaited;
+}
+
+juro::promise_ptr<std::string> describe(juro::promise_ptr<int> awaited) {
+    try {
+        const auto value = co_await awaited;
+        co_return "value: "s + std::to_string(value);
+    } catch(const std::runtime_error &error) {
+        co_return "error: "s + error.what();
+    }
+}
+
+juro::promise_ptr<int> abandon() {
+    co_return co_await juro::make_pending<int>();
+}
+
+juro::promise_ptr<void> fail() {
+    throw std::runtime_error { "failed" };
+    co_return;
+}
+
+juro::promise_ptr<void> sum_on(juro::thread_pool &pool, std::atomic<int> &sum) {
+    const auto lhs = co_await juro::async(pool, [] { return 20; });
+    const auto rhs = co_await juro::async(pool, [] { return 22; });
+    sum = lhs + rhs;
+}
+
+[[gnu::noinline]] std::uintptr_t stack_position() {
+    volatile int marker = 0;
+    return reinterpret_cast<std::uintptr_t>(&marker);
+}
+
+juro::promise_ptr<int> nest(
+    std::size_t depth,
+    juro::promise_ptr<int> leaf,
+    std::uintptr_t &innermost,
+    std::uintptr_t &outermost
+) {
+    if(depth == 0) {
+        const auto value = co_await leaf;
+        innermost = stack_position();
+        co_return value;
+    }
+
+    const auto value = co_await nest(depth - 1, leaf, innermost, outermost);
+    outermost = stack_position();
+    co_return value + 1;
+}
+
+} /* anonymous namespace */
+
+SCENARIO("promises can be awaited from coroutines") {
+    GIVEN("a coroutine awaiting a pending promise") {
+        auto awaited = juro::make_pending<int>();
+        auto result = forward(awaited);
+
+        WHEN("the awaited promise is resolved") {
+            const bool suspended = result->is_pending();
+            awaited->resolve(42);
+
+            THEN("the coroutine must have been suspended until then") {
+                REQUIRE(suspended);
+
+                AND_THEN("its promise must resolve with the returned value") {
+                    REQUIRE(result->is_resolved());
+                    REQUIRE(result->get_value() == 42);
+                }
+            }
+        }
+    }
+
+    GIVEN("a coroutine awaiting a promise that is dropped unsettled") {
+        auto result = abandon();
+
+        THEN("the suspended coroutine must be destroyed along with it") {
+            REQUIRE(result->is_pending());
+            REQUIRE(result.use_count() == 1);
+        }
+    }
+
+    GIVEN("a coroutine awaiting a resolved promise") {
+        auto result = forward(juro::make_resolved(10));
+
+        THEN("the coroutine must run to completion without suspending") {
+            REQUIRE(result->get_value() == 10);
+        }
+    }
+
+    GIVEN("a coroutine that handles rejections") {
+        auto awaited = juro::make_pending<int>();
+        auto result = describe(awaited);
+
+        WHEN("the awaited promise is rejected") {
+            awaited->reject(std::runtime_error { "oops" });
+
+            THEN("the rejection must be thrown inside the coroutine") {
+                REQUIRE(result->get_value() == "error: oops");
+            }
+        }
+    }
+
+    GIVEN("a coroutine that throws") {
+        auto result = fail();
+
+        THEN("its promise must be rejected") {
+            REQUIRE(result->is_rejected());
+        }
+
+        WHEN("a handler is attached afterwards") {
+            std::string message;
+            result->rescue([&] (std::exception_ptr &error) {
+                try {
+                    std::rethrow_exception(error);
+                } catch(const std::runtime_error &e) {
+                    message = e.what();
+                }
+            });
+
+            THEN("it must receive the thrown exception") {
+                REQUIRE(message == "failed");
+            }
+        }
+    }
+
+    GIVEN("a deep chain of coroutines awaiting each other") {
+        constexpr std::size_t depth = 4096;
+        std::uintptr_t innermost = 0;
+        std::uintptr_t outermost = 0;
+        auto leaf = juro::make_pending<int>();
+        auto result = nest(depth, leaf, innermost, outermost);
+
+        WHEN("the innermost awaited promise is resolved") {
+            leaf->resolve(0);
+
+            THEN("every coroutine must resume without growing the stack") {
+                REQUIRE(result->get_value() == static_cast<int>(depth));
+                const auto distance = innermost > outermost ?
+                    innermost - outermost :
+                    outermost - innermost;
+                REQUIRE(distance < 4096);
+            }
+        }
+    }
+
+    GIVEN("a coroutine started inside a promise arena") {
+        juro::promise_arena arena;
+        auto awaited = juro::make_pending<int>();
+        auto result = forward(awaited);
+        awaited->resolve(7);
+
+        THEN("it must behave as any other coroutine") {
+            REQUIRE(result->get_value() == 7);
+        }
+    }
+
+    GIVEN("a coroutine awaiting work run on a thread pool") {
+        juro::thread_pool pool { 2 };
+        std::atomic<int> sum = 0;
+        sum_on(pool, sum);
+
+        WHEN("the work completes") {
+            while(sum == 0) {
+                std::this_thread::yield();
+            }
+
+            THEN("the coroutine must resume on the workers with the results") {
+                REQUIRE(sum == 42);
+            }
+        }
+    }
+}
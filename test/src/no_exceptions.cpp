@@ -0,0 +1,53 @@
+/**
+ * Built with `-fno-exceptions`: checks that result promises and their
+ * compositions need no exception support, and that they still work.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "juro/result_promise.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char *description) {
+    if(!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", description);
+        failures++;
+    }
+}
+
+} /* namespace */
+
+int main() {
+    using juro::make_pending_result;
+    const auto timed_out = std::make_error_code(std::errc::timed_out);
+
+    auto promise = make_pending_result<int, std::error_code>();
+    auto rescued = promise
+        ->then([] (int value) { return std::to_string(value); })
+        ->rescue([] (std::error_code &error) { return error.message(); });
+    promise->reject(timed_out);
+    check(rescued->get_value() == timed_out.message(), "rejections reach rescue()");
+
+    auto first = make_pending_result<int, std::error_code>();
+    auto second = make_pending_result<int, std::error_code>();
+    auto both = juro::all(first, second);
+    first->resolve(1);
+    second->resolve(2);
+    check(both->is_resolved() && std::get<1>(both->get_value()) == 2, "all() resolves");
+
+    std::vector<juro::result_promise_ptr<int, std::error_code>> children {
+        make_pending_result<int, std::error_code>(),
+        make_pending_result<int, std::error_code>()
+    };
+    auto winner = juro::race(children);
+    children[1]->reject(timed_out);
+    check(winner->is_rejected() && winner->get_error() == timed_out, "race() rejects");
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,11 +1,29 @@
 #define JURO_TEST
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <thread>
 #include <type_traits>
 #include <string>
+#include <system_error>
+#include <variant>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 #include "juro/promise.hpp"
+#include "juro/pipeline.hpp"
+#include "juro/promise_cache.hpp"
+#include "juro/result_promise.hpp"
+#include "juro/shared_promise.hpp"
+#include "juro/stream.hpp"
+#include "juro/timer.hpp"
 #include "juro/compose/all.hpp"
 #include "juro/compose/race.hpp"
+#include "juro/compose/all_settled.hpp"
+#include "juro/compose/any.hpp"
+#include "juro/compose/map_limit.hpp"
 #include "helpers.hpp"
 
 using namespace juro::helpers;
@@ -75,6 +93,200 @@ SCENARIO("promise can be created on every state") {
     }
 }
 
+SCENARIO("promises should be compact") {
+    constexpr auto storage_bound = 
+        sizeof(juro::promise_interface) + sizeof(std::exception_ptr);
+
+    static_assert(
+        sizeof(juro::promise<int>) <= storage_bound,
+        "The state of a promise must be the discriminant of its storage"
+    );
+    static_assert(
+        sizeof(juro::promise<void>) <= storage_bound,
+        "The state of a promise must be the discriminant of its storage"
+    );
+
+    /* 144 bytes on 64-bit targets in every configuration: the intrusive
+     * mode's vtable and counter take the room of the shared_ptr mode's weak
+     * self-reference, and the instrumentation identifier fills padding. */
+    constexpr auto size_limit = 18 * sizeof(void *);
+
+    static_assert(
+        sizeof(juro::promise<int>) <= size_limit,
+        "Promises must not grow past their pinned size"
+    );
+    static_assert(
+        sizeof(juro::promise<void>) <= size_limit,
+        "Promises must not grow past their pinned size"
+    );
+#ifndef JURO_INTRUSIVE_PTR
+    static_assert(
+        !std::is_polymorphic_v<juro::promise<int>>,
+        "Promises released through std::shared_ptr must not need a vtable"
+    );
+#endif /* JURO_INTRUSIVE_PTR */
+
+    GIVEN("the sizes of common promise types") {
+        const auto int_size = sizeof(juro::promise<int>);
+        const auto void_size = sizeof(juro::promise<void>);
+        CAPTURE(int_size, void_size);
+
+        THEN("no promise must outgrow its untyped part and its storage") {
+            REQUIRE(int_size <= storage_bound);
+            REQUIRE(void_size <= storage_bound);
+        }
+
+        THEN("no promise must outgrow its pinned size") {
+            REQUIRE(int_size <= size_limit);
+            REQUIRE(void_size <= size_limit);
+        }
+    }
+}
+
+SCENARIO("promises can be allocated with custom allocators") {
+    GIVEN("a counting allocator") {
+        allocation_counter counter;
+        counting_allocator<int> allocator { counter };
+
+        WHEN("promises are created through the allocator-aware factories") {
+            {
+                auto pending = juro::make_pending<int>(std::allocator_arg, allocator);
+                auto resolved = juro::make_resolved(std::allocator_arg, allocator, 10);
+                auto rejected = juro::make_rejected<int>(
+                    std::allocator_arg, 
+                    allocator, 
+                    "Rejected"s
+                );
+                auto launched = juro::make_promise<int>(
+                    std::allocator_arg, 
+                    allocator, 
+                    [] (auto &promise) { promise->resolve(20); }
+                );
+
+                THEN("each promise must be allocated exactly once") {
+                    REQUIRE(counter.allocations == 4);
+                    REQUIRE(counter.deallocations == 0);
+                    REQUIRE(pending->is_pending());
+                    REQUIRE(resolved->get_value() == 10);
+                    REQUIRE(rejected->is_rejected());
+                    REQUIRE(launched->get_value() == 20);
+                }
+            }
+
+            THEN("every allocation must be released with the promises") {
+                REQUIRE(counter.allocations == 4);
+                REQUIRE(counter.deallocations == 4);
+            }
+        }
+    }
+
+    GIVEN("an active promise arena") {
+        juro::promise_arena arena;
+
+        WHEN("a promise is created and released") {
+            const void *address = juro::make_pending<int>().get();
+
+            THEN("the next promise of the same type must reuse its memory") {
+                auto promise = juro::make_pending<int>();
+                REQUIRE(static_cast<const void *>(promise.get()) == address);
+            }
+        }
+
+        WHEN("a promise chain is built") {
+            auto promise = juro::make_pending<int>();
+            auto next = promise->then([] (int value) { return value * 2; });
+            promise->resolve(10);
+
+            THEN("it must behave as usual") {
+                REQUIRE(next->is_resolved());
+                REQUIRE(next->get_value() == 20);
+            }
+        }
+    }
+}
+
+SCENARIO("pooled blocks freed on other threads should be reused") {
+    GIVEN("blocks allocated on short-lived threads and freed on this one") {
+        using juro::size_class_pool;
+        constexpr std::size_t block_size = 128;
+        constexpr std::size_t block_count = 4 * size_class_pool::chunk_size / block_size;
+        constexpr std::size_t rounds = 8;
+        const auto before = size_class_pool::chunk_count();
+
+        WHEN("the same amount of blocks is allocated and freed on every round") {
+            for(std::size_t round = 0; round < rounds; round++) {
+                std::vector<void *> blocks;
+                std::thread { [&] {
+                    for(std::size_t index = 0; index < block_count; index++) {
+                        blocks.push_back(size_class_pool::allocate(block_size));
+                    }
+                } }.join();
+
+                for(auto *block : blocks) {
+                    size_class_pool::deallocate(block, block_size);
+                }
+            }
+
+            THEN("the amount of chunks must not grow with the rounds") {
+                REQUIRE(size_class_pool::chunk_count() - before <= 8);
+            }
+        }
+    }
+}
+
+SCENARIO("intrusive pointers should count references") {
+    GIVEN("an intrusively counted object") {
+        struct counted : juro::ref_counted_object<counted> {
+            bool *destroyed;
+            counted(bool *destroyed) : destroyed { destroyed } {  }
+            ~counted() { *destroyed = true; }
+        };
+
+        bool destroyed = false;
+        auto pointer = juro::intrusive_ptr { new counted { &destroyed } };
+
+        THEN("it must be referenced once") {
+            REQUIRE(pointer.use_count() == 1);
+        }
+
+        WHEN("the pointer is copied") {
+            auto copy = pointer;
+
+            THEN("both pointers must share the same counter") {
+                REQUIRE(copy == pointer);
+                REQUIRE(pointer.use_count() == 2);
+            }
+
+            AND_WHEN("the original pointer is reset") {
+                pointer.reset();
+
+                THEN("the object must still be alive") {
+                    REQUIRE_FALSE(destroyed);
+                    REQUIRE(copy.use_count() == 1);
+                }
+
+                AND_WHEN("the last pointer is reset") {
+                    copy = nullptr;
+
+                    THEN("the object must be destroyed") {
+                        REQUIRE(destroyed);
+                    }
+                }
+            }
+        }
+
+        WHEN("the pointer is moved") {
+            auto moved = std::move(pointer);
+
+            THEN("the reference must be transferred") {
+                REQUIRE_FALSE(pointer);
+                REQUIRE(moved.use_count() == 1);
+                REQUIRE_FALSE(destroyed);
+            }
+        }
+    }
+}
+
 SCENARIO("promises should resolve and reject accordingly") {
     GIVEN("a pending promise") {
         auto promise = juro::make_pending<bool>();
@@ -172,6 +384,127 @@ SCENARIO("promises must not be resettled") {
     }
 }
 
+SCENARIO("promises can be settled in batches") {
+    GIVEN("a few pending promises with chained handlers") {
+        std::vector<juro::promise_ptr<int>> promises;
+        std::vector<int> seen;
+        for(int index = 0; index < 3; index++) {
+            promises.push_back(juro::make_pending<int>());
+            promises.back()
+                ->then([&] (int value) { seen.push_back(value); return value * 10; })
+                ->then([&] (int value) { seen.push_back(value); });
+        }
+
+        WHEN("they are resolved in a batch") {
+            juro::settle_batch batch;
+            for(int index = 0; index < 3; index++) {
+                promises[index]->resolve(index + 1);
+            }
+
+            THEN("they must be settled before any handler runs") {
+                REQUIRE(promises[0]->is_resolved());
+                REQUIRE(promises[2]->is_resolved());
+                REQUIRE(seen.empty());
+            }
+
+            AND_WHEN("the batch is closed") {
+                batch.close();
+
+                THEN("every handler must have run") {
+                    REQUIRE_FALSE(batch.is_open());
+                    std::sort(seen.begin(), seen.end());
+                    REQUIRE(seen == std::vector<int> { 1, 2, 3, 10, 20, 30 });
+                }
+            }
+
+            AND_WHEN("a nested batch is closed") {
+                {
+                    juro::settle_batch nested;
+                }
+
+                THEN("the handlers must wait for the outer batch") {
+                    REQUIRE(seen.empty());
+                    batch.close();
+                    REQUIRE(seen.size() == 6);
+                }
+            }
+        }
+
+        WHEN("they are resolved in a batch drained through an executor") {
+            juro::queue_executor queue;
+            {
+                juro::settle_batch batch { queue };
+                for(int index = 0; index < 3; index++) {
+                    promises[index]->resolve(index + 1);
+                }
+            }
+
+            THEN("the handlers must run as a single task") {
+                REQUIRE(seen.empty());
+                REQUIRE(queue.run() == 1);
+                std::sort(seen.begin(), seen.end());
+                REQUIRE(seen == std::vector<int> { 1, 2, 3, 10, 20, 30 });
+            }
+        }
+
+        WHEN("they are resolved with `resolve_all()`") {
+            const std::vector<int> values { 4, 5, 6 };
+            juro::resolve_all(promises.begin(), promises.end(), values.begin());
+
+            THEN("every handler must have run with its value") {
+                std::sort(seen.begin(), seen.end());
+                REQUIRE(seen == std::vector<int> { 4, 5, 6, 40, 50, 60 });
+            }
+        }
+    }
+
+    GIVEN("a handler closing a batch drained through an executor") {
+        juro::queue_executor queue;
+        auto outer = juro::make_pending<int>();
+        auto inner = juro::make_pending<int>();
+        std::vector<int> seen;
+        inner->then([&] (int value) { seen.push_back(value); });
+        outer->then([&] (int value) {
+            juro::settle_batch batch { queue };
+            inner->resolve(value * 10);
+            batch.close();
+            seen.push_back(value);
+        });
+
+        WHEN("the handler runs") {
+            outer->resolve(1);
+
+            THEN("the deferred handlers must join the enclosing pass") {
+                REQUIRE(queue.empty());
+                REQUIRE(seen == std::vector<int> { 1, 10 });
+            }
+        }
+    }
+
+    GIVEN("a batch whose handlers reject unhandled promises") {
+        auto p1 = juro::make_pending<int>();
+        auto p2 = juro::make_pending<int>();
+        int ran = 0;
+        p1->then([&] (int) { ran++; throw 1; });
+        p2->then([&] (int) { ran++; });
+
+        WHEN("the batch is closed") {
+            juro::settle_batch batch;
+            p1->resolve(1);
+            p2->resolve(2);
+            auto result = attempt([&] { batch.close(); });
+
+            THEN("every handler must run and the first exception be rethrown") {
+                REQUIRE(ran == 2);
+                REQUIRE(result.holds_error<promise_error>());
+                REQUIRE(result.get_error<promise_error>().what() == 
+                    "Unhandled promise rejection"s
+                );
+            }
+        }
+    }
+}
+
 SCENARIO("promises should be chainable") {
     GIVEN("a pending promise") {
         auto promise = juro::make_pending<int>();
@@ -194,6 +527,10 @@ SCENARIO("promises should be chainable") {
                         REQUIRE(next->get_value() == 10);
                     }
                 }
+
+                THEN("the settle handler must have been released") {
+                    REQUIRE_FALSE(promise->has_handler());
+                }
             }
 
             AND_WHEN("the promise is rejected with a value") {
@@ -278,156 +615,1797 @@ SCENARIO("promises should be chainable") {
             }
         }
     }
-}
 
-SCENARIO("promises should be composable") {
-    GIVEN("a promise composition function `all()`") {
-        WHEN("called with three promises of different types") {
-            auto p1 = juro::make_pending<int>();
-            auto p2 = juro::make_pending<std::string>();
-            auto p3 = juro::make_pending();
+    GIVEN("a chain of resolve handlers") {
+        std::size_t calls = 0;
+        auto root = juro::make_pending<int>();
+        auto leaf = root
+            ->then([&] (int value) { calls++; return value; })
+            ->then([&] (int value) { calls++; return juro::make_resolved(value); })
+            ->then([&] (int) { calls++; });
 
-            auto all_result = attempt([&] {
-                return juro::all(p1, p2, p3);
+        WHEN("the root promise is rejected") {
+            auto error = std::make_exception_ptr("Rejected"s);
+            auto result = attempt([&] { root->reject(error); });
+
+            THEN("the rejection must be forwarded down the chain as is") {
+                REQUIRE(result.has_error());
+                REQUIRE(calls == 0);
+                REQUIRE(leaf->is_rejected());
+                REQUIRE(leaf->get_error() == error);
+            }
+        }
+    }
+
+    GIVEN("a resolved promise holding a move-only value") {
+        auto promise = juro::make_resolved<std::unique_ptr<int>>(std::make_unique<int>(7));
+
+        WHEN("the value is consumed") {
+            std::size_t calls = 0;
+            auto next = promise->consume([&] (std::unique_ptr<int> value) {
+                calls++;
+                return *value * 2;
             });
 
-            THEN("it must not throw an exception") {
-                REQUIRE_FALSE(all_result.has_error());
+            THEN("the value must be moved into the handler") {
+                REQUIRE(calls == 1);
+                REQUIRE(next->get_value() == 14);
 
-                AND_THEN("it must return a pending promise") {
-                    REQUIRE(all_result.has_value());
-                    REQUIRE(all_result.get_value()->is_pending());
+                AND_THEN("the promise must stay resolved without a value") {
+                    REQUIRE(promise->is_resolved());
+                    REQUIRE(promise->is_empty());
                 }
             }
+        }
 
-            AND_WHEN("some promises are resolved") {
-                auto &promise = all_result.get_value();
-                p1->resolve(10);
-                p3->resolve();
+        WHEN("a handler takes the value as an rvalue") {
+            auto next = promise->then([] (std::unique_ptr<int> &&value) {
+                return *value * 3;
+            });
 
-                THEN("the returned promise must still be pending") {
-                    REQUIRE(promise->is_pending());
-                }
+            THEN("the value must be moved into the handler") {
+                REQUIRE(next->get_value() == 21);
+                REQUIRE(promise->is_resolved());
+                REQUIRE(promise->is_empty());
+            }
+        }
+    }
 
-                AND_WHEN("all promises are resolved") {
-                    p2->resolve("resolved");
+    GIVEN("a pending promise whose value is consumed") {
+        std::size_t copies = 0;
+        auto promise = juro::make_pending<copy_counter>();
+        auto next = promise->consume(
+            [] (copy_counter value) { return value; },
+            [] (std::exception_ptr &) { return copy_counter {  }; }
+        );
+
+        WHEN("the promise is resolved") {
+            promise->resolve(copy_counter { copies });
+
+            THEN("the value must reach the chained promise without being copied") {
+                REQUIRE(next->is_resolved());
+                REQUIRE(next->get_value().copies == &copies);
+                REQUIRE(copies == 0);
+                REQUIRE(promise->is_empty());
+            }
+        }
 
-                    THEN("the returned promise must be resolved with correct values") {
-                        REQUIRE(promise->is_resolved());
-                        REQUIRE(promise->get_value() == 
-                            std::make_tuple(10, "resolved"s, void_type { })
-                        );
-                    }
-                }
+        WHEN("the promise is rejected") {
+            promise->reject();
+
+            THEN("the reject handler must be invoked") {
+                REQUIRE(next->is_resolved());
+                REQUIRE(next->get_value().copies == nullptr);
             }
+        }
+    }
 
-            AND_WHEN("any promise is rejected") {
-                auto p2_result = attempt([&] { p2->reject("Rejected"s); });
-                auto &promise = all_result.get_value();
+    GIVEN("a pending promise with a reject handler only") {
+        std::size_t copies = 0;
+        auto promise = juro::make_pending<copy_counter>();
+        auto next = promise->rescue([] (std::exception_ptr &) {
+            return copy_counter {  };
+        });
 
-                THEN("a `promise_error` must be thrown") {
-                    REQUIRE(p2_result.has_error());
-                    REQUIRE(p2_result.holds_error<promise_error>());
-                    REQUIRE(p2_result.get_error<promise_error>().what() ==
-                        "Unhandled promise rejection"s
-                    );
+        WHEN("the promise is resolved") {
+            promise->resolve(copy_counter { copies });
 
-                    AND_THEN("the returned promise must be rejected with 'Rejected'") {
-                        REQUIRE(promise->is_rejected());
-                        REQUIRE(rescue(promise->get_error())
-                            .get_error<std::string>() == "Rejected"s
-                        );
-                    }
-                }
+            THEN("the value must be copied into the chained promise") {
+                REQUIRE(next->get_value().copies == &copies);
+                REQUIRE(copies == 1);
+                REQUIRE(promise->get_value().copies == &copies);
+            }
+        }
+    }
 
-                AND_WHEN("other promises are resolved") {
-                    auto p1_result = attempt([&] { p1->resolve(0); });
+    GIVEN("a reject handler chained onto a promise only the library holds") {
+        std::size_t copies = 0;
+        auto root = juro::make_pending();
+        auto next = root
+            ->then([&copies] { return copy_counter { copies }; })
+            ->rescue([] (std::exception_ptr &) { return copy_counter {  }; });
 
-                    THEN("no exception should be thrown") {
-                        REQUIRE(p1_result.has_value());
+        WHEN("the root promise is resolved") {
+            root->resolve();
 
-                        AND_THEN("the returned promise must retain its value") {
-                            REQUIRE(promise->is_rejected());
-                            REQUIRE(rescue(promise->get_error())
-                                .get_error<std::string>() == "Rejected"s
-                            );
-                        }
-                    }
-                }
+            THEN("the value must be passed through without being copied") {
+                REQUIRE(next->get_value().copies == &copies);
+                REQUIRE(copies == 0);
+            }
+        }
+    }
 
-                AND_WHEN("other promises are rejected") {
-                    auto p3_result = attempt([&] { p3->reject("Invalid"s); });
+    GIVEN("a pending string promise with a reject handler only") {
+        auto promise = juro::make_pending<std::string>();
+        auto next = promise->rescue([] (std::exception_ptr &) { return ""s; });
 
-                    THEN("no exception should be thrown") {
-                        REQUIRE(p3_result.has_value());
+        WHEN("the promise is resolved") {
+            promise->resolve(std::string(100, 'y'));
 
-                        AND_THEN("the returned promise must retain its value") {
-                            REQUIRE(promise->is_rejected());
-                            REQUIRE(rescue(promise->get_error())
-                                .get_error<std::string>() == "Rejected"s
-                            );
-                        }
-                    }
-                }
+            THEN("both promises must hold the value") {
+                REQUIRE(next->get_value() == std::string(100, 'y'));
+                REQUIRE(promise->get_value() == std::string(100, 'y'));
             }
         }
+    }
 
-        WHEN("called with only void promises") {
-            auto p1 = juro::make_pending();
-            auto p2 = juro::make_pending();
-            auto p3 = juro::make_pending();
+#ifdef JURO_COUNT_PROMISES
+    GIVEN("a chain whose intermediate promises are only held by their predecessors") {
+        const auto baseline = juro::promise_interface::live_promises();
+        auto root = juro::make_pending<int>();
+        auto leaf = root
+            ->then([] (int value) { return value + 1; })
+            ->then([] (int value) { return value + 1; })
+            ->then([] (int value) { return value + 1; });
+
+        THEN("every promise of the chain must be alive") {
+            REQUIRE(juro::promise_interface::live_promises() == baseline + 4);
+        }
 
-            auto all_result = attempt([&] {
-                return juro::all(p1, p2, p3);
-            });
+        WHEN("the root promise is resolved") {
+            root->resolve(0);
 
-            THEN("it must not throw an exception") {
-                REQUIRE_FALSE(all_result.has_error());
+            THEN("the intermediate promises must be released") {
+                REQUIRE(leaf->get_value() == 3);
+                REQUIRE(juro::promise_interface::live_promises() == baseline + 2);
+            }
+        }
 
-                AND_THEN("the type of the returned promise must also be void") {
-                    STATIC_REQUIRE(
-                        std::is_same_v<decltype(all_result)::value_type, juro::promise_ptr<void>>
-                    );
-                }
+        WHEN("the chain is dropped") {
+            root = nullptr;
+            leaf = nullptr;
+
+            THEN("no promise must be left alive") {
+                REQUIRE(juro::promise_interface::live_promises() == baseline);
             }
         }
+    }
+#endif /* JURO_COUNT_PROMISES */
+
+    GIVEN("a long chain of handlers returning promises") {
+        constexpr int length = 10000;
+        std::uintptr_t first = 0;
+        std::uintptr_t last = 0;
+        auto root = juro::make_pending<int>();
+        std::vector<juro::promise_ptr<int>> chain { root };
+        for(int index = 0; index < length; index++) {
+            chain.push_back(chain.back()->then([&, index] (int value) {
+                (index == 0 ? first : last) = stack_position();
+                return juro::make_resolved<int>(value + 1);
+            }));
+        }
+
+        WHEN("the root promise is resolved") {
+            root->resolve(0);
 
+            THEN("the chain must settle in bounded stack depth") {
+                REQUIRE(chain.back()->get_value() == length);
+                const auto distance = first > last ? first - last : last - first;
+                REQUIRE(distance < 64 * 1024);
+            }
+        }
     }
+}
 
-    GIVEN("a promise composition function `race()`") {
-        WHEN("called with three promises of different types") {
-            auto p1 = juro::make_pending<int>();
-            auto p2 = juro::make_pending<std::string>();
-            auto p3 = juro::make_pending();
+SCENARIO("handlers can be fused into pipelines") {
+    GIVEN("a pipeline attached to a pending promise") {
+        std::vector<int> steps;
+        auto promise = juro::make_pending<int>();
+        juro::promise_ptr<std::string> result = promise
+            | juro::then([&] (int value) { steps.push_back(1); return value * 2; })
+            | juro::then([&] (int value) { steps.push_back(2); return std::to_string(value); })
+            | juro::rescue([&] (std::exception_ptr &) { steps.push_back(3); return "Rescued"s; });
+
+        THEN("a single settle handler must be attached") {
+            REQUIRE(promise->has_handler());
+            REQUIRE(result->is_pending());
+        }
 
-            auto race_result = attempt([&] { return juro::race(p1, p2, p3); });
+        WHEN("the promise is resolved") {
+            promise->resolve(21);
 
-            THEN("it must not throw an exception") {
-                REQUIRE_FALSE(race_result.has_error());
+            THEN("every resolve handler must run in order") {
+                REQUIRE(steps == std::vector<int> { 1, 2 });
+                REQUIRE(result->get_value() == "42"s);
+            }
+        }
 
-                AND_THEN("it must return a pending promise") {
-                    REQUIRE(race_result.has_value());
-                    REQUIRE(race_result.get_value()->is_pending());
-                }
+        WHEN("the promise is rejected") {
+            promise->reject();
+
+            THEN("the rejection must skip to the reject handler") {
+                REQUIRE(steps == std::vector<int> { 3 });
+                REQUIRE(result->get_value() == "Rescued"s);
             }
+        }
+    }
 
-            AND_WHEN("a promise is resolved with some value") {
-                auto &promise = race_result.get_value();
-                p2->resolve("Resolved"s);
+    GIVEN("a pipeline passing a value through to a handler taking an rvalue") {
+        std::size_t copies = 0;
+        auto promise = juro::make_pending<copy_counter>();
+        juro::promise_ptr<copy_counter> result = promise
+            | juro::rescue([] (std::exception_ptr &) { return copy_counter {  }; })
+            | juro::then([] (copy_counter &&value) { return std::move(value); });
 
-                THEN("the returned promise must be resolved with the same value") {
-                    REQUIRE(promise->is_resolved());
-                    REQUIRE(std::holds_alternative<std::string>(promise->get_value()));
-                    REQUIRE(std::get<std::string>(promise->get_value()) == "Resolved"s);
-                }
+        WHEN("the promise is resolved") {
+            promise->resolve(copy_counter { copies });
 
-                AND_WHEN("another promise is resolved") {
-                    auto p3_result = attempt([&] { p3->resolve(); });
+            THEN("the value must be copied once into the handler") {
+                REQUIRE(result->get_value().copies == &copies);
+                REQUIRE(copies == 1);
+                REQUIRE(promise->get_value().copies == &copies);
+            }
+        }
+    }
 
-                    THEN("no exception must be thrown") {
-                        REQUIRE_FALSE(p3_result.has_error());
+    GIVEN("the same pipeline attached to a promise only the library holds") {
+        std::size_t copies = 0;
+        auto root = juro::make_pending();
+        juro::promise_ptr<copy_counter> result = 
+            root->then([&copies] { return copy_counter { copies }; })
+            | juro::rescue([] (std::exception_ptr &) { return copy_counter {  }; })
+            | juro::then([] (copy_counter &&value) { return std::move(value); });
 
-                        AND_THEN("the returned promise must retain its value") {
+        WHEN("the root promise is resolved") {
+            root->resolve();
+
+            THEN("the value must reach the result promise without being copied") {
+                REQUIRE(result->get_value().copies == &copies);
+                REQUIRE(copies == 0);
+            }
+        }
+    }
+
+    GIVEN("a pipeline whose stage throws") {
+        bool skipped = true;
+        auto promise = juro::make_pending<int>();
+        auto result = (promise
+            | juro::then([] (int) -> int { throw "Thrown"s; })
+            | juro::then([&] (int value) { skipped = false; return value; })
+        ).start();
+        auto outcome = attempt([&] { promise->resolve(1); });
+
+        THEN("the result promise must be rejected with the thrown value") {
+            REQUIRE(outcome.holds_error<promise_error>());
+            REQUIRE(skipped);
+            REQUIRE(result->is_rejected());
+            REQUIRE(rescue(result->get_error()).get_error<std::string>() == "Thrown"s);
+        }
+    }
+
+    GIVEN("a pipeline whose stage returns a promise") {
+        auto inner = juro::make_pending<int>();
+        juro::promise_ptr<int> result = juro::make_resolved(1)
+            | juro::then([&] (int) { return inner; })
+            | juro::then([] (int value) { return value + 1; });
+
+        THEN("the pipeline must wait for the returned promise") {
+            REQUIRE(result->is_pending());
+
+            AND_WHEN("the returned promise is resolved") {
+                inner->resolve(10);
+
+                THEN("the remaining stages must run") {
+                    REQUIRE(result->get_value() == 11);
+                }
+            }
+
+            AND_WHEN("the result promise is cancelled") {
+                inner->on_cancel([] {  });
+                result->cancel();
+
+                THEN("the returned promise must be cancelled") {
+                    REQUIRE(inner->is_rejected());
+                    REQUIRE(result->is_rejected());
+                }
+            }
+        }
+    }
+
+    GIVEN("a pipeline whose stage returns a string promise the caller holds") {
+        auto inner = juro::make_pending<std::string>();
+        juro::promise_ptr<std::size_t> result = juro::make_resolved(1)
+            | juro::then([&] (int) { return inner; })
+            | juro::then([] (std::string value) { return value.size(); });
+
+        WHEN("the returned promise is resolved") {
+            inner->resolve(std::string(100, 'w'));
+
+            THEN("the remaining stages must run on a copy of its value") {
+                REQUIRE(result->get_value() == 100);
+                REQUIRE(inner->get_value() == std::string(100, 'w'));
+            }
+        }
+    }
+
+    GIVEN("a reusable pipeline over void promises") {
+        std::size_t settled = 0;
+        const auto pipeline = juro::then([] {  })
+            | juro::finally([&] (auto &) { settled++; });
+
+        WHEN("it is attached to two promises") {
+            auto resolved = (juro::make_resolved() | pipeline).start();
+            auto rejected = (juro::make_rejected<void>(0) | pipeline).start();
+
+            THEN("both result promises must resolve") {
+                REQUIRE(settled == 2);
+                REQUIRE(resolved->is_resolved());
+                REQUIRE(rejected->is_resolved());
+            }
+        }
+    }
+
+    GIVEN("a pipeline attached to a promise with a default executor") {
+        juro::queue_executor queue;
+        auto promise = juro::make_pending<int>();
+        promise->via(queue);
+        auto result = (promise | juro::then([] (int value) { return value; })).start();
+
+        WHEN("the promise is resolved") {
+            promise->resolve(5);
+
+            THEN("the pipeline must be dispatched through the executor") {
+                REQUIRE(result->is_pending());
+                queue.run();
+                REQUIRE(result->get_value() == 5);
+                REQUIRE(result->get_executor() == &queue);
+            }
+        }
+    }
+
+#ifdef JURO_COUNT_PROMISES
+    GIVEN("a pipeline of three stages") {
+        const auto baseline = juro::promise_interface::live_promises();
+        auto promise = juro::make_pending<int>();
+        auto result = (promise
+            | juro::then([] (int value) { return value + 1; })
+            | juro::then([] (int value) { return value + 1; })
+            | juro::then([] (int value) { return value + 1; })
+        ).start();
+
+        THEN("no intermediate promise must be created") {
+            REQUIRE(juro::promise_interface::live_promises() == baseline + 2);
+        }
+    }
+#endif /* JURO_COUNT_PROMISES */
+}
+
+SCENARIO("promises can be cancelled") {
+    GIVEN("a chain whose producer registered a cancel callback") {
+        bool cancelled = false;
+        auto root = juro::make_pending<int>();
+        root->on_cancel([&] { cancelled = true; });
+        auto leaf = root
+            ->then([] (int value) { return value * 2; })
+            ->then([] (int value) { return std::to_string(value); });
+
+        WHEN("the end of the chain is cancelled") {
+            leaf->cancel();
+
+            THEN("the producer must be told through its callback") {
+                REQUIRE(cancelled);
+
+                AND_THEN("the cancellation must flow down the chain as a rejection") {
+                    REQUIRE(root->is_rejected());
+                    REQUIRE(rescue(root->get_error()).holds_error<cancellation_error>());
+                    REQUIRE(leaf->is_rejected());
+                    REQUIRE(rescue(leaf->get_error()).holds_error<cancellation_error>());
+                }
+            }
+        }
+
+        WHEN("the chain is cancelled after the producer settled") {
+            root->resolve(21);
+            leaf->cancel();
+
+            THEN("nothing must happen") {
+                REQUIRE_FALSE(cancelled);
+                REQUIRE(leaf->is_resolved());
+                REQUIRE(leaf->get_value() == "42"s);
+            }
+        }
+    }
+
+    GIVEN("a chain waiting on a promise returned by a handler") {
+        bool cancelled = false;
+        auto inner = juro::make_pending<int>();
+        inner->on_cancel([&] { cancelled = true; });
+        auto root = juro::make_pending();
+        auto next = root->then([&] { return inner; });
+        root->resolve();
+
+        WHEN("the chained promise is cancelled") {
+            next->cancel();
+
+            THEN("the returned promise must be cancelled") {
+                REQUIRE(cancelled);
+                REQUIRE(inner->is_rejected());
+                REQUIRE(next->is_rejected());
+                REQUIRE(rescue(next->get_error()).holds_error<cancellation_error>());
+            }
+        }
+    }
+
+    GIVEN("a producer that rejects its promise when cancelled") {
+        auto root = juro::make_pending<int>();
+        root->on_cancel([producer = root.get()] { producer->reject("Aborted"s); });
+        auto leaf = root->then([] (int value) { return value; });
+
+        WHEN("the chain is cancelled") {
+            leaf->cancel();
+
+            THEN("the producer's reason must be kept") {
+                REQUIRE(leaf->is_rejected());
+                REQUIRE(rescue(leaf->get_error()).get_error<std::string>() == "Aborted"s);
+            }
+        }
+    }
+
+    GIVEN("a chain without cancel callbacks") {
+        auto root = juro::make_pending<int>();
+        auto leaf = root->then([] (int value) { return value; });
+
+        WHEN("it is cancelled") {
+            leaf->cancel();
+
+            THEN("the chain must be left pending") {
+                REQUIRE(root->is_pending());
+                REQUIRE(leaf->is_pending());
+            }
+        }
+    }
+
+    GIVEN("a chain whose producer promise was dropped") {
+        auto leaf = juro::make_pending<int>()->then([] (int value) { return value; });
+
+        WHEN("it is cancelled") {
+            auto result = attempt([&] { leaf->cancel(); });
+
+            THEN("nothing must happen") {
+                REQUIRE_FALSE(result.has_error());
+                REQUIRE(leaf->is_pending());
+            }
+        }
+    }
+}
+
+SCENARIO("timers can settle promises") {
+    using namespace std::chrono_literals;
+    using clock = juro::timer_wheel::clock;
+
+    GIVEN("a timer wheel") {
+        juro::timer_wheel wheel { 1ms };
+        const auto start = clock::now();
+
+        WHEN("a delay is created") {
+            auto promise = juro::delay(wheel, 10ms);
+
+            THEN("it must be armed in the wheel") {
+                REQUIRE(promise->is_pending());
+                REQUIRE(wheel.size() == 1);
+            }
+
+            AND_WHEN("the wheel advances past the delay") {
+                wheel.advance(start + 5ms);
+                const bool early = promise->is_settled();
+                const auto fired = wheel.advance(start + 50ms);
+
+                THEN("the promise must be resolved then, and not earlier") {
+                    REQUIRE_FALSE(early);
+                    REQUIRE(fired == 1);
+                    REQUIRE(promise->is_resolved());
+                    REQUIRE(wheel.empty());
+                }
+            }
+
+            AND_WHEN("the delay is cancelled") {
+                promise->cancel();
+
+                THEN("it must be rejected and disarmed") {
+                    REQUIRE(promise->is_rejected());
+                    REQUIRE(rescue(promise->get_error()).holds_error<cancellation_error>());
+                    REQUIRE(wheel.empty());
+                }
+            }
+        }
+
+        WHEN("a delay is dropped while armed") {
+            bool handled = false;
+            juro::delay(wheel, 10ms)->then([&] { handled = true; });
+
+            THEN("it must be kept alive by its timer until it fires") {
+                REQUIRE(wheel.size() == 1);
+                wheel.advance(start + 50ms);
+                REQUIRE(handled);
+            }
+        }
+
+        WHEN("delays far into the future are created") {
+            auto near = juro::delay(wheel, 100ms);
+            auto far = juro::delay(wheel, 10s);
+            auto farthest = juro::delay(wheel, 5h);
+
+            AND_WHEN("the wheel advances") {
+                wheel.advance(start + 9s);
+                const bool near_resolved = near->is_resolved();
+                const bool far_early = far->is_settled();
+                wheel.advance(start + 11s);
+                const bool far_resolved = far->is_resolved();
+                wheel.advance(start + 4h);
+                const bool farthest_early = farthest->is_settled();
+                wheel.advance(start + 6h);
+
+                THEN("they must cascade and resolve in time") {
+                    REQUIRE(near_resolved);
+                    REQUIRE_FALSE(far_early);
+                    REQUIRE(far_resolved);
+                    REQUIRE_FALSE(farthest_early);
+                    REQUIRE(farthest->is_resolved());
+                }
+            }
+        }
+
+        WHEN("a deadline is set on a pending promise") {
+            bool cancelled = false;
+            auto promise = juro::make_pending<std::string>();
+            promise->on_cancel([&] { cancelled = true; });
+            auto bounded = juro::timeout(promise, wheel, 10ms);
+
+            AND_WHEN("the promise settles in time") {
+                promise->resolve("Resolved"s);
+
+                THEN("the bounded promise must follow it and disarm its timer") {
+                    REQUIRE(bounded->is_resolved());
+                    REQUIRE(bounded->get_value() == "Resolved"s);
+                    REQUIRE(promise->get_value() == "Resolved"s);
+                    REQUIRE(wheel.empty());
+                    REQUIRE_FALSE(cancelled);
+                }
+            }
+
+            AND_WHEN("the deadline passes") {
+                wheel.advance(start + 50ms);
+
+                THEN("the bounded promise must be rejected with a `timeout_error`") {
+                    REQUIRE(bounded->is_rejected());
+                    REQUIRE(rescue(bounded->get_error()).holds_error<juro::timeout_error>());
+
+                    AND_THEN("the promise must be cancelled") {
+                        REQUIRE(cancelled);
+                        REQUIRE(promise->is_rejected());
+                    }
+                }
+            }
+        }
+
+        WHEN("a deadline is set on a concurrent promise") {
+            auto result = attempt([&] {
+                return juro::timeout(juro::make_concurrent<int>(), wheel, 10ms);
+            });
+
+            THEN("a `promise_error` must be thrown") {
+                REQUIRE(result.holds_error<promise_error>());
+            }
+        }
+    }
+
+    GIVEN("a timer wheel with a default executor") {
+        juro::queue_executor queue;
+        juro::timer_wheel wheel { 1ms, &queue };
+        const auto start = clock::now();
+        bool handled = false;
+        juro::delay(wheel, 1ms)->then([&] { handled = true; });
+
+        WHEN("the delay fires") {
+            wheel.advance(start + 10ms);
+
+            THEN("its continuation must be dispatched through the executor") {
+                REQUIRE_FALSE(handled);
+                queue.run();
+                REQUIRE(handled);
+            }
+        }
+    }
+}
+
+SCENARIO("failed attempts can be retried") {
+    using namespace std::chrono_literals;
+    using clock = juro::timer_wheel::clock;
+
+    GIVEN("a timer wheel and a factory failing twice") {
+        juro::timer_wheel wheel { 1ms };
+        const auto start = clock::now();
+        juro::retry_policy policy;
+        policy.max_attempts = 3;
+        policy.initial_delay = 10ms;
+        policy.jitter = 0.5;
+
+        int attempts = 0;
+        const auto factory = [&] {
+            attempts++;
+            return attempts < 3 ?
+                juro::make_rejected<int>("Rejected "s + std::to_string(attempts)) :
+                juro::make_resolved(attempts);
+        };
+
+        WHEN("it is retried") {
+            auto promise = juro::retry(wheel, policy, factory);
+
+            THEN("the second attempt must wait for the backoff") {
+                REQUIRE(attempts == 1);
+                REQUIRE(promise->is_pending());
+                REQUIRE(wheel.size() == 1);
+                wheel.advance(start + 4ms);
+                REQUIRE(attempts == 1);
+            }
+
+            AND_WHEN("the wheel advances past every backoff") {
+                wheel.advance(start + 1s);
+
+                THEN("the promise must resolve like the last attempt") {
+                    REQUIRE(attempts == 3);
+                    REQUIRE(promise->is_resolved());
+                    REQUIRE(promise->get_value() == 3);
+                    REQUIRE(wheel.empty());
+                }
+            }
+
+            AND_WHEN("it is cancelled while waiting") {
+                promise->cancel();
+
+                THEN("it must be rejected and disarmed") {
+                    REQUIRE(promise->is_rejected());
+                    REQUIRE(rescue(promise->get_error()).holds_error<cancellation_error>());
+                    REQUIRE(wheel.empty());
+                    REQUIRE(attempts == 1);
+                }
+            }
+        }
+
+        WHEN("it is retried with too few attempts") {
+            policy.max_attempts = 2;
+            auto promise = juro::retry(wheel, policy, factory);
+            promise->then([] (int) {  }, [] (std::exception_ptr) {  });
+            wheel.advance(start + 1s);
+
+            THEN("the promise must reject like the last attempt") {
+                REQUIRE(attempts == 2);
+                REQUIRE(promise->is_rejected());
+                REQUIRE(rescue(promise->get_error()).get_error<std::string>() == "Rejected 2"s);
+                REQUIRE(wheel.empty());
+            }
+        }
+
+        WHEN("it is retried with a predicate declining the rejection") {
+            auto promise = juro::retry(wheel, policy, factory, [] (const std::exception_ptr &error) {
+                auto reason = error;
+                return rescue(reason).get_error<std::string>() != "Rejected 1"s;
+            });
+
+            THEN("the promise must reject without retrying") {
+                REQUIRE(attempts == 1);
+                REQUIRE(promise->is_rejected());
+                REQUIRE(wheel.empty());
+            }
+        }
+
+        WHEN("a throwing factory is retried") {
+            auto promise = juro::retry(wheel, policy, [&] () -> juro::promise_ptr<int> {
+                attempts++;
+                throw "Thrown "s + std::to_string(attempts);
+            });
+            const bool armed = wheel.size() == 1;
+            wheel.advance(start + 1s);
+
+            THEN("every throw must count as a rejected attempt") {
+                REQUIRE(armed);
+                REQUIRE(attempts == 3);
+                REQUIRE(promise->is_rejected());
+                REQUIRE(rescue(promise->get_error()).get_error<std::string>() == "Thrown 3"s);
+            }
+        }
+    }
+
+    GIVEN("a timer wheel and a factory of attempts only the library holds") {
+        juro::timer_wheel wheel { 1ms };
+        std::size_t copies = 0;
+        auto root = juro::make_pending();
+        auto promise = juro::retry(wheel, juro::retry_policy {  }, [&] {
+            return root->then([&copies] { return copy_counter { copies }; });
+        });
+
+        WHEN("the attempt is resolved") {
+            root->resolve();
+
+            THEN("the value must be moved into the promise") {
+                REQUIRE(promise->is_resolved());
+                REQUIRE(copies == 0);
+            }
+        }
+    }
+
+    GIVEN("a timer wheel and a factory of pending attempts") {
+        juro::timer_wheel wheel { 1ms };
+        const auto start = clock::now();
+        bool cancelled = false;
+        std::vector<juro::promise_ptr<copy_counter>> attempts;
+        auto promise = juro::retry(wheel, juro::retry_policy {  }, [&] {
+            attempts.push_back(juro::make_pending<copy_counter>());
+            attempts.back()->on_cancel([&] { cancelled = true; });
+            return attempts.back();
+        });
+
+        WHEN("the first attempt is rejected and the second resolved") {
+            std::size_t copies = 0;
+            attempts.front()->reject("Rejected"s);
+            wheel.advance(start + 1s);
+            attempts.back()->resolve(copy_counter { copies });
+
+            THEN("the same promise must resolve with a copy the attempt keeps") {
+                REQUIRE(attempts.size() == 2);
+                REQUIRE(promise->is_resolved());
+                REQUIRE(copies == 1);
+                REQUIRE(attempts.back()->get_value().copies == &copies);
+            }
+        }
+
+        WHEN("it is cancelled during an attempt") {
+            promise->cancel();
+
+            THEN("the attempt must be cancelled and not retried") {
+                REQUIRE(cancelled);
+                REQUIRE(promise->is_rejected());
+                REQUIRE(rescue(promise->get_error()).holds_error<cancellation_error>());
+                REQUIRE(wheel.empty());
+                REQUIRE(attempts.size() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("promises can be shared among listeners") {
+    GIVEN("a shared promise only the library holds") {
+        std::size_t copies = 0;
+        auto root = juro::make_pending<int>();
+        auto shared = root->then([&copies] (int) { return copy_counter { copies }; })->share();
+
+        WHEN("the root promise is resolved") {
+            root->resolve(0);
+
+            THEN("the value must be moved into the shared promise") {
+                REQUIRE(shared->is_resolved());
+                REQUIRE(copies == 0);
+            }
+        }
+    }
+
+    GIVEN("a shared string promise the caller holds") {
+        auto promise = juro::make_pending<std::string>();
+        auto shared = promise->share();
+
+        WHEN("the promise is resolved") {
+            promise->resolve(std::string(100, 'z'));
+
+            THEN("both the promise and the shared promise must hold the value") {
+                REQUIRE(shared->get_value() == std::string(100, 'z'));
+                REQUIRE(promise->get_value() == std::string(100, 'z'));
+            }
+        }
+    }
+
+    GIVEN("a shared pending promise") {
+        std::size_t copies = 0;
+        auto promise = juro::make_pending<copy_counter>();
+        auto shared = promise->share();
+
+        WHEN("several listeners are attached and the promise is resolved") {
+            std::vector<const copy_counter *> received;
+            for(int index = 0; index < 5; index++) {
+                shared->then([&] (const copy_counter &value) { received.push_back(&value); });
+            }
+            promise->resolve(copy_counter { copies });
+
+            THEN("every listener must receive the single stored value") {
+                REQUIRE(shared->is_resolved());
+                REQUIRE(received.size() == 5);
+                for(auto *value : received) {
+                    REQUIRE(value == &shared->get_value());
+                }
+                REQUIRE(copies == 1);
+                REQUIRE(promise->is_resolved());
+            }
+
+            AND_WHEN("another listener is attached") {
+                const copy_counter *late = nullptr;
+                shared->then([&] (const copy_counter &value) { late = &value; });
+
+                THEN("it must be invoked immediately") {
+                    REQUIRE(late == &shared->get_value());
+                }
+            }
+        }
+
+        WHEN("the promise is forked and rejected") {
+            bool rejected = false;
+            shared->then(
+                [] (const copy_counter &) {  },
+                [&] (const std::exception_ptr &) { rejected = true; }
+            );
+            auto forked = shared->fork();
+            promise->reject("Rejected"s);
+
+            THEN("listeners and forks must receive the rejection") {
+                REQUIRE(shared->is_rejected());
+                REQUIRE(rejected);
+                REQUIRE(forked->is_rejected());
+                REQUIRE(rescue(forked->get_error()).get_error<std::string>() == "Rejected"s);
+            }
+        }
+    }
+
+    GIVEN("a concurrent promise") {
+        auto promise = juro::make_concurrent<int>();
+
+        WHEN("it is shared") {
+            auto result = attempt([&] { return promise->share(); });
+
+            THEN("a `promise_error` must be thrown") {
+                REQUIRE(result.holds_error<promise_error>());
+            }
+        }
+    }
+}
+
+SCENARIO("errors can be carried as values") {
+    const auto timed_out = std::make_error_code(std::errc::timed_out);
+
+    GIVEN("a pending result promise with a chain of resolve handlers") {
+        auto promise = juro::make_pending_result<int, std::error_code>();
+        int ran = 0;
+        auto last = promise
+            ->then([&] (int value) { ran++; return value * 2; })
+            ->then([&] (int value) { ran++; return std::to_string(value); });
+
+        WHEN("it is resolved") {
+            promise->resolve(21);
+
+            THEN("every handler must run") {
+                REQUIRE(ran == 2);
+                REQUIRE(last->get_value() == "42"s);
+            }
+        }
+
+        WHEN("it is rejected") {
+            promise->reject(timed_out);
+
+            THEN("the error must reach the last promise untouched") {
+                REQUIRE(ran == 0);
+                REQUIRE(last->is_rejected());
+                REQUIRE(last->get_error() == timed_out);
+            }
+
+            AND_WHEN("it is settled again") {
+                THEN("it must be left as is") {
+                    REQUIRE_FALSE(promise->resolve(1));
+                    REQUIRE(promise->get_error() == timed_out);
+                }
+            }
+        }
+
+        WHEN("the last promise is rescued and the promise rejected") {
+            auto rescued = last->rescue([] (std::error_code &error) { return error.message(); });
+            promise->reject(timed_out);
+
+            THEN("the reject handler must receive the error") {
+                REQUIRE(rescued->get_value() == timed_out.message());
+            }
+        }
+    }
+
+    GIVEN("a result promise whose handler returns a rejecting result promise") {
+        auto promise = juro::make_pending_result<int, std::error_code>();
+        std::error_code received;
+        auto last = promise
+            ->then([&] (int) { 
+                return juro::make_rejected_result<std::string>(timed_out); 
+            })
+            ->then(
+                [] (std::string &value) { return value.size(); },
+                [&] (std::error_code &error) { received = error; return std::size_t { 0 }; }
+            );
+
+        WHEN("it is resolved") {
+            promise->resolve(1);
+
+            THEN("the next reject handler must receive the error") {
+                REQUIRE(received == timed_out);
+                REQUIRE(last->get_value() == 0);
+            }
+        }
+    }
+
+    GIVEN("a handler returning a pending string result promise the caller holds") {
+        auto inner = juro::make_pending_result<std::string, std::error_code>();
+        auto last = juro::make_resolved_result<std::error_code>(1)
+            ->then([&] (int) { return inner; });
+
+        WHEN("the returned promise is resolved") {
+            inner->resolve(std::string(100, 'v'));
+
+            THEN("the chained promise must resolve with a copy of its value") {
+                REQUIRE(last->get_value() == std::string(100, 'v'));
+                REQUIRE(inner->get_value() == std::string(100, 'v'));
+            }
+        }
+    }
+
+    GIVEN("result promises composed with `all()`") {
+        auto first = juro::make_pending_result<std::string, std::error_code>();
+        auto second = juro::make_pending_result<void, std::error_code>();
+        auto promise = juro::all(first, second);
+
+        WHEN("every child is resolved") {
+            first->resolve(std::string(100, 'u'));
+            second->resolve();
+
+            THEN("the composed promise must resolve with their values") {
+                REQUIRE(std::get<0>(promise->get_value()) == std::string(100, 'u'));
+                REQUIRE(first->get_value() == std::string(100, 'u'));
+            }
+        }
+
+        WHEN("a child is rejected") {
+            second->reject(timed_out);
+            first->resolve("Resolved"s);
+
+            THEN("the composed promise must reject with its error") {
+                REQUIRE(promise->get_error() == timed_out);
+            }
+        }
+    }
+
+    GIVEN("a vector of result promises composed with `all()`") {
+        std::vector<juro::result_promise_ptr<int, std::error_code>> children {
+            juro::make_pending_result<int, std::error_code>(),
+            juro::make_pending_result<int, std::error_code>()
+        };
+        auto promise = juro::all(children);
+
+        WHEN("every child is resolved out of order") {
+            children[1]->resolve(2);
+            children[0]->resolve(1);
+
+            THEN("the composed promise must resolve with the values in order") {
+                REQUIRE(promise->get_value() == std::vector<int> { 1, 2 });
+            }
+        }
+    }
+
+    GIVEN("result promises composed with `race()`") {
+        auto first = juro::make_pending_result<int, std::error_code>();
+        auto second = juro::make_pending_result<int, std::error_code>();
+        auto promise = juro::race(first, second);
+
+        WHEN("a child is rejected first") {
+            second->reject(timed_out);
+            first->resolve(1);
+
+            THEN("the composed promise must reject with its error") {
+                REQUIRE(promise->get_error() == timed_out);
+            }
+        }
+
+        WHEN("a child is resolved first") {
+            first->resolve(1);
+            second->reject(timed_out);
+
+            THEN("the composed promise must resolve with its value") {
+                REQUIRE(promise->get_value() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("lookups can be cached by key") {
+    GIVEN("a promise cache and a loader of pending promises") {
+        using cache_type = juro::promise_cache<std::string, copy_counter>;
+        const auto start = cache_type::clock::now();
+        const auto ttl = std::chrono::seconds { 10 };
+        cache_type cache { 2, ttl };
+
+        std::size_t copies = 0;
+        std::vector<std::pair<std::string, juro::promise_ptr<copy_counter>>> loads;
+        const auto loader = [&] (const std::string &key) {
+            loads.emplace_back(key, juro::make_pending<copy_counter>());
+            return loads.back().second;
+        };
+
+        WHEN("a key is looked up several times while in flight") {
+            std::vector<const copy_counter *> received;
+            for(int index = 0; index < 3; index++) {
+                cache.get("a"s, loader, start)->then([&] (const copy_counter &value) {
+                    received.push_back(&value);
+                });
+            }
+            loads.front().second->resolve(copy_counter { copies });
+
+            THEN("it must be loaded once and fanned out from a single copy") {
+                REQUIRE(loads.size() == 1);
+                REQUIRE(received.size() == 3);
+                for(auto *value : received) {
+                    REQUIRE(value == received.front());
+                }
+                REQUIRE(copies == 1);
+            }
+
+            AND_WHEN("it is looked up again within its time-to-live") {
+                auto cached = cache.get("a"s, loader, start + ttl - std::chrono::seconds { 1 });
+
+                THEN("the resolved entry must be served") {
+                    REQUIRE(loads.size() == 1);
+                    REQUIRE(&cached->get_value() == received.front());
+                }
+            }
+
+            AND_WHEN("it is looked up again after its time-to-live") {
+                cache.get("a"s, loader, start + ttl);
+
+                THEN("it must be loaded anew") {
+                    REQUIRE(loads.size() == 2);
+                }
+            }
+        }
+
+        WHEN("an in-flight key outlives the time-to-live") {
+            auto first = cache.get("a"s, loader, start);
+            auto second = cache.get("a"s, loader, start + ttl * 2);
+
+            THEN("it must not expire while pending") {
+                REQUIRE(loads.size() == 1);
+                REQUIRE(first == second);
+            }
+        }
+
+        WHEN("a load is rejected") {
+            bool rejected = false;
+            cache.get("a"s, loader, start)->then(
+                [] (const copy_counter &) {  },
+                [&] (const std::exception_ptr &) { rejected = true; }
+            );
+            loads.front().second->reject("Rejected"s);
+
+            THEN("waiters must receive the rejection and the entry must be dropped") {
+                REQUIRE(rejected);
+                REQUIRE(cache.purge(start) == 1);
+                REQUIRE(cache.empty());
+            }
+
+            AND_WHEN("the key is looked up again") {
+                auto retried = cache.get("a"s, loader, start);
+
+                THEN("it must be loaded anew") {
+                    REQUIRE(loads.size() == 2);
+                    REQUIRE(retried->is_pending());
+                }
+            }
+        }
+
+        WHEN("more keys are looked up than the cache can hold") {
+            cache.get("a"s, loader, start);
+            cache.get("b"s, loader, start);
+            cache.get("a"s, loader, start);
+            cache.get("c"s, loader, start);
+
+            THEN("the least recently used entry must be dropped") {
+                REQUIRE(cache.size() == 2);
+                REQUIRE(cache.find("a"s, start) != nullptr);
+                REQUIRE(cache.find("b"s, start) == nullptr);
+                REQUIRE(cache.find("c"s, start) != nullptr);
+                REQUIRE(loads.size() == 3);
+            }
+        }
+
+        WHEN("a loader returns an already rejected promise") {
+            auto failed = cache.get(
+                "a"s,
+                [] (const std::string &) { return juro::make_rejected<copy_counter>("Rejected"s); },
+                start
+            );
+
+            THEN("the rejection must be returned but not cached") {
+                REQUIRE(failed->is_rejected());
+                REQUIRE(cache.empty());
+            }
+        }
+
+        for(auto &[key, promise] : loads) {
+            if(promise->is_pending()) {
+                promise->resolve(copy_counter { copies });
+            }
+        }
+    }
+}
+
+SCENARIO("concurrent promises should settle exactly once across threads") {
+    GIVEN("a concurrent promise") {
+        auto promise = juro::make_concurrent<int>();
+
+        THEN("it must be pending and concurrent") {
+            REQUIRE(promise->is_pending());
+            REQUIRE(promise->is_concurrent());
+        }
+
+        WHEN("it is rejected before a handler is attached") {
+            auto result = attempt([&] { promise->reject("Rejected"s); });
+
+            THEN("no exception must be thrown") {
+                REQUIRE(result.has_value());
+                REQUIRE(promise->is_rejected());
+            }
+
+            AND_WHEN("a reject handler is attached") {
+                std::string message;
+                auto next = promise->rescue([&] (std::exception_ptr &error) {
+                    message = rescue(error).get_error<std::string>();
+                    return 0;
+                });
+
+                THEN("it must be invoked immediately") {
+                    REQUIRE(message == "Rejected"s);
+                    REQUIRE(next->is_resolved());
+                    REQUIRE(next->is_concurrent());
+                }
+            }
+        }
+
+        WHEN("a handler is attached") {
+            auto next = promise->then([] (int value) { return value + 1; });
+
+            THEN("attaching another one must throw a `promise_error`") {
+                auto result = attempt([&] { promise->then([] (int) {  }); });
+                REQUIRE(result.holds_error<promise_error>());
+            }
+
+            AND_WHEN("it is resolved twice") {
+                promise->resolve(1);
+                auto result = attempt([&] { promise->resolve(2); });
+
+                THEN("the second resolution must throw a `promise_error`") {
+                    REQUIRE(result.holds_error<promise_error>());
+                    REQUIRE(next->get_value() == 2);
+                }
+            }
+        }
+    }
+
+    GIVEN("many concurrent promises") {
+        constexpr int count = 2000;
+        std::vector<juro::promise_ptr<int>> promises;
+        for(int i = 0; i < count; i++) {
+            promises.push_back(juro::make_concurrent<int>());
+        }
+
+        WHEN("they are resolved on a thread while handlers are attached on another") {
+            std::atomic<int> invocations = 0;
+            std::atomic<long> sum = 0;
+
+            std::thread producer { [&] {
+                for(int i = 0; i < count; i++) {
+                    promises[i]->resolve(i);
+                }
+            } };
+            for(auto &promise : promises) {
+                promise->then([&] (int value) {
+                    invocations++;
+                    sum += value;
+                });
+            }
+            producer.join();
+
+            THEN("every handler must run exactly once with its value") {
+                REQUIRE(invocations == count);
+                REQUIRE(sum == static_cast<long>(count) * (count - 1) / 2);
+            }
+        }
+
+        WHEN("several threads compete to resolve them") {
+            std::atomic<int> invocations = 0;
+            std::atomic<int> failures = 0;
+            for(auto &promise : promises) {
+                promise->then([&] (int) { invocations++; });
+            }
+
+            std::vector<std::thread> producers;
+            for(int t = 0; t < 4; t++) {
+                producers.emplace_back([&, t] {
+                    for(auto &promise : promises) {
+                        try { promise->resolve(t); }
+                        catch(promise_error &) { failures++; }
+                    }
+                });
+            }
+            for(auto &producer : producers) {
+                producer.join();
+            }
+
+            THEN("only one resolution per promise must succeed") {
+                REQUIRE(invocations == count);
+                REQUIRE(failures == count * 3);
+            }
+        }
+    }
+}
+
+SCENARIO("settle handlers may be move-only") {
+    GIVEN("a pending promise") {
+        auto promise = juro::make_pending<int>();
+
+        WHEN("`then()` is called with a handler that captures a move-only value") {
+            auto next = promise->then([
+                factor = std::make_unique<int>(3)
+            ] (int value) { 
+                return value * *factor; 
+            });
+
+            THEN("a settle handler must be attached") {
+                REQUIRE(promise->has_handler());
+            }
+
+            AND_WHEN("the promise is resolved") {
+                promise->resolve(10);
+
+                THEN("the chained promise must be resolved with the handler's result") {
+                    REQUIRE(next->is_resolved());
+                    REQUIRE(next->get_value() == 30);
+                }
+            }
+        }
+    }
+
+    GIVEN("a settle handler type") {
+        WHEN("it wraps a closure the size of a typical continuation") {
+            int factor = 2;
+            auto pointer = juro::make_pending<int>();
+            auto closure = [
+                self = pointer.get(),
+                pointer,
+                on_resolve = [&factor] (int value) { return value * factor; }
+            ] { };
+
+            THEN("it must be stored without dynamic allocation") {
+                STATIC_REQUIRE(juro::settle_handler::stores_inline<decltype(closure)>());
+            }
+        }
+
+        WHEN("it wraps a closure larger than its buffer") {
+            struct large { char bytes[JURO_FUNCTION_BUFFER_SIZE * 2]; };
+            auto counter = std::make_shared<int>(0);
+            juro::settle_handler handler { [counter, payload = large {  }] { 
+                ++*counter; 
+            } };
+
+            THEN("it must still be moved and invoked correctly") {
+                STATIC_REQUIRE_FALSE(
+                    juro::settle_handler::stores_inline<large>()
+                );
+                auto moved = std::move(handler);
+                REQUIRE_FALSE(static_cast<bool>(handler));
+                moved();
+                REQUIRE(*counter == 1);
+                moved = nullptr;
+                REQUIRE(counter.use_count() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("continuations can be dispatched through executors") {
+    GIVEN("a queue executor and a pending promise") {
+        juro::queue_executor queue;
+        auto promise = juro::make_pending<int>();
+
+        WHEN("a resolve handler is attached through the executor") {
+            bool handled = false;
+            auto next = promise->then(queue, [&] (int value) { 
+                handled = true;
+                return value * 2; 
+            });
+
+            AND_WHEN("the promise is resolved") {
+                promise->resolve(10);
+
+                THEN("the handler must not run until the queue is drained") {
+                    REQUIRE_FALSE(handled);
+                    REQUIRE(next->is_pending());
+                    REQUIRE(queue.size() == 1);
+
+                    AND_THEN("draining the queue must run it") {
+                        REQUIRE(queue.run() == 1);
+                        REQUIRE(handled);
+                        REQUIRE(next->get_value() == 20);
+                    }
+                }
+            }
+        }
+
+        WHEN("a reject handler is attached through the executor") {
+            auto next = promise->rescue(queue, [] (std::exception_ptr &) { 
+                return -1; 
+            });
+
+            AND_WHEN("the promise is rejected") {
+                auto result = attempt([&] { promise->reject("Rejected"s); });
+                queue.run();
+
+                THEN("the handler must run when the queue is drained") {
+                    REQUIRE(result.has_value());
+                    REQUIRE(next->get_value() == -1);
+                }
+            }
+        }
+
+        WHEN("the executor is set as the promise's default") {
+            std::vector<int> order;
+            auto last = promise->via(queue)
+                ->then([&] (int value) { order.push_back(1); return value + 1; })
+                ->finally([&] (auto &) { order.push_back(2); });
+
+            AND_WHEN("the promise is resolved") {
+                promise->resolve(0);
+                order.push_back(0);
+
+                THEN("every chained continuation must be dispatched through it") {
+                    REQUIRE(last->get_executor() == &queue);
+                    REQUIRE(order == std::vector<int> { 0 });
+                    REQUIRE(queue.run_pending() == 1);
+                    REQUIRE(order == std::vector<int> { 0, 1 });
+                    REQUIRE(queue.run_pending() == 1);
+                    REQUIRE(order == std::vector<int> { 0, 1, 2 });
+                    REQUIRE(last->is_resolved());
+                }
+            }
+        }
+    }
+
+    GIVEN("a thread pool and a concurrent promise") {
+        juro::thread_pool pool { 2 };
+        auto promise = juro::make_concurrent<int>();
+
+        WHEN("a handler is attached through the pool and the promise is resolved") {
+            std::atomic<std::thread::id> worker;
+            std::atomic<bool> done = false;
+            promise->then(pool, [&] (int value) {
+                worker = std::this_thread::get_id();
+                done = true;
+                return value;
+            });
+            promise->resolve(1);
+
+            while(!done) {
+                std::this_thread::yield();
+            }
+
+            THEN("the handler must have run on a worker thread") {
+                REQUIRE(worker.load() != std::this_thread::get_id());
+            }
+        }
+    }
+}
+
+SCENARIO("work can be run asynchronously on a thread pool") {
+    GIVEN("a thread pool") {
+        juro::thread_pool pool { 4 };
+
+        WHEN("value, void, promise and throwing functions are run with `async()`") {
+            auto value = juro::async(pool, [] { return 42; });
+            auto nothing = juro::async(pool, [] {  });
+            auto chained = juro::async(pool, [] { 
+                return juro::make_resolved(std::string { "chained" }); 
+            });
+            auto failed = juro::async(pool, [] () -> int { 
+                throw std::runtime_error { "failed" }; 
+            });
+
+            for(auto *promise : std::initializer_list<juro::promise_interface *> {
+                value.get(), nothing.get(), chained.get(), failed.get()
+            }) {
+                while(!promise->is_settled()) {
+                    std::this_thread::yield();
+                }
+            }
+
+            THEN("each promise must be settled with the function's outcome") {
+                REQUIRE(value->is_concurrent());
+                REQUIRE(value->get_value() == 42);
+                REQUIRE(nothing->is_resolved());
+                REQUIRE(chained->get_value() == "chained");
+                REQUIRE(failed->is_rejected());
+            }
+        }
+
+        WHEN("a task throws") {
+            std::atomic<bool> done = false;
+            pool.schedule([] { throw std::runtime_error { "failed" }; });
+            pool.schedule([&] { done = true; });
+
+            while(!done) {
+                std::this_thread::yield();
+            }
+
+            THEN("the exception must be dropped and later tasks must still run") {
+                REQUIRE(done);
+            }
+        }
+
+        WHEN("tasks spawn further tasks from worker threads") {
+            constexpr std::size_t width = 64;
+            std::atomic<std::size_t> completed = 0;
+            std::atomic<bool> on_workers = true;
+
+            for(std::size_t outer = 0; outer < width; outer++) {
+                pool.schedule([&] {
+                    if(!pool.is_worker_thread()) {
+                        on_workers = false;
+                    }
+                    for(std::size_t inner = 0; inner < width; inner++) {
+                        pool.schedule([&] { completed++; });
+                    }
+                });
+            }
+
+            while(completed < width * width) {
+                std::this_thread::yield();
+            }
+
+            THEN("every task must run exactly once") {
+                REQUIRE(completed == width * width);
+                REQUIRE(on_workers);
+                REQUIRE_FALSE(pool.is_worker_thread());
+            }
+        }
+
+        WHEN("`all()` is called on promises settled by the pool") {
+            constexpr int count = 256;
+            std::vector<juro::promise_ptr<int>> children;
+            for(int index = 0; index < count; index++) {
+                children.push_back(juro::async(pool, [index] { return index; }));
+            }
+
+            std::atomic<int> sum = 0;
+            std::atomic<int> joined = 0;
+            for(int index = 0; index < count; index += 4) {
+                juro::all(
+                    children[index], children[index + 1], 
+                    children[index + 2], children[index + 3]
+                )->then([&] (auto &values) {
+                    sum += std::get<0>(values) + std::get<1>(values) + 
+                        std::get<2>(values) + std::get<3>(values);
+                    joined++;
+                });
+            }
+
+            while(joined < count / 4) {
+                std::this_thread::yield();
+            }
+
+            THEN("every composition must resolve with its children's values") {
+                REQUIRE(sum == count * (count - 1) / 2);
+            }
+        }
+    }
+}
+
+SCENARIO("promises should be composable") {
+    GIVEN("a promise composition function `all()`") {
+        WHEN("called with three promises of different types") {
+            auto p1 = juro::make_pending<int>();
+            auto p2 = juro::make_pending<std::string>();
+            auto p3 = juro::make_pending();
+
+            auto all_result = attempt([&] {
+                return juro::all(p1, p2, p3);
+            });
+
+            THEN("it must not throw an exception") {
+                REQUIRE_FALSE(all_result.has_error());
+
+                AND_THEN("it must return a pending promise") {
+                    REQUIRE(all_result.has_value());
+                    REQUIRE(all_result.get_value()->is_pending());
+                }
+            }
+
+            AND_WHEN("some promises are resolved") {
+                auto &promise = all_result.get_value();
+                p1->resolve(10);
+                p3->resolve();
+
+                THEN("the returned promise must still be pending") {
+                    REQUIRE(promise->is_pending());
+                }
+
+                AND_WHEN("all promises are resolved") {
+                    p2->resolve("resolved");
+
+                    THEN("the returned promise must be resolved with correct values") {
+                        REQUIRE(promise->is_resolved());
+                        REQUIRE(promise->get_value() == 
+                            std::make_tuple(10, "resolved"s, void_type { })
+                        );
+                    }
+                }
+            }
+
+            AND_WHEN("any promise is rejected") {
+                auto p2_result = attempt([&] { p2->reject("Rejected"s); });
+                auto &promise = all_result.get_value();
+
+                THEN("a `promise_error` must be thrown") {
+                    REQUIRE(p2_result.has_error());
+                    REQUIRE(p2_result.holds_error<promise_error>());
+                    REQUIRE(p2_result.get_error<promise_error>().what() ==
+                        "Unhandled promise rejection"s
+                    );
+
+                    AND_THEN("the returned promise must be rejected with 'Rejected'") {
+                        REQUIRE(promise->is_rejected());
+                        REQUIRE(rescue(promise->get_error())
+                            .get_error<std::string>() == "Rejected"s
+                        );
+                    }
+                }
+
+                AND_WHEN("other promises are resolved") {
+                    auto p1_result = attempt([&] { p1->resolve(0); });
+
+                    THEN("no exception should be thrown") {
+                        REQUIRE(p1_result.has_value());
+
+                        AND_THEN("the returned promise must retain its value") {
+                            REQUIRE(promise->is_rejected());
+                            REQUIRE(rescue(promise->get_error())
+                                .get_error<std::string>() == "Rejected"s
+                            );
+                        }
+                    }
+                }
+
+                AND_WHEN("other promises are rejected") {
+                    auto p3_result = attempt([&] { p3->reject("Invalid"s); });
+
+                    THEN("no exception should be thrown") {
+                        REQUIRE(p3_result.has_value());
+
+                        AND_THEN("the returned promise must retain its value") {
+                            REQUIRE(promise->is_rejected());
+                            REQUIRE(rescue(promise->get_error())
+                                .get_error<std::string>() == "Rejected"s
+                            );
+                        }
+                    }
+                }
+            }
+        }
+
+        WHEN("called with only void promises") {
+            auto p1 = juro::make_pending();
+            auto p2 = juro::make_pending();
+            auto p3 = juro::make_pending();
+
+            auto all_result = attempt([&] {
+                return juro::all(p1, p2, p3);
+            });
+
+            THEN("it must not throw an exception") {
+                REQUIRE_FALSE(all_result.has_error());
+
+                AND_THEN("the type of the returned promise must also be void") {
+                    STATIC_REQUIRE(
+                        std::is_same_v<decltype(all_result)::value_type, juro::promise_ptr<void>>
+                    );
+                }
+            }
+        }
+
+        WHEN("called with promises only the library holds") {
+            std::size_t copies = 0;
+            auto first = juro::make_pending<int>();
+            auto second = juro::make_pending<int>();
+            auto make_counter = [&copies] (int) { return copy_counter { copies }; };
+            auto shared = juro::make_pending<copy_counter>();
+
+            auto promise = juro::all(
+                first->then(make_counter), 
+                second->then(make_counter),
+                shared
+            );
+            first->resolve(0);
+            second->resolve(0);
+
+            THEN("their values must be moved into the result") {
+                REQUIRE(copies == 0);
+
+                AND_WHEN("a promise the caller holds is resolved") {
+                    shared->resolve(copy_counter { copies });
+
+                    THEN("its value must be copied and remain readable") {
+                        REQUIRE(promise->is_resolved());
+                        REQUIRE(copies == 1);
+                        REQUIRE(shared->get_value().copies == &copies);
+                    }
+                }
+            }
+        }
+
+        WHEN("called with promises the caller resolves") {
+            auto p1 = juro::make_pending<std::string>();
+            auto p2 = juro::make_pending<std::string>();
+            auto promise = juro::all(p1, p2);
+            p1->resolve(std::string(100, 'x'));
+            p2->resolve(std::string(100, 'y'));
+
+            THEN("their values must still be readable afterwards") {
+                REQUIRE(promise->is_resolved());
+                REQUIRE(std::get<0>(promise->get_value()) == std::string(100, 'x'));
+                REQUIRE(p1->get_value() == std::string(100, 'x'));
+                REQUIRE(p2->get_value() == std::string(100, 'y'));
+            }
+        }
+
+        WHEN("called with a vector of promises") {
+            std::vector<juro::promise_ptr<int>> promises;
+            for(int index = 0; index < 8; index++) {
+                promises.push_back(juro::make_pending<int>());
+            }
+
+            auto promise = juro::all(promises);
+
+            THEN("it must return a pending promise of a vector") {
+                STATIC_REQUIRE(
+                    std::is_same_v<decltype(promise), juro::promise_ptr<std::vector<int>>>
+                );
+                REQUIRE(promise->is_pending());
+            }
+
+            AND_WHEN("the promises are resolved out of order") {
+                for(int index = 7; index >= 0; index--) {
+                    promises[index]->resolve(index * 10);
+                }
+
+                THEN("the returned promise must hold the values in range order") {
+                    REQUIRE(promise->is_resolved());
+                    REQUIRE(promise->get_value() == 
+                        std::vector<int> { 0, 10, 20, 30, 40, 50, 60, 70 }
+                    );
+                }
+            }
+
+            AND_WHEN("any promise is rejected") {
+                promise->rescue([] (std::exception_ptr &) { return std::vector<int> {  }; });
+                promises[3]->reject("Rejected"s);
+                auto other_result = attempt([&] { promises[4]->resolve(4); });
+
+                THEN("the returned promise must be rejected with the same error") {
+                    REQUIRE(promise->is_rejected());
+                    REQUIRE(rescue(promise->get_error())
+                        .get_error<std::string>() == "Rejected"s
+                    );
+
+                    AND_THEN("later settlements must be ignored") {
+                        REQUIRE(other_result.has_value());
+                    }
+                }
+            }
+        }
+
+        WHEN("called with an iterator range of void promises") {
+            std::vector<juro::promise_ptr<void>> promises { 
+                juro::make_pending(), juro::make_resolved(), juro::make_pending() 
+            };
+
+            auto promise = juro::all(promises.begin(), promises.end());
+
+            THEN("it must return a void promise") {
+                STATIC_REQUIRE(
+                    std::is_same_v<decltype(promise), juro::promise_ptr<void>>
+                );
+                REQUIRE(promise->is_pending());
+            }
+
+            AND_WHEN("every promise is resolved") {
+                promises[0]->resolve();
+                promises[2]->resolve();
+
+                THEN("the returned promise must be resolved") {
+                    REQUIRE(promise->is_resolved());
+                }
+            }
+        }
+
+        WHEN("called with an empty range") {
+            std::vector<juro::promise_ptr<std::string>> promises;
+            auto promise = juro::all(promises);
+
+            THEN("the returned promise must be resolved with an empty vector") {
+                REQUIRE(promise->is_resolved());
+                REQUIRE(promise->get_value().empty());
+            }
+        }
+
+    }
+
+    GIVEN("a promise composition function `race()`") {
+        WHEN("called with promises of repeated types") {
+            auto promise = juro::race(
+                juro::make_pending<int>(), 
+                juro::make_pending<std::string>(), 
+                juro::make_pending<int>(), 
+                juro::make_pending(),
+                juro::make_pending<std::string>()
+            );
+
+            THEN("it must resolve to a variant of the unique types, in order") {
+                STATIC_REQUIRE(std::is_same_v<
+                    decltype(promise), 
+                    juro::promise_ptr<std::variant<int, std::string, juro::void_type>>
+                >);
+            }
+        }
+
+        WHEN("called with three promises of different types") {
+            auto p1 = juro::make_pending<int>();
+            auto p2 = juro::make_pending<std::string>();
+            auto p3 = juro::make_pending();
+
+            auto race_result = attempt([&] { return juro::race(p1, p2, p3); });
+
+            THEN("it must not throw an exception") {
+                REQUIRE_FALSE(race_result.has_error());
+
+                AND_THEN("it must return a pending promise") {
+                    REQUIRE(race_result.has_value());
+                    REQUIRE(race_result.get_value()->is_pending());
+                }
+            }
+
+            AND_WHEN("a promise is resolved with some value") {
+                auto &promise = race_result.get_value();
+                p2->resolve("Resolved"s);
+
+                THEN("the returned promise must be resolved with the same value") {
+                    REQUIRE(promise->is_resolved());
+                    REQUIRE(std::holds_alternative<std::string>(promise->get_value()));
+                    REQUIRE(std::get<std::string>(promise->get_value()) == "Resolved"s);
+                    REQUIRE(p2->get_value() == "Resolved"s);
+                }
+
+                AND_WHEN("another promise is resolved") {
+                    auto p3_result = attempt([&] { p3->resolve(); });
+
+                    THEN("no exception must be thrown") {
+                        REQUIRE_FALSE(p3_result.has_error());
+
+                        AND_THEN("the returned promise must retain its value") {
                             REQUIRE(promise->is_resolved());
                             REQUIRE(std::holds_alternative<std::string>(promise->get_value()));
                             REQUIRE(std::get<std::string>(promise->get_value()) == 
@@ -437,75 +2415,751 @@ SCENARIO("promises should be composable") {
                     }
 
                     AND_WHEN("the last promise is rejected") {
-                        auto p1_result = attempt([&] { p1->reject(100); });
+                        auto p1_result = attempt([&] { p1->reject(100); });
+
+                        THEN("no exception must be thrown") {
+                            REQUIRE_FALSE(p1_result.has_error());
+
+                            AND_THEN("the returned promise must retain its value") {
+                                REQUIRE(promise->is_resolved());
+                                REQUIRE(std::holds_alternative<std::string>(promise->get_value()));
+                                REQUIRE(std::get<std::string>(promise->get_value()) == 
+                                    "Resolved"s
+                                );
+                            }
+                        }
+                    }
+                }
+            }
+
+            AND_WHEN("a promise is rejected with some value") {
+                auto &promise = race_result.get_value();
+                auto p2_result = attempt([&] { p2->reject("Rejected"s); });
+
+                THEN("a `promise_error` exception must be thrown") {
+                    REQUIRE(p2_result.has_error());
+                    REQUIRE(p2_result.holds_error<promise_error>());
+                    REQUIRE(p2_result.get_error<promise_error>().what() == 
+                        "Unhandled promise rejection"s
+                    );
+                }
+
+                THEN("the returned promise must be rejected with the same value") {
+                    REQUIRE(promise->is_rejected());
+                    REQUIRE(rescue(promise->get_error()).holds_error<std::string>());
+                    REQUIRE(rescue(promise->get_error())
+                        .get_error<std::string>() == "Rejected"s
+                    );
+                }
+
+                AND_WHEN("another promise is resolved") {
+                    auto p3_result = attempt([&] { p3->resolve(); });
+
+                    THEN("no exception must be thrown") {
+                        REQUIRE_FALSE(p3_result.has_error());
+
+                        AND_THEN("the returned promise must retain its value") {
+                            REQUIRE(promise->is_rejected());
+                            REQUIRE(rescue(promise->get_error()).holds_error<std::string>());
+                            REQUIRE(rescue(promise->get_error())
+                                .get_error<std::string>() == "Rejected"s
+                            );
+                        }
+                    }
+
+                    AND_WHEN("the last promise is rejected") {
+                        auto p1_result = attempt([&] { p1->reject(100); });
+
+                        THEN("no exception must be thrown") {
+                            REQUIRE_FALSE(p1_result.has_error());
+
+                            AND_THEN("the returned promise must retain its value") {
+                                REQUIRE(promise->is_rejected());
+                                REQUIRE(rescue(promise->get_error()).holds_error<std::string>());
+                                REQUIRE(rescue(promise->get_error())
+                                    .get_error<std::string>() == "Rejected"s
+                                );
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        WHEN("the losers registered cancel callbacks") {
+            auto p1 = juro::make_pending<int>();
+            auto p2 = juro::make_pending<int>();
+            auto p3 = juro::make_pending<int>();
+            int cancelled = 0;
+            p1->on_cancel([&] { cancelled++; });
+            p2->on_cancel([&] { cancelled++; });
+            p3->on_cancel([&] { cancelled++; });
+            auto promise = juro::race(p1, p2, p3);
+
+            AND_WHEN("a promise is resolved") {
+                p2->resolve(10);
+
+                THEN("every pending loser must be cancelled") {
+                    REQUIRE(promise->is_resolved());
+                    REQUIRE(promise->get_value() == 10);
+                    REQUIRE(cancelled == 2);
+                    REQUIRE(rescue(p1->get_error()).holds_error<cancellation_error>());
+                    REQUIRE(rescue(p3->get_error()).holds_error<cancellation_error>());
+                }
+
+                THEN("the losers must not keep the returned promise alive") {
+                    REQUIRE(promise->use_count() == 1);
+                }
+            }
+        }
+
+        WHEN("a promise was settled before the others were attached") {
+            auto p2 = juro::make_pending<int>();
+            int cancelled = 0;
+            p2->on_cancel([&] { cancelled++; });
+            auto promise = juro::race(juro::make_resolved(10), p2);
+
+            THEN("the returned promise must be resolved and the others cancelled") {
+                REQUIRE(promise->is_resolved());
+                REQUIRE(promise->get_value() == 10);
+                REQUIRE(cancelled == 1);
+                REQUIRE(rescue(p2->get_error()).holds_error<cancellation_error>());
+            }
+        }
+
+        WHEN("called with a vector of promises") {
+            std::vector<juro::promise_ptr<int>> promises;
+            int cancelled = 0;
+            for(int index = 0; index < 4; index++) {
+                promises.push_back(juro::make_pending<int>());
+                promises.back()->on_cancel([&] { cancelled++; });
+            }
+            auto promise = juro::race(promises);
+
+            THEN("it must return a pending promise") {
+                STATIC_REQUIRE(std::is_same_v<decltype(promise), juro::promise_ptr<int>>);
+                REQUIRE(promise->is_pending());
+            }
+
+            AND_WHEN("a promise is rejected") {
+                auto result = attempt([&] { promises[2]->reject(100); });
+
+                THEN("the returned promise must be rejected the same way") {
+                    REQUIRE(result.holds_error<promise_error>());
+                    REQUIRE(promise->is_rejected());
+                    REQUIRE(rescue(promise->get_error()).get_error<int>() == 100);
+                }
+
+                THEN("every other promise must be cancelled") {
+                    REQUIRE(cancelled == 3);
+                    REQUIRE(rescue(promises[0]->get_error()).holds_error<cancellation_error>());
+                    REQUIRE(rescue(promises[3]->get_error()).holds_error<cancellation_error>());
+                }
+            }
+        }
+
+        WHEN("called with an empty vector") {
+            auto promise = juro::race(std::vector<juro::promise_ptr<int>> {  });
+
+            THEN("the returned promise must never settle") {
+                REQUIRE(promise->is_pending());
+            }
+        }
+    }
+
+    GIVEN("a promise composition function `all_settled()`") {
+        WHEN("called with promises of different types") {
+            auto p1 = juro::make_pending<int>();
+            auto p2 = juro::make_pending<std::string>();
+            auto p3 = juro::make_pending();
+
+            auto promise = juro::all_settled(p1, p2, p3);
+
+            AND_WHEN("some promises are resolved and others rejected") {
+                p1->resolve(10);
+                auto p2_result = attempt([&] { p2->reject("Rejected"s); });
+
+                THEN("no exception must be thrown") {
+                    REQUIRE(p2_result.has_value());
+
+                    AND_THEN("the returned promise must wait for the last one") {
+                        REQUIRE(promise->is_pending());
+                    }
+                }
+
+                AND_WHEN("the last promise is settled") {
+                    p3->resolve();
+
+                    THEN("the returned promise must hold every outcome") {
+                        REQUIRE(promise->is_resolved());
+                        auto &[ o1, o2, o3 ] = promise->get_value();
+                        REQUIRE(std::get<int>(o1) == 10);
+                        REQUIRE(rescue(std::get<std::exception_ptr>(o2))
+                            .get_error<std::string>() == "Rejected"s
+                        );
+                        REQUIRE(std::holds_alternative<void_type>(o3));
+                    }
+                }
+            }
+        }
+
+        WHEN("called with string promises the caller resolves") {
+            auto p1 = juro::make_pending<std::string>();
+            auto promise = juro::all_settled(p1);
+            p1->resolve(std::string(100, 'x'));
+
+            THEN("their values must still be readable afterwards") {
+                REQUIRE(promise->is_resolved());
+                REQUIRE(std::get<1>(std::get<0>(promise->get_value())) == std::string(100, 'x'));
+                REQUIRE(p1->get_value() == std::string(100, 'x'));
+            }
+        }
+
+        WHEN("called with a vector of promises") {
+            std::vector<juro::promise_ptr<int>> promises {
+                juro::make_pending<int>(), juro::make_rejected<int>(), juro::make_resolved(3)
+            };
+
+            auto promise = juro::all_settled(promises);
+            promises[0]->resolve(1);
+
+            THEN("the returned promise must hold every outcome in order") {
+                REQUIRE(promise->is_resolved());
+                auto &outcomes = promise->get_value();
+                REQUIRE(outcomes.size() == 3);
+                REQUIRE(std::get<int>(outcomes[0]) == 1);
+                REQUIRE(std::holds_alternative<std::exception_ptr>(outcomes[1]));
+                REQUIRE(std::get<int>(outcomes[2]) == 3);
+            }
+        }
+    }
+
+    GIVEN("a promise composition function `any()`") {
+        WHEN("called with three promises") {
+            auto p1 = juro::make_pending<int>();
+            auto p2 = juro::make_pending<std::string>();
+            auto p3 = juro::make_pending<int>();
+
+            auto promise = juro::any(p1, p2, p3);
+
+            THEN("it must return a pending promise of a variant") {
+                STATIC_REQUIRE(std::is_same_v<
+                    decltype(promise), 
+                    juro::promise_ptr<std::variant<int, std::string>>
+                >);
+                REQUIRE(promise->is_pending());
+            }
+
+            AND_WHEN("a promise is rejected") {
+                p1->reject("Rejected"s);
+
+                THEN("the returned promise must still be pending") {
+                    REQUIRE(promise->is_pending());
+                }
+
+                AND_WHEN("another promise is resolved") {
+                    p2->resolve("Resolved"s);
+
+                    THEN("the returned promise must be resolved with its value") {
+                        REQUIRE(promise->is_resolved());
+                        REQUIRE(std::get<std::string>(promise->get_value()) == "Resolved"s);
+                        REQUIRE(p2->get_value() == "Resolved"s);
+                    }
+
+                    AND_WHEN("the last promise is rejected") {
+                        auto p3_result = attempt([&] { p3->reject("Late"s); });
 
                         THEN("no exception must be thrown") {
-                            REQUIRE_FALSE(p1_result.has_error());
-
-                            AND_THEN("the returned promise must retain its value") {
-                                REQUIRE(promise->is_resolved());
-                                REQUIRE(std::holds_alternative<std::string>(promise->get_value()));
-                                REQUIRE(std::get<std::string>(promise->get_value()) == 
-                                    "Resolved"s
-                                );
-                            }
+                            REQUIRE(p3_result.has_value());
+                            REQUIRE(promise->is_resolved());
                         }
                     }
                 }
             }
 
-            AND_WHEN("a promise is rejected with some value") {
-                auto &promise = race_result.get_value();
-                auto p2_result = attempt([&] { p2->reject("Rejected"s); });
+            AND_WHEN("every promise is rejected") {
+                promise->rescue([] (std::exception_ptr &) { 
+                    return std::variant<int, std::string> { 0 }; 
+                });
+                p1->reject("First"s);
+                p2->reject("Second"s);
+                p3->reject("Third"s);
 
-                THEN("a `promise_error` exception must be thrown") {
-                    REQUIRE(p2_result.has_error());
-                    REQUIRE(p2_result.holds_error<promise_error>());
-                    REQUIRE(p2_result.get_error<promise_error>().what() == 
-                        "Unhandled promise rejection"s
-                    );
+                THEN("the returned promise must be rejected with every reason") {
+                    REQUIRE(promise->is_rejected());
+                    auto error = rescue(promise->get_error());
+                    REQUIRE(error.holds_error<juro::aggregate_error>());
+                    auto &reasons = error.get_error<juro::aggregate_error>().errors();
+                    REQUIRE(reasons.size() == 3);
+                    auto second = reasons[1];
+                    REQUIRE(rescue(second).get_error<std::string>() == "Second"s);
                 }
+            }
+        }
 
-                THEN("the returned promise must be rejected with the same value") {
-                    REQUIRE(promise->is_rejected());
-                    REQUIRE(rescue(promise->get_error()).holds_error<std::string>());
-                    REQUIRE(rescue(promise->get_error())
-                        .get_error<std::string>() == "Rejected"s
-                    );
+        WHEN("a winner arrives while other promises are pending") {
+            std::vector<juro::promise_ptr<int>> promises {
+                juro::make_pending<int>(), juro::make_pending<int>(), juro::make_pending<int>()
+            };
+
+            auto promise = juro::any(promises);
+            promises[1]->resolve(1);
+
+            THEN("the returned promise must be resolved with the winner's value") {
+                REQUIRE(promise->get_value() == 1);
+
+                AND_THEN("no child must reference the composition anymore") {
+                    REQUIRE(promises[0]->is_pending());
+                    REQUIRE(promise.use_count() == 1);
                 }
+            }
+        }
 
-                AND_WHEN("another promise is resolved") {
-                    auto p3_result = attempt([&] { p3->resolve(); });
+        WHEN("called with an empty range") {
+            std::vector<juro::promise_ptr<int>> promises;
+            auto promise = juro::any(promises);
 
-                    THEN("no exception must be thrown") {
-                        REQUIRE_FALSE(p3_result.has_error());
+            THEN("the returned promise must be rejected") {
+                REQUIRE(promise->is_rejected());
+            }
+        }
+    }
 
-                        AND_THEN("the returned promise must retain its value") {
-                            REQUIRE(promise->is_rejected());
-                            REQUIRE(rescue(promise->get_error()).holds_error<std::string>());
-                            REQUIRE(rescue(promise->get_error())
-                                .get_error<std::string>() == "Rejected"s
-                            );
+    GIVEN("a composition function `map_limit()` and a range of elements") {
+        std::vector<int> elements(10);
+        for(int index = 0; index < 10; index++) {
+            elements[index] = index;
+        }
+
+        WHEN("the elements are mapped into pending promises, three at a time") {
+            std::vector<juro::promise_ptr<int>> children;
+            auto promise = juro::map_limit(elements, 3, [&] (int element) {
+                children.push_back(juro::make_pending<int>());
+                return children.back()->then([=] (int value) { return value + element; });
+            });
+
+            THEN("only three elements must have been mapped") {
+                REQUIRE(children.size() == 3);
+                REQUIRE(promise->is_pending());
+            }
+
+            AND_WHEN("children are resolved") {
+                children[1]->resolve(100);
+                children[0]->resolve(100);
+
+                THEN("as many further elements must be mapped") {
+                    REQUIRE(children.size() == 5);
+                    REQUIRE(promise->is_pending());
+                }
+
+                AND_WHEN("every child is resolved") {
+                    for(std::size_t index = 2; index < children.size(); index++) {
+                        children[index]->resolve(100);
+                    }
+
+                    THEN("the returned promise must resolve with the values in range order") {
+                        REQUIRE(children.size() == 10);
+                        REQUIRE(promise->is_resolved());
+                        const auto &values = promise->get_value();
+                        REQUIRE(values.size() == 10);
+                        for(int index = 0; index < 10; index++) {
+                            REQUIRE(values[index] == 100 + index);
                         }
                     }
+                }
+            }
 
-                    AND_WHEN("the last promise is rejected") {
-                        auto p1_result = attempt([&] { p1->reject(100); });
+            AND_WHEN("a child is rejected") {
+                promise->then([] (std::vector<int> &) {  }, [] (std::exception_ptr) {  });
+                children[1]->reject("Rejected"s);
+                children[0]->resolve(100);
 
-                        THEN("no exception must be thrown") {
-                            REQUIRE_FALSE(p1_result.has_error());
+                THEN("the returned promise must reject and no further element be mapped") {
+                    REQUIRE(promise->is_rejected());
+                    REQUIRE(children.size() == 3);
+                }
 
-                            AND_THEN("the returned promise must retain its value") {
-                                REQUIRE(promise->is_rejected());
-                                REQUIRE(rescue(promise->get_error()).holds_error<std::string>());
-                                REQUIRE(rescue(promise->get_error())
-                                    .get_error<std::string>() == "Rejected"s
-                                );
-                            }
-                        }
+                children[2]->resolve(100);
+            }
+        }
+
+        WHEN("the elements are mapped into settled promises") {
+            std::size_t copies = 0;
+            std::vector<int> many(10000, 1);
+            std::size_t mapped = 0;
+            const auto base = stack_position();
+            std::uintptr_t deepest = base;
+            auto promise = juro::map_limit(many, 4, [&] (int) {
+                mapped++;
+                deepest = std::min(deepest, stack_position());
+                return juro::make_resolved(copy_counter { copies });
+            });
+
+            THEN("they must be collected without recursing nor copying") {
+                REQUIRE(mapped == 10000);
+                REQUIRE(promise->is_resolved());
+                REQUIRE(promise->get_value().size() == 10000);
+                REQUIRE(base - deepest < 64 * 1024);
+                REQUIRE(copies == 0);
+            }
+        }
+
+        WHEN("the elements are mapped into void promises") {
+            std::vector<juro::promise_ptr<void>> children;
+            auto promise = juro::map_limit(elements, 0, [&] (int) {
+                children.push_back(juro::make_pending());
+                return children.back();
+            });
+
+            THEN("the returned promise must be void") {
+                STATIC_REQUIRE(std::is_same_v<decltype(promise), juro::promise_ptr<void>>);
+            }
+
+            THEN("at least one element must be mapped at a time") {
+                for(std::size_t index = 0; index < children.size(); index++) {
+                    REQUIRE(children.size() == index + 1);
+                    children[index]->resolve();
+                }
+                REQUIRE(children.size() == 10);
+                REQUIRE(promise->is_resolved());
+            }
+        }
+
+        WHEN("the mapper throws") {
+            auto result = attempt([&] {
+                return juro::map_limit(elements, 3, [] (int) -> juro::promise_ptr<int> {
+                    throw "Failed"s;
+                });
+            });
+
+            THEN("the rejection must be unhandled") {
+                REQUIRE(result.holds_error<promise_error>());
+            }
+        }
+
+        WHEN("called with a mapper of boolean promises") {
+            auto promise = juro::map_limit(elements, 2, [] (int element) {
+                return juro::make_resolved<bool>(element % 2 == 0);
+            });
+
+            THEN("the returned promise must resolve with every boolean in order") {
+                REQUIRE(promise->is_resolved());
+                REQUIRE(promise->get_value() == std::vector<bool> {
+                    true, false, true, false, true, false, true, false, true, false
+                });
+            }
+        }
+
+        WHEN("called with an empty range") {
+            auto promise = juro::map_limit(std::vector<int> {  }, 3, [] (int) {
+                return juro::make_resolved(0);
+            });
+
+            THEN("the returned promise must resolve with an empty vector") {
+                REQUIRE(promise->is_resolved());
+                REQUIRE(promise->get_value().empty());
+            }
+        }
+    }
+}
+
+SCENARIO("values can be streamed with backpressure") {
+    GIVEN("a stream with room for two values") {
+        auto stream = juro::make_stream<int>(2);
+
+        WHEN("more values than fit are pushed") {
+            auto first = stream->push(1);
+            auto second = stream->push(2);
+            auto third = stream->push(3);
+
+            THEN("only the values that fit must be accepted right away") {
+                REQUIRE(first->is_resolved());
+                REQUIRE(second->is_resolved());
+                REQUIRE(third->is_pending());
+                REQUIRE(stream->size() == 2);
+            }
+
+            AND_WHEN("a value is read") {
+                auto value = stream->next();
+
+                THEN("the blocked value must be admitted") {
+                    REQUIRE(value->get_value() == 1);
+                    REQUIRE(third->is_resolved());
+                    REQUIRE(stream->size() == 2);
+                }
+            }
+
+            AND_WHEN("the stream is closed and drained") {
+                stream->close();
+                std::vector<int> values;
+                for(auto item = stream->next(); item->get_value(); item = stream->next()) {
+                    values.push_back(*item->get_value());
+                }
+
+                THEN("every value must be read in order") {
+                    REQUIRE(values == std::vector<int> { 1, 2, 3 });
+                    REQUIRE(third->is_resolved());
+                    REQUIRE(stream->next()->get_value() == std::nullopt);
+                }
+            }
+        }
+
+        WHEN("a value is read before being pushed") {
+            auto value = stream->next();
+
+            THEN("the read must wait for the producer") {
+                REQUIRE(value->is_pending());
+                REQUIRE_THROWS_AS(stream->next(), promise_error);
+
+                AND_WHEN("a value is pushed") {
+                    auto written = stream->push(10);
+
+                    THEN("it must be handed straight to the consumer") {
+                        REQUIRE(value->get_value() == 10);
+                        REQUIRE(written->is_resolved());
+                        REQUIRE(stream->empty());
                     }
                 }
             }
         }
+
+        WHEN("the stream fails after a value is pushed") {
+            stream->push(1);
+            stream->fail("Failed"s);
+
+            THEN("the value must be read before the failure") {
+                REQUIRE(stream->next()->get_value() == 1);
+                auto failure = stream->next();
+                REQUIRE(failure->is_rejected());
+                REQUIRE(rescue(failure->get_error()).get_error<std::string>() == "Failed"s);
+                REQUIRE_THROWS_AS(stream->push(2), promise_error);
+            }
+        }
+    }
+
+    GIVEN("a stream with no room") {
+        auto stream = juro::make_stream<std::unique_ptr<int>>(0);
+        auto written = stream->push(std::make_unique<int>(5));
+
+        THEN("every push must wait for a consumer") {
+            REQUIRE(written->is_pending());
+            auto value = stream->next();
+            REQUIRE(**value->get_value() == 5);
+            REQUIRE(written->is_resolved());
+        }
+    }
+
+    GIVEN("a stream mapped, filtered and batched") {
+        auto source = juro::make_stream<int>(4);
+        std::vector<std::vector<std::string>> batches;
+        auto done = juro::for_each(
+            juro::batch(
+                juro::filter(
+                    juro::map(source, [] (int value) { return std::to_string(value * 2); }),
+                    [] (const std::string &value) { return value != "4"s; }
+                ),
+                2
+            ),
+            [&] (std::vector<std::string> &values) { batches.push_back(std::move(values)); }
+        );
+
+        WHEN("values are pushed and the stream is closed") {
+            for(int value = 1; value <= 5; value++) {
+                source->push(value);
+            }
+            source->close();
+
+            THEN("the values must reach the consumer transformed and grouped") {
+                REQUIRE(done->is_resolved());
+                REQUIRE(batches == std::vector<std::vector<std::string>> {
+                    { "2"s, "6"s }, { "8"s, "10"s }
+                });
+            }
+        }
+
+        WHEN("the source fails") {
+            source->push(1);
+            source->push(3);
+            source->push(5);
+            source->fail();
+
+            THEN("the complete batches must be delivered before the failure") {
+                REQUIRE(batches == std::vector<std::vector<std::string>> {
+                    { "2"s, "6"s }
+                });
+                REQUIRE(done->is_rejected());
+            }
+        }
+    }
+
+    GIVEN("a mapped stream nobody reads") {
+        auto source = juro::make_stream<int>(1);
+        auto mapped = juro::map(source, [] (int value) { return value + 1; });
+
+        WHEN("values keep being pushed") {
+            std::vector<juro::promise_ptr<void>> writes;
+            for(int value = 0; value < 4; value++) {
+                writes.push_back(source->push(value));
+            }
+
+            THEN("the producer must be held back once every buffer is full") {
+                REQUIRE(writes[2]->is_resolved());
+                REQUIRE(writes[3]->is_pending());
+            }
+
+            AND_WHEN("the mapped stream is drained") {
+                source->close();
+                std::vector<int> values;
+                for(auto item = mapped->next(); item->get_value(); item = mapped->next()) {
+                    values.push_back(*item->get_value());
+                }
+
+                THEN("every value must flow through") {
+                    REQUIRE(values == std::vector<int> { 1, 2, 3, 4 });
+                    REQUIRE(writes[3]->is_resolved());
+                }
+            }
+        }
+
+        source->close();
+        while(mapped->next()->get_value()) {  }
+    }
+
+    GIVEN("a long stream produced up front") {
+        constexpr int length = 10000;
+        auto source = juro::make_stream<int>(length);
+        for(int value = 0; value < length; value++) {
+            source->push(value);
+        }
+        source->close();
+
+        WHEN("every value is mapped and summed") {
+            long long sum = 0;
+            auto done = juro::for_each(
+                juro::map(source, [] (int value) { return value * 2; }),
+                [&] (int value) { sum += value; }
+            );
+
+            THEN("the buffered values must be pumped without exhausting the stack") {
+                REQUIRE(done->is_resolved());
+                REQUIRE(sum == static_cast<long long>(length) * (length - 1));
+            }
+        }
     }
-}
\ No newline at end of file
+}
+
+SCENARIO("durations can be collected into histograms") {
+    using namespace std::chrono_literals;
+
+    GIVEN("a histogram of a few durations") {
+        juro::histogram samples;
+        samples.record(1ns);
+        samples.record(3ns);
+        samples.record(4ns);
+        samples.record(1000ns);
+
+        THEN("each duration must fall in its power-of-two bucket") {
+            REQUIRE(samples.size() == 4);
+            REQUIRE(samples.bucket(0) == 1);
+            REQUIRE(samples.bucket(2) == 2);
+            REQUIRE(samples.bucket(10) == 1);
+            REQUIRE(samples.max() == 1000ns);
+            REQUIRE(samples.mean() == 252ns);
+        }
+
+        THEN("percentiles must be bounded by the buckets holding them") {
+            REQUIRE(samples.percentile(0.25) == 1ns);
+            REQUIRE(samples.percentile(0.5) == 4ns);
+            REQUIRE(samples.percentile(1.0) == 1000ns);
+        }
+    }
+
+    GIVEN("an empty histogram") {
+        juro::histogram samples;
+
+        THEN("every statistic must be zero") {
+            REQUIRE(samples.empty());
+            REQUIRE(samples.mean() == 0ns);
+            REQUIRE(samples.percentile(0.99) == 0ns);
+        }
+    }
+}
+
+#ifdef JURO_INSTRUMENTATION
+SCENARIO("promise lifecycles can be observed") {
+    GIVEN("an installed observer") {
+        event_recorder recorder;
+        auto *previous = juro::set_observer(&recorder);
+
+        WHEN("a promise is chained, resolved and released") {
+            auto promise = juro::make_pending<int>();
+            auto next = promise->then([] (int value) { return value * 2; });
+            const auto id = promise->get_id();
+            const auto next_id = next->get_id();
+            promise->resolve(21);
+            promise = nullptr;
+
+            THEN("its whole lifecycle must be reported in order") {
+                const auto resolved = static_cast<juro::promise_id>(juro::promise_state::RESOLVED);
+                REQUIRE(recorder.of(id) == std::vector<lifecycle_event> {
+                    { "created", id },
+                    { "settled", id, resolved },
+                    { "handler_began", id },
+                    { "handler_ended", id },
+                    { "destroyed", id }
+                });
+                REQUIRE(recorder.of(next_id) == std::vector<lifecycle_event> {
+                    { "created", next_id },
+                    { "chained", next_id, id },
+                    { "settled", next_id, resolved }
+                });
+            }
+        }
+
+        WHEN("a promise is rejected without a handler") {
+            auto promise = juro::make_pending<int>();
+            auto outcome = attempt([&] { promise->reject(); });
+
+            THEN("the unhandled rejection must be reported before throwing") {
+                REQUIRE(outcome.holds_error<promise_error>());
+                REQUIRE(recorder.events.back() == lifecycle_event { "unhandled", promise->get_id() });
+            }
+        }
+
+        juro::set_observer(previous);
+    }
+
+    GIVEN("an installed trace collector") {
+        juro::trace_collector collector;
+        auto *previous = juro::set_observer(&collector);
+
+        auto promise = juro::make_pending<int>();
+        auto next = promise->then([] (int value) { return value + 1; });
+        promise->resolve(1);
+        juro::set_observer(previous);
+
+        THEN("settle latencies and handler durations must be sampled") {
+            REQUIRE(collector.get_settle_latency().size() == 2);
+            REQUIRE(collector.get_handler_duration().size() == 1);
+            REQUIRE(collector.unhandled_rejections() == 0);
+        }
+
+        THEN("the spans must be exported as a Chrome trace") {
+            std::ostringstream trace;
+            collector.write_chrome_trace(trace);
+            const auto json = trace.str();
+            REQUIRE(json.rfind("{\"traceEvents\":[", 0) == 0);
+            REQUIRE(json.find("\"name\":\"handler\"") != std::string::npos);
+            REQUIRE(json.find("\"parent\":" + std::to_string(promise->get_id())) != std::string::npos);
+        }
+
+        WHEN("the collector is cleared") {
+            collector.clear();
+
+            THEN("every sample must be dropped") {
+                REQUIRE(collector.get_settle_latency().empty());
+                REQUIRE(collector.get_handler_duration().empty());
+            }
+        }
+    }
+}
+#endif /* JURO_INSTRUMENTATION */